@@ -6,6 +6,8 @@
 
 #include ".\include\io_util.h"
 
+#include ".\include\PPUPipeline.h"
+
 CPUClass::CPUClass() {
 
 	this->RAM.resize(0x2000);
@@ -27,6 +29,34 @@ CPUClass::~CPUClass() {
 
 void CPUClass::reset() {
 
+	//	the ROM is loaded by now, so this is where the region is decided for good
+	this->prgSlots = this->cartridge->getPrgSlots();
+	this->masterClock = 0;
+
+	//	mappers with an IRQ raise it straight on the CPU, at the cycle it happens(see Mapper.h)
+	this->cartridge->loadCPU(this);
+	this->IRQ_INT = false;
+
+	switch (this->cartridge->getTV()) {
+
+	case tvEnum::PAL:
+		this->frameCycles = RegionTiming<tvEnum::PAL>::FRAME_CYCLES;
+		this->cycleRegion = &CPUClass::cycleTimed<tvEnum::PAL>;
+		this->cyclePipelinedRegion = &CPUClass::cyclePipelined<tvEnum::PAL>;
+		break;
+	case tvEnum::DENDY:
+		this->frameCycles = RegionTiming<tvEnum::DENDY>::FRAME_CYCLES;
+		this->cycleRegion = &CPUClass::cycleTimed<tvEnum::DENDY>;
+		this->cyclePipelinedRegion = &CPUClass::cyclePipelined<tvEnum::DENDY>;
+		break;
+	default:
+		this->frameCycles = RegionTiming<tvEnum::NTSC>::FRAME_CYCLES;
+		this->cycleRegion = &CPUClass::cycleTimed<tvEnum::NTSC>;
+		this->cyclePipelinedRegion = &CPUClass::cyclePipelined<tvEnum::NTSC>;
+		break;
+
+	}
+
 	//	resetting costs 7 cycles, but we access to start later, so cycle 5 times now
 	this->cycle(); this->cycle(); this->cycle(); this->cycle(); this->cycle();
 
@@ -45,16 +75,17 @@ void CPUClass::reset() {
 
 }
 
-void CPUClass::cycle() {
+template<tvEnum tv>
+void CPUClass::cycleTimed() {
 
 	//	CPU_test does not add the PPU, it only tests the CPU, so do not cycle the PPU at all
 #ifndef CPU_LOGGING
-	//	here we can check the system type(NTSC vs PAL) and call the PPU an equivalent number of times
-	this->PPU->cycle(); this->PPU->cycle(); this->PPU->cycle();
-	if ((this->cartridge->getTV() == tvEnum::PAL) && (this->cycleCount % 5 == 0)) {
+	//	run however many PPU dots fit into one CPU cycle worth of master clock, for PAL this is 3 or 4(3.2:1 on average)
+	this->masterClock += RegionTiming<tv>::CPU_DIVIDER;
+	while (this->masterClock >= RegionTiming<tv>::PPU_DIVIDER) {
 
-		//	PAL version has a PPU to CPU ratio of 3.2:1
-		this->PPU->cycle();
+		this->masterClock -= RegionTiming<tv>::PPU_DIVIDER;
+		this->PPU->cycle<tv>();
 
 	}
 #endif
@@ -64,13 +95,58 @@ void CPUClass::cycle() {
 
 }
 
+template<tvEnum tv>
+void CPUClass::cyclePipelined() {
+
+	//	the same as cycleTimed, except the PPU thread is only told how far it may run
+	uint32_t dots = 0;
+	this->masterClock += RegionTiming<tv>::CPU_DIVIDER;
+	while (this->masterClock >= RegionTiming<tv>::PPU_DIVIDER) {
+
+		this->masterClock -= RegionTiming<tv>::PPU_DIVIDER;
+		dots++;
+
+	}
+	this->pipeline->advance(dots);
+
+	this->cycleCount++;
+	this->remainingCycles--;
+
+}
+
 void CPUClass::runFrame() {
 
 	this->remainingCycles += this->getFrameCycles();
 
+	if (!this->pipeline) {
+
+		while (this->remainingCycles > 0)
+			this->execute();
+		return;
+
+	}
+
+	void (CPUClass::* lockstep)() = this->cycleRegion;
+	this->pipeline->begin(this->cartridge->getTV());
+	this->cycleRegion = this->cyclePipelinedRegion;
+	this->pipelining = true;
+
 	while (this->remainingCycles > 0)
 		this->execute();
 
+	this->pipelining = false;
+	this->cycleRegion = lockstep;
+	this->pipeline->finish();
+
+}
+
+void CPUClass::setPipelined(bool enabled) {
+
+	if (enabled && !this->pipeline)
+		this->pipeline = std::make_unique<PPUPipelineClass>(this, this->PPU);
+	else if (!enabled)
+		this->pipeline.reset();
+
 }
 
 void CPUClass::execute() {
@@ -291,6 +367,8 @@ uint8_t CPUClass::access(uint16_t address, uint8_t data, bool isWrite) {
 	else if (address <= 0x3FFF) {
 
 		//	PPU access
+		if (this->pipelining)
+			return this->pipeline->access(address, data, isWrite);
 		if (isWrite)
 			this->PPU->write(address, data);
 		else
@@ -311,7 +389,7 @@ uint8_t CPUClass::access(uint16_t address, uint8_t data, bool isWrite) {
 				this->cycle();
 				uint8_t oamData = this->access((data * 0x0100) + i);
 				this->cycle();
-				this->PPU->write(0x2004, oamData);
+				this->access(0x2004, oamData, true);
 
 			}
 
@@ -349,9 +427,18 @@ uint8_t CPUClass::access(uint16_t address, uint8_t data, bool isWrite) {
 		//	typically disabled, APU/IO access
 
 	}
-	else
+	else if (address >= 0x8000 && !isWrite)
+		//	PRG ROM, read straight through the mapper's slots
+		return this->prgSlots[(address >> 13) & 0x03][address & 0x1FFF];
+	else {
+
+		//	mapper registers change what the PPU fetches, which the mapper logs for the PPU thread to change when it gets there, see PPUPipelineClass::mapperWrite
+		if (this->pipelining && isWrite && address >= 0x8000)
+			this->pipeline->mapperWrite();
 		return cartridge->prg_access(address, data, isWrite);
 
+	}
+
 	return 0;
 
 }
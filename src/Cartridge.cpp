@@ -1,79 +1,165 @@
 #include <fstream>	//	std::ifstream
 #include <filesystem>
+#include <algorithm>	//	std::max
+#include <cstring>	//	std::memcpy
 
 #include ".\include\Cartridge.h"
 #include ".\include\Mapper_Collection.h"
+#include ".\include\HeaderDatabase.h"
+#include ".\include\Checksum.h"
+#include ".\include\RomArchive.h"
 
 #include ".\include\io_util.h"
 #include ".\include\custom_exceptions.h"
+#include ".\include\ErrorLog.h"
 
-[[nodiscard]] romStruct* CartridgeClass::load(std::string filename) {
+//	what the header asks for, and where it all went in the arena, see layoutArena
+struct RomLayout {
 
-	//	following the nesdev.com documentation on the NES 2.0 header: https://wiki.nesdev.com/w/index.php/NES_2.0
+	size_t prgRamSize = 0;
+	size_t chrRamSize = 0;
 
-	std::ifstream input(filename, std::ios::in | std::ios::binary);
-	if (!input.is_open())
-		throw CartridgeException("Cartridge file: " + filename + " not found");
+	size_t prgRam = 0;
+	size_t chrRam = 0;
+	size_t prgRom = 0;
+	size_t chrRom = 0;
+	bool prgShort = false;					//	the file ends before PRG/CHR ROM does, so what there is of it is copied into the arena
+	bool chrShort = false;
 
-	romStruct* rom = new romStruct;
-	rom->header = readRaw<romHeaderStruct>(input);
+};
 
-	//	ensure the file read is an NES rom by checking the ID
-	//	if not, close file and delete pointer to remove memory leaks
-	if (nesMagic.compare(0, 4, rom->header.ID, 4) != 0) {
+//	following the nesdev.com documentation on the NES 2.0 header: https://wiki.nesdev.com/w/index.php/NES_2.0
+static RomLayout parseHeader(romStruct& rom) {
 
-		input.close();
-		delete rom;
-		throw CartridgeException("Cartridge not NES format. HeaderID: " + std::string(rom->header.ID));	
-
-	}
-
-	//	we need to unload the current cartridge to replace it with the new one
-	this->unload();
+	RomLayout layout;
 
 	/*
 	to check the mirroring the NES rom uses, check:
-		rom->header.flags6 & 0b00000001
+		rom.header.flags6 & 0b00000001
 		0 will be horizontal mirroring, 1 will be vertical mirroring
 	*/
 
 	//	check if this is an NES 2.0 rom: https://wiki.nesdev.com/w/index.php/NES_2.0
 	//	this is according to the nesdev documentation, the bits should be 10 to be classified as NES 2.0
-	if ((rom->header.flags7 & 0b00001100) == 0b00001000) {
+	if ((rom.header.flags7 & 0b00001100) == 0b00001000) {
 
 		//	we want to store the number of chunks each segment has as well for later use with the Mapper
-		rom->prg_rom_chunks = (uint32_t)rom->header.prgRomSizeLSB | ((uint32_t)(rom->header.prgChrSizeMSB & 0b00001111) << 8);
-		rom->chr_rom_chunks = (uint32_t)rom->header.chrRomSizeLSB | ((uint32_t)(rom->header.prgChrSizeMSB & 0b11110000) << 4);
-		rom->prg_rom.resize((size_t)rom->prg_rom_chunks * 0x4000);		//	0x4000 == 16KB
-		rom->chr_rom.resize((size_t)rom->chr_rom_chunks * 0x2000);		//	0x2000 == 8KB
-		(rom->header.timing & 0x03) ? rom->tvType = tvEnum::PAL : rom->tvType = tvEnum::NTSC;
-		
-		/*
-		NES 2.0 includes specifics for PRG RAM
-		*/
+		rom.prg_rom_chunks = (uint32_t)rom.header.prgRomSizeLSB | ((uint32_t)(rom.header.prgChrSizeMSB & 0b00001111) << 8);
+		rom.chr_rom_chunks = (uint32_t)rom.header.chrRomSizeLSB | ((uint32_t)(rom.header.prgChrSizeMSB & 0b11110000) << 4);
+
+		//	no CHR ROM means CHR RAM, which is 64 << shift bytes, we always give at least 8KB so the whole pattern table space is backed
+		rom.chr_ram = (rom.chr_rom_chunks == 0);
+		if (rom.chr_ram) {
+
+			uint8_t shift = rom.header.chrRamSize & 0x0F;
+			layout.chrRamSize = std::max<size_t>(0x2000, shift ? ((size_t)64 << shift) : 0);
+
+		}
+		//	0 = NTSC, 1 = PAL, 2 = multiple regions(we run those as NTSC), 3 = Dendy
+		switch (rom.header.timing & 0x03) {
+
+		case 1: rom.tvType = tvEnum::PAL; break;
+		case 3: rom.tvType = tvEnum::DENDY; break;
+		default: rom.tvType = tvEnum::NTSC; break;
+
+		}
+
+		//	PRG RAM and battery backed PRG RAM are 64 << shift bytes each, and are mapped as one
+		uint8_t ramShift = rom.header.prgRamSize & 0x0F, nvramShift = rom.header.prgRamSize >> 4;
+		size_t prgRamSize = (ramShift ? ((size_t)64 << ramShift) : 0) + (nvramShift ? ((size_t)64 << nvramShift) : 0);
+		rom.prg_ram_chunks = (uint32_t)((prgRamSize + 0x1FFF) / 0x2000);
 
 	}
 	//	otherwise it's an iNES rom: https://wiki.nesdev.com/w/index.php/INES
 	else {
 
-		rom->prg_rom_chunks = (uint32_t)rom->header.prgRomSizeLSB;
-		rom->chr_rom_chunks = rom->header.chrRomSizeLSB ? rom->header.chrRomSizeLSB : 1;
-		rom->prg_ram_chunks = rom->header.flags8 ? rom->header.flags8 : 1;							//	there will always be minimum one 8KB chunk of PRG RAM
-		rom->prg_rom.resize((size_t)rom->prg_rom_chunks * 0x4000);									//	0x4000 == 16KB
-		rom->chr_rom.resize((size_t)rom->chr_rom_chunks * 0x2000);									//	0x2000 == 8KB
-		rom->prg_ram.resize((size_t)rom->prg_ram_chunks * 0x2000);
-		(rom->header.prgChrSizeMSB & 0x01) ? rom->tvType = tvEnum::PAL : rom->tvType = tvEnum::NTSC;
+		rom.prg_rom_chunks = (uint32_t)rom.header.prgRomSizeLSB;
+		rom.chr_rom_chunks = rom.header.chrRomSizeLSB ? rom.header.chrRomSizeLSB : 1;
+		rom.chr_ram = (rom.header.chrRomSizeLSB == 0);										//	no CHR ROM means 8KB of CHR RAM
+		rom.prg_ram_chunks = rom.header.flags8 ? rom.header.flags8 : 1;							//	there will always be minimum one 8KB chunk of PRG RAM
+		if (rom.chr_ram)
+			layout.chrRamSize = 0x2000;
+		(rom.header.prgChrSizeMSB & 0x01) ? rom.tvType = tvEnum::PAL : rom.tvType = tvEnum::NTSC;
+
+	}
+
+	layout.prgRamSize = (size_t)rom.prg_ram_chunks * 0x2000;
+	return layout;
+
+}
+
+/*
+lays out and allocates the arena for what parseHeader found: PRG RAM, CHR RAM, and PRG/CHR ROM when the image is too short to hold all of it,
+then points the RAM sections at their regions
+this is everything an instance has of its own, the ROM itself stays in the shared image, see RomImage.h
+*/
+static void layoutArena(romStruct& rom, RomLayout& layout) {
+
+	size_t prgOffset = romDataOffset(rom.header);
+	size_t prgSize = (size_t)rom.prg_rom_chunks * 0x4000;								//	0x4000 == 16KB
+	size_t chrSize = rom.chr_ram ? 0 : (size_t)rom.chr_rom_chunks * 0x2000;				//	0x2000 == 8KB
+	layout.prgShort = prgOffset + prgSize > rom.image.size();
+	layout.chrShort = !rom.chr_ram && prgOffset + prgSize + chrSize > rom.image.size();
+
+	layout.prgRam = rom.arena.reserve(layout.prgRamSize);
+	layout.chrRam = rom.arena.reserve(layout.chrRamSize);
+	layout.prgRom = layout.prgShort ? rom.arena.reserve(prgSize) : 0;
+	layout.chrRom = layout.chrShort ? rom.arena.reserve(chrSize) : 0;
+	if (!rom.arena.allocate())
+		throw CartridgeException("Not enough memory to load the cartridge");
+
+	rom.prg_ram.place(rom.arena.at(layout.prgRam), layout.prgRamSize);
+	if (rom.chr_ram)
+		rom.chr_rom.place(rom.arena.at(layout.chrRam), layout.chrRamSize);
+
+}
+
+//	size bytes of the image from offset, or if the image ends before that, whatever there is of it copied into the arena at arenaOffset
+static void placeSection(romStruct& rom, RomSection& section, size_t offset, size_t size, bool isShort, size_t arenaOffset) {
+
+	if (!isShort) {
+
+		section.place(rom.image.data() + offset, size);
+		return;
+
+	}
+
+	section.place(rom.arena.at(arenaOffset), size);
+	if (offset < rom.image.size())
+		std::memcpy(section.data(), rom.image.data() + offset, rom.image.size() - offset);
+
+}
+
+[[nodiscard]] std::unique_ptr<romStruct> CartridgeClass::read(std::string filename, bool copy) {
+
+	//	the file itself is shared with every other instance that has it loaded, and is only read once
+	std::unique_ptr<romStruct> rom = std::make_unique<romStruct>();
+	rom->source = RomImageClass::open(filename, copy);
+	rom->image.place(rom->source->data(), rom->source->size());
+	std::memcpy(&rom->header, rom->image.data(), sizeof(romHeaderStruct));
+
+	//	known bad headers are swapped for the right one before anything is read from them
+	//	only PRG and CHR ROM are hashed, so a dump with a Miscellaneous ROM or junk tacked on still matches(a fix never changes the ROM sizes)
+	size_t prg_offset = romDataOffset(rom->header);
+	if (rom->image.size() > prg_offset)
+		rom->crc32 = crc32(rom->image.data() + prg_offset, std::min(romDataSize(rom->header), rom->image.size() - prg_offset));
+	const HeaderFix* fix = findHeaderFix(rom->crc32);
+	if (fix != nullptr) {
+
+		applyHeaderFix(rom->header, *fix);
+		rom->headerFixed = true;
 
 	}
 
-	//	read in prg and chr data into their respective vectors
-	//	for the prg section, we need to ignore the header(16 bytes) and the possible "trainer" section(512 bytes)
-	uint32_t prg_offset = 16 + (512 * ((rom->header.flags6 & 0b00000100) >> 2));
-	input.seekg(prg_offset, std::ios::beg);
-	input.read((char*)rom->prg_rom.data(), rom->prg_rom.size());
+	RomLayout layout = parseHeader(*rom);
+	layoutArena(*rom, layout);
 
-	//	since the chr section is immediately after the prg section, we can read it immediately after
-	input.read((char*)rom->chr_rom.data(), rom->chr_rom.size());
+	//	prg and chr are used straight out of the image, nothing is copied unless the image is short
+	//	since the chr section is immediately after the prg section, it starts where that ends
+	size_t prgSize = (size_t)rom->prg_rom_chunks * 0x4000;
+	placeSection(*rom, rom->prg_rom, prg_offset, prgSize, layout.prgShort, layout.prgRom);
+	if (!rom->chr_ram)
+		placeSection(*rom, rom->chr_rom, prg_offset + prgSize, (size_t)rom->chr_rom_chunks * 0x2000, layout.chrShort, layout.chrRom);
 
 	/*
 		after the chr section, there is the possibility of a Miscellaneous section,
@@ -81,32 +167,122 @@
 		since it is non-vital, we can ignore it for now at least
 	*/
 
-	input.close();
+	return rom;
+
+}
 
-	//	check if a save file exists
-	if (!std::filesystem::exists(".\\saves"))
-		std::filesystem::create_directory(".\\saves");
-	this->saveFile = ".\\saves\\" + filename.substr(filename.rfind("\\") + 1, filename.find(".nes") - (filename.rfind("\\") + 1)) + ".prgram";
-	if (std::filesystem::exists(this->saveFile)) {
+//	battery backed PRG RAM starts out as the save file, every instance runs on its own copy of it, which flushSave and save write back
+//	returns the save file filename's ROM saves to, or "" if it has no battery
+static std::string openSave(const std::string& filename, romStruct& rom) {
 
-		input.open(this->saveFile, std::ios::in | std::ios::binary);
-		input.read((char*)rom->prg_ram.data(), rom->prg_ram.size());
-		input.close();
+	if (!(rom.header.flags6 & 0b00000010) || rom.prg_ram.empty())
+		return "";
 
-	}
+	std::filesystem::path saves = "saves";
+	std::error_code error;
+	std::filesystem::create_directories(saves, error);
+	//	game.nes.gz and game.zip save to the same file as game.nes
+	std::filesystem::path name = std::filesystem::path(filename).filename();
+	if (isRomArchiveName(name.u8string()))
+		name.replace_extension();
+	std::string saveFile = (saves / name.replace_extension(".prgram")).u8string();
+
+	std::ifstream input(std::filesystem::u8path(saveFile), std::ios::in | std::ios::binary);
+	if (input)
+		input.read((char*)rom.prg_ram.data(), rom.prg_ram.size());
+
+	return saveFile;
+
+}
 
+[[nodiscard]] std::unique_ptr<romStruct> CartridgeClass::load(std::string filename, bool copy) {
+
+	std::unique_ptr<romStruct> rom = CartridgeClass::read(filename, copy);
+
+	//	we need to unload the current cartridge to replace it with the new one
+	this->unload();
+
+	this->saveFile = openSave(filename, *rom);
 	return rom;
 
 }
 
-void CartridgeClass::unload() {
+[[nodiscard]] std::unique_ptr<romStruct> CartridgeClass::readComplete(std::string filename) {
 
-	if (this->mapper != nullptr) {
+	//	a build still being written either is not a ROM yet, or is shorter than its header says, which read pads out instead of refusing
+	DeferExceptionLog quiet;
+	try {
 
-		delete this->mapper;
-		this->mapper = nullptr;
+		//	a copy, as the assembler may be about to write it again
+		std::unique_ptr<romStruct> rom = CartridgeClass::read(filename, true);
+		if (romDataOffset(rom->header) + romDataSize(rom->header) <= rom->image.size())
+			return rom;
 
 	}
+	catch (const std::exception&) {}
+
+	return nullptr;
+
+}
+
+bool CartridgeClass::reload(std::string filename, std::unique_ptr<romStruct> rom) {
+
+	if (this->mapper != nullptr && this->mapper->reloadRom(*rom))
+		return true;
+
+	//	the running game's save is written first, so the new build starts out with it,
+	//	but the game itself is only let go of once the new build has a mapper, so a build that cannot run leaves it running
+	this->save();
+	std::string saveFile = openSave(filename, *rom);
+	std::unique_ptr<MapperClass> fresh = selectMapper(std::move(rom));
+
+	this->storeMapper(std::move(fresh));
+	this->saveFile = saveFile;
+	return false;
+
+}
+
+void CartridgeClass::flushSave() {
+
+	this->logSaveFailures();
+	if (this->mapper != nullptr && !this->saveFile.empty() && this->mapper->saveDue(false))
+		this->saveWriter.write(this->saveFile, (uint8_t*)this->mapper->get_prg_ram(), this->mapper->get_prg_ram_size());
+
+}
+
+void CartridgeClass::save() {
+
+	if (this->mapper == nullptr || this->saveFile.empty())
+		return;
+
+	//	waits for the write, as the save file may be read straight after, by a reload or the same game being loaded again
+	this->mapper->saveDue(true);
+	this->saveWriter.write(this->saveFile, (uint8_t*)this->mapper->get_prg_ram(), this->mapper->get_prg_ram_size());
+	this->saveWriter.wait();
+	this->logSaveFailures();
+
+}
+
+void CartridgeClass::logSaveFailures() {
+
+	std::vector<std::string> failures = this->saveWriter.takeFailures();
+	if (failures.empty())
+		return;
+
+	ErrorLogClass log = ErrorLogClass();
+	for (size_t i = 0; i < failures.size(); i++)
+		log.Write("Cannot write the save file: " + failures[i]);
+
+}
+
+CartridgeClass::CartridgeClass() {  }
+
+CartridgeClass::~CartridgeClass() {  }
+
+void CartridgeClass::unload() {
+
+	//	the mapper owns the ROM, so this lets go of both
+	this->mapper.reset();
 
 }
 
@@ -116,12 +292,9 @@ bool CartridgeClass::loaded() {
 
 }
 
-void CartridgeClass::storeMapper(MapperClass* _mapper) {
+void CartridgeClass::storeMapper(std::unique_ptr<MapperClass> _mapper) {
 
-	if (this->mapper != nullptr)
-		delete this->mapper;
-	
-	this->mapper = _mapper;
+	this->mapper = std::move(_mapper);
 
 }
 
@@ -149,6 +322,82 @@ uint8_t CartridgeClass::chr_access(uint16_t& address, const uint8_t& data, bool
 
 }
 
+const TileRow& CartridgeClass::chr_tile_row(uint16_t address, bool flip) {
+
+	return this->mapper->chr_tile_row(address, flip);
+
+}
+
+uint8_t* const* CartridgeClass::loadNametables(uint8_t* ciram) {
+
+	if (this->mapper != nullptr)
+		return this->mapper->loadNametables(ciram);
+	throw CartridgeException("Mapper not found");
+
+}
+
+uint8_t* const* CartridgeClass::getPrgSlots() {
+
+	if (this->mapper != nullptr)
+		return this->mapper->getPrgSlots();
+	throw CartridgeException("Mapper not found");
+
+}
+
+TileCacheClass* CartridgeClass::getTileCache() {
+
+	if (this->mapper != nullptr)
+		return this->mapper->getTileCache();
+	throw CartridgeException("Mapper not found");
+
+}
+
+void CartridgeClass::loadCPU(CPUClass* CPU) {
+
+	if (this->mapper == nullptr)
+		throw CartridgeException("Mapper not found");
+	this->mapper->loadCPU(CPU);
+
+}
+
+bool CartridgeClass::watchesA12() {
+
+	if (this->mapper != nullptr)
+		return this->mapper->watchesA12();
+	throw CartridgeException("Mapper not found");
+
+}
+
+void CartridgeClass::clockA12() {
+
+	//	only called once watchesA12 has said yes, so the mapper is there, this is on the PPU's hot path
+	this->mapper->clockA12();
+
+}
+
+void CartridgeClass::deferPpuChanges(MapperDeferralClass* deferral) {
+
+	if (this->mapper != nullptr)
+		this->mapper->deferPpuChanges(deferral);
+
+}
+
+void CartridgeClass::applyPpuChange(const MapperPpuChange& change) {
+
+	//	only deferred changes come back through here, so the mapper that deferred them is still there
+	this->mapper->applyPpuChange(change);
+
+}
+
+uint8_t CartridgeClass::takeChrDirty() {
+
+	//	nothing loaded means nothing for the viewers to draw
+	if (this->mapper != nullptr)
+		return this->mapper->takeChrDirty();
+	return 0;
+
+}
+
 mirrorEnum CartridgeClass::getMirror() {
 	
 	if (this->mapper != nullptr)
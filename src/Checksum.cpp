@@ -0,0 +1,315 @@
+#include <cstring>		//	std::memcpy
+#include <algorithm>	//	std::min
+
+#include ".\include\Checksum.h"
+#include ".\include\simd_util.h"
+
+//	see: https://en.wikipedia.org/wiki/Cyclic_redundancy_check, one entry per byte value
+struct Crc32Table {
+
+	uint32_t entries[256];
+
+	Crc32Table() {
+
+		for (uint32_t i = 0; i < 256; i++) {
+
+			uint32_t value = i;
+			for (uint8_t bit = 0; bit < 8; bit++)
+				value = (value & 1) ? (value >> 1) ^ 0xEDB88320 : value >> 1;
+			this->entries[i] = value;
+
+		}
+
+	}
+
+};
+
+static const Crc32Table crcTable;
+
+//	crc here is the running register, already inverted
+static uint32_t crc32Bytes(const uint8_t* data, size_t size, uint32_t crc) {
+
+	for (size_t i = 0; i < size; i++)
+		crc = crcTable.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	return crc;
+
+}
+
+#ifdef SIMD_X86
+/*
+folds 64 bytes at a time with carry-less multiplies, then reduces what is left to 32 bits
+follows Intel's "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction", with the bit reflected constants from the end of it
+size has to be at least 64 and a multiple of 16
+*/
+TARGET_PCLMUL static uint32_t crc32Folded(const uint8_t* data, size_t size, uint32_t crc) {
+
+	const __m128i k1k2 = _mm_set_epi64x(0x01C6E41596, 0x0154442BD4);
+	const __m128i k3k4 = _mm_set_epi64x(0x00CCAA009E, 0x01751997D0);
+	const __m128i k5k0 = _mm_set_epi64x(0x0000000000, 0x0163CD6124);
+	const __m128i poly = _mm_set_epi64x(0x01F7011641, 0x01DB710641);
+	const __m128i low32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+	__m128i x1 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(data + 0x00)), _mm_cvtsi32_si128((int)crc));
+	__m128i x2 = _mm_loadu_si128((const __m128i*)(data + 0x10));
+	__m128i x3 = _mm_loadu_si128((const __m128i*)(data + 0x20));
+	__m128i x4 = _mm_loadu_si128((const __m128i*)(data + 0x30));
+	data += 64;
+	size -= 64;
+
+	//	4 lanes at once
+	for (; size >= 64; data += 64, size -= 64) {
+
+		__m128i x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+		__m128i x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+		__m128i x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+		__m128i x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+		x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k1k2, 0x11), x5), _mm_loadu_si128((const __m128i*)(data + 0x00)));
+		x2 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x2, k1k2, 0x11), x6), _mm_loadu_si128((const __m128i*)(data + 0x10)));
+		x3 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x3, k1k2, 0x11), x7), _mm_loadu_si128((const __m128i*)(data + 0x20)));
+		x4 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x4, k1k2, 0x11), x8), _mm_loadu_si128((const __m128i*)(data + 0x30)));
+
+	}
+
+	//	the 4 lanes into 1, then whatever 16 byte blocks are left
+	x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11), _mm_clmulepi64_si128(x1, k3k4, 0x00)), x2);
+	x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11), _mm_clmulepi64_si128(x1, k3k4, 0x00)), x3);
+	x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11), _mm_clmulepi64_si128(x1, k3k4, 0x00)), x4);
+	for (; size >= 16; data += 16, size -= 16)
+		x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11), _mm_clmulepi64_si128(x1, k3k4, 0x00)), _mm_loadu_si128((const __m128i*)data));
+
+	//	128 bits to 64
+	x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+	x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+	x2 = _mm_srli_si128(x1, 4);
+	x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, low32), k5k0, 0x00), x2);
+
+	//	Barrett reduction to 32
+	x2 = _mm_and_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, low32), poly, 0x10), low32);
+	x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	return (uint32_t)_mm_extract_epi32(x1, 1);
+
+}
+
+static const bool usePCLMUL = cpuHasPCLMUL();
+#endif
+
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc) {
+
+	crc = ~crc;
+
+#ifdef SIMD_X86
+	if (usePCLMUL && size >= 64) {
+
+		size_t folded = size & ~(size_t)0x0F;
+		crc = crc32Folded(data, folded, crc);
+		data += folded;
+		size -= folded;
+
+	}
+#endif
+
+	return ~crc32Bytes(data, size, crc);
+
+}
+
+uint32_t crc32Scalar(const uint8_t* data, size_t size, uint32_t crc) {
+
+	return ~crc32Bytes(data, size, ~crc);
+
+}
+
+bool crc32Accelerated() {
+
+#ifdef SIMD_X86
+	return usePCLMUL;
+#else
+	return false;
+#endif
+
+}
+
+static inline uint32_t rotateLeft(uint32_t value, uint8_t bits) {
+
+	return (value << bits) | (value >> (32 - bits));
+
+}
+
+//	see: https://en.wikipedia.org/wiki/SHA-1#SHA-1_pseudocode
+static void sha1Blocks(uint32_t state[5], const uint8_t* data, size_t blocks) {
+
+	for (; blocks > 0; blocks--, data += 64) {
+
+		uint32_t w[80];
+		for (uint8_t i = 0; i < 16; i++)
+			w[i] = ((uint32_t)data[i * 4] << 24) | ((uint32_t)data[(i * 4) + 1] << 16) | ((uint32_t)data[(i * 4) + 2] << 8) | data[(i * 4) + 3];
+		for (uint8_t i = 16; i < 80; i++)
+			w[i] = rotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+		uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+		for (uint8_t i = 0; i < 80; i++) {
+
+			uint32_t f, k;
+			if (i < 20) { f = (b & c) | (~b & d); k = 0x5A827999; }
+			else if (i < 40) { f = b ^ c ^ d; k = 0x6ED9EBA1; }
+			else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+			else { f = b ^ c ^ d; k = 0xCA62C1D6; }
+
+			uint32_t temp = rotateLeft(a, 5) + f + e + k + w[i];
+			e = d;
+			d = c;
+			c = rotateLeft(b, 30);
+			b = a;
+			a = temp;
+
+		}
+
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+
+	}
+
+}
+
+#ifdef SIMD_X86
+/*
+4 rounds per sha1rnds4, with sha1msg1/sha1msg2 working out the message schedule 4 words at a time alongside
+round group i uses message i % 4, and the schedule for group i + 1 to i + 3 is worked out while it runs
+see: https://www.intel.com/content/www/us/en/developer/articles/technical/intel-sha-extensions.html
+*/
+TARGET_SHA static void sha1BlocksSHA(uint32_t state[5], const uint8_t* data, size_t blocks) {
+
+	const __m128i byteSwap = _mm_set_epi64x(0x0001020304050607, 0x08090A0B0C0D0E0F);
+
+	__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)state), 0x1B);
+	__m128i e0 = _mm_set_epi32((int)state[4], 0, 0, 0), e1 = _mm_setzero_si128();
+
+	for (; blocks > 0; blocks--, data += 64) {
+
+		__m128i savedABCD = abcd, savedE = e0;
+		__m128i message[4];
+		for (uint8_t i = 0; i < 4; i++)
+			message[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + (i * 16))), byteSwap);
+
+		for (uint8_t i = 0; i < 20; i++) {
+
+			__m128i& current = message[i & 0x03];
+			__m128i& e = (i & 0x01) ? e1 : e0;
+			e = (i == 0) ? _mm_add_epi32(e0, current) : _mm_sha1nexte_epu32(e, current);
+			((i & 0x01) ? e0 : e1) = abcd;
+
+			//	sha1rnds4 needs the round function as an immediate
+			switch (i / 5) {
+
+			case 0: abcd = _mm_sha1rnds4_epu32(abcd, e, 0); break;
+			case 1: abcd = _mm_sha1rnds4_epu32(abcd, e, 1); break;
+			case 2: abcd = _mm_sha1rnds4_epu32(abcd, e, 2); break;
+			default: abcd = _mm_sha1rnds4_epu32(abcd, e, 3); break;
+
+			}
+
+			if (i >= 3 && i <= 18)
+				message[(i + 1) & 0x03] = _mm_sha1msg2_epu32(message[(i + 1) & 0x03], current);
+			if (i >= 1 && i <= 16)
+				message[(i + 3) & 0x03] = _mm_sha1msg1_epu32(message[(i + 3) & 0x03], current);
+			if (i >= 2 && i <= 17)
+				message[(i + 2) & 0x03] = _mm_xor_si128(message[(i + 2) & 0x03], current);
+
+		}
+
+		e0 = _mm_sha1nexte_epu32(e0, savedE);
+		abcd = _mm_add_epi32(abcd, savedABCD);
+
+	}
+
+	_mm_storeu_si128((__m128i*)state, _mm_shuffle_epi32(abcd, 0x1B));
+	state[4] = (uint32_t)_mm_extract_epi32(e0, 3);
+
+}
+#endif
+
+Sha1Class::Sha1Class(bool accelerated) {
+
+	this->state[0] = 0x67452301;
+	this->state[1] = 0xEFCDAB89;
+	this->state[2] = 0x98BADCFE;
+	this->state[3] = 0x10325476;
+	this->state[4] = 0xC3D2E1F0;
+
+	this->compress = &sha1Blocks;
+#ifdef SIMD_X86
+	static const bool useSHA = cpuHasSHA();
+	if (useSHA && accelerated)
+		this->compress = &sha1BlocksSHA;
+#endif
+
+}
+
+void Sha1Class::update(const uint8_t* data, size_t size) {
+
+	this->length += size;
+
+	//	top up a partly filled block first
+	if (this->blockUsed) {
+
+		size_t taken = std::min<size_t>(size, 64 - this->blockUsed);
+		std::memcpy(&this->block[this->blockUsed], data, taken);
+		this->blockUsed += (uint32_t)taken;
+		data += taken;
+		size -= taken;
+
+		if (this->blockUsed < 64)
+			return;
+		this->compress(this->state, this->block, 1);
+		this->blockUsed = 0;
+
+	}
+
+	//	whole blocks straight from data
+	this->compress(this->state, data, size / 64);
+	data += size & ~(size_t)0x3F;
+	size &= 0x3F;
+
+	std::memcpy(this->block, data, size);
+	this->blockUsed = (uint32_t)size;
+
+}
+
+void Sha1Class::finish(uint8_t digest[20]) {
+
+	//	a 1 bit, zeros up to 8 bytes short of a block, then the length in bits
+	uint64_t bits = this->length * 8;
+	uint8_t padding[72] = { 0x80 };
+	size_t padded = ((this->blockUsed < 56) ? 56 : 120) - this->blockUsed;
+	for (uint8_t i = 0; i < 8; i++)
+		padding[padded + i] = (uint8_t)(bits >> (56 - (i * 8)));
+	this->update(padding, padded + 8);
+
+	for (uint8_t i = 0; i < 20; i++)
+		digest[i] = (uint8_t)(this->state[i / 4] >> (24 - ((i % 4) * 8)));
+
+}
+
+bool Sha1Class::isAccelerated() {
+
+	return this->compress != &sha1Blocks;
+
+}
+
+std::string Sha1Class::toHex(const uint8_t digest[20]) {
+
+	const char* digits = "0123456789abcdef";
+	std::string hex;
+	for (uint8_t i = 0; i < 20; i++) {
+
+		hex += digits[digest[i] >> 4];
+		hex += digits[digest[i] & 0x0F];
+
+	}
+	return hex;
+
+}
@@ -0,0 +1,16 @@
+#include ".\include\FrameSink.h"
+
+void FrameHashSinkClass::submitFrame(const FrameBuffer& frame) {
+
+	//	FNV-1a, see: http://www.isthe.com/chongo/tech/comp/fnv/index.html
+	this->hash = 0xCBF29CE484222325;
+	for (size_t i = 0; i < frame.pixels.size(); i++) {
+
+		this->hash = (this->hash ^ (frame.pixels[i] & 0xFF)) * 0x00000100000001B3;
+		this->hash = (this->hash ^ (frame.pixels[i] >> 8)) * 0x00000100000001B3;
+
+	}
+
+	this->frameCount++;
+
+}
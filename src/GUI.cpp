@@ -1,5 +1,7 @@
 #include <tuple>
 #include <fstream>
+#include <algorithm>
+#include <cstring>
 
 #include ".\include\GUI.h"
 
@@ -20,6 +22,7 @@
 
 #include ".\include\Cartridge.h"
 #include ".\include\Mapper_Collection.h"
+#include ".\include\RomArchive.h"
 #include ".\include\ErrorLog.h"
 
 #include ".\include\Controller.h"
@@ -32,14 +35,20 @@ GUIClass::GUIClass(std::string progName) {
     this->window.create(sf::VideoMode(256, 240), this->progName);
     this->window.setFramerateLimit(60);
 
-    this->gameTexture.create(1280, 720);
+    this->fitTexture();
     this->window.setSize(sf::Vector2u(768, 720));
 
     ImGui::SFML::Init(this->window);
 
     //  initialize filebrowser for title and file type lookup
     this->filebrowser.SetTitle("Choose File");
-    this->filebrowser.SetTypeFilters({ ".nes" });
+    //  ROMs can also be kept compressed, see RomArchive.h
+    this->filebrowser.SetTypeFilters({ ".nes", ".gz", ".zip" });
+
+    this->paletteBrowser.SetTitle("Choose Palette");
+    this->paletteBrowser.SetTypeFilters({ ".pal" });
+
+    this->viewer.loadPalette(&this->palette);
 
 }
 
@@ -57,10 +66,11 @@ GUIClass::~GUIClass() {
 
 }
 
-void GUIClass::addCartViewer(std::string windowName, CartridgeClass::GetCartData getData_ptr, CartridgeClass::getCartDataSize getSize_ptr) {
+void GUIClass::addCartViewer(std::string windowName, CartridgeClass::GetCartData getData_ptr, CartridgeClass::getCartDataSize getSize_ptr, bool readOnly) {
 
     this->cart_hex_windows.push_back(CartridgeMemoryEditorContainer());
     this->cart_hex_windows.back().hex_view = new MemoryEditor;
+    this->cart_hex_windows.back().hex_view->ReadOnly = readOnly;
     this->cart_hex_windows.back().hex_name = windowName;
     this->cart_hex_windows.back().getDataFunc = getData_ptr;
     this->cart_hex_windows.back().getSizeFunc = getSize_ptr;
@@ -104,6 +114,8 @@ void GUIClass::draw() {
     }
 
     sf::Sprite sprite(this->gameTexture);
+    sprite.setTextureRect(sf::IntRect(0, 0, this->frameSize.x, this->frameSize.y));
+    sprite.setScale((float)this->resolution.x / this->frameSize.x, (float)this->resolution.y / this->frameSize.y);
 
     ImGui::SFML::Update(this->window, clock.restart());
 
@@ -125,6 +137,12 @@ void GUIClass::draw() {
     if (showFileDialog)
         this->drawFileDialog();
 
+    if (this->watchEnabled && this->isLoaded())
+        this->watchRom();
+
+    if (showPaletteDialog)
+        this->drawPaletteDialog();
+
     if (showControllerDialog)
         this->drawControllerDialog();
 
@@ -208,13 +226,62 @@ bool GUIClass::isLoaded() {
 
 }
 
-void GUIClass::updateFrame(sf::Image& pixels) {
+void GUIClass::submitFrame(const FrameBuffer& frame) {
+
+    switch (this->videoFilter) {
+
+    case VIDEO_FILTERS::FILTER_NTSC:
+        //  the filters hand back the frame before this one, so there is nothing to show on the very first frame
+        this->ntscFilter.submitFrame(frame);
+        if (this->ntscFilter.hasOutput()) {
+            this->frameSize = sf::Vector2u(this->ntscFilter.getWidth(), this->ntscFilter.getHeight());
+            this->gameTexture.update((uint8_t*)&this->ntscFilter.getOutput().at(0), this->frameSize.x, this->frameSize.y, 0, 0);
+        }
+        break;
+
+    case VIDEO_FILTERS::FILTER_SCALE2X:
+    case VIDEO_FILTERS::FILTER_SCALE3X:
+        this->scaler.submitFrame(frame);
+        if (this->scaler.hasOutput())
+            this->uploadFrame(this->scaler.getOutput());
+        break;
+
+    default:
+        this->uploadFrame(frame);
+        break;
+
+    }
+
+}
+
+void GUIClass::uploadFrame(const FrameBuffer& frame) {
 
-    //  need to adjust last parameter(pitch) based on PPU information(dimensions of the screen to be rendered)
-    uint32_t x, y;
-    std::tie(x, y) = this->PPU->getResolution();
-    //this->gameTexture.update((uint8_t*)pixels, x, y, 0, 0);
-    this->gameTexture.update(pixels);
+    //  the PPU only hands us palette indexes, SFML needs the actual colors
+    this->palette.convert(frame, this->frameColors);
+    this->frameSize = sf::Vector2u(frame.width, frame.height);
+    this->gameTexture.update((uint8_t*)&this->frameColors.at(0), frame.width, frame.height, 0, 0);
+
+}
+
+void GUIClass::setVideoFilter(VIDEO_FILTERS filter) {
+
+    //  the filters share one pool, which is only started the first time one of them is turned on
+    if (filter != VIDEO_FILTERS::FILTER_NONE && this->filterPool == nullptr) {
+
+        this->filterPool = std::make_unique<WorkerPoolClass>();
+        this->ntscFilter.loadPool(this->filterPool.get());
+        this->scaler.loadPool(this->filterPool.get());
+
+    }
+
+    this->ntscFilter.flush();
+    if (filter == VIDEO_FILTERS::FILTER_SCALE3X)
+        this->scaler.setFactor(3);
+    else
+        this->scaler.setFactor(2);
+
+    this->videoFilter = filter;
+    this->fitTexture();
 
 }
 
@@ -231,7 +298,7 @@ void GUIClass::drawMenu() {
 
             //  set to true so the GUI::Draw function knows to begin displaying this dialog
             showFileDialog = true;
-            //  as far as I know, there is only the *.nes extension for ROM files, so we can tell it to only look for that file extension
+            //  as far as I know, there is only the *.nes extension for ROM files, so we can tell it to only look for that file extension(and the .gz/.zip it may be compressed in)
 
             //ImGuiFileDialog::Instance()->OpenDialog("ChooseFileDialog", "Choose File", ".nes,.*", ".");
             this->filebrowser.Open();
@@ -244,11 +311,17 @@ void GUIClass::drawMenu() {
                 this->saveGame();
                 this->cartridge->unload();
                 this->loadedFile = "";
+                this->loadedPath = "";
 
             }
 
         }
 
+        //  for homebrew, the ROM is reloaded whenever it is rebuilt, see watchRom
+        if (ImGui::MenuItem("Watch ROM", nullptr, &this->watchEnabled))
+            this->startWatching();
+        ImGui::MenuItem("Keep State on Reload", nullptr, &this->keepStateOnReload, this->watchEnabled);
+
         ImGui::EndMenu();
 
     }
@@ -331,6 +404,17 @@ void GUIClass::drawMenu() {
                     this->backgroundInput = !this->backgroundInput;
                 }
         }
+        if (ImGui::MenuItem("Load Palette")) {
+            showPaletteDialog = true;
+            this->paletteBrowser.Open();
+        }
+        if (ImGui::MenuItem("Default Palette")) {
+            this->palette.loadDefault();
+            this->viewer.invalidate();
+        }
+        this->drawVideoFilterMenu();
+        if (ImGui::MenuItem("Threaded PPU", nullptr, this->CPU->isPipelined()))
+            this->CPU->setPipelined(!this->CPU->isPipelined());
 
         ImGui::EndMenu();
     }
@@ -340,6 +424,25 @@ void GUIClass::drawMenu() {
 }
 
 
+void GUIClass::drawVideoFilterMenu() {
+
+    if (ImGui::BeginMenu("Video Filter")) {
+
+        if (ImGui::MenuItem("None", nullptr, this->videoFilter == VIDEO_FILTERS::FILTER_NONE))
+            this->setVideoFilter(VIDEO_FILTERS::FILTER_NONE);
+        if (ImGui::MenuItem("NTSC", nullptr, this->videoFilter == VIDEO_FILTERS::FILTER_NTSC))
+            this->setVideoFilter(VIDEO_FILTERS::FILTER_NTSC);
+        if (ImGui::MenuItem("Scale2x", nullptr, this->videoFilter == VIDEO_FILTERS::FILTER_SCALE2X))
+            this->setVideoFilter(VIDEO_FILTERS::FILTER_SCALE2X);
+        if (ImGui::MenuItem("Scale3x", nullptr, this->videoFilter == VIDEO_FILTERS::FILTER_SCALE3X))
+            this->setVideoFilter(VIDEO_FILTERS::FILTER_SCALE3X);
+
+        ImGui::EndMenu();
+
+    }
+
+}
+
 void::GUIClass::drawControllerDialog() {
   
     ImGui::Begin("Controller Bindings", &showControllerDialog);  
@@ -520,6 +623,9 @@ void GUIClass::drawSelectDebug() {
         ImGui::Checkbox(this->cpu_hex_windows.at(i).hex_name.c_str(), &this->cpu_hex_windows.at(i).isShown);
     for (uint32_t i = 0; i < this->ppu_hex_windows.size(); i++)
         ImGui::Checkbox(this->ppu_hex_windows.at(i).hex_name.c_str(), &this->ppu_hex_windows.at(i).isShown);
+    ImGui::Checkbox("Pattern Tables", &this->showPatternTables);
+    ImGui::Checkbox("Nametable Viewer", &this->showNametables);
+    ImGui::Checkbox("Sprite Viewer", &this->showSprites);
     ImGui::End();
 
 }
@@ -553,6 +659,19 @@ void GUIClass::drawDebug() {
         if (this->ppu_hex_windows.at(i).isShown)
             this->ppu_hex_windows.at(i).hex_view->DrawWindow(this->ppu_hex_windows.at(i).hex_name.c_str(), (this->PPU->*this->ppu_hex_windows.at(i).getDataFunc)(), (this->PPU->*this->ppu_hex_windows.at(i).getSizeFunc)());
 
+    //  the graphical views only redraw what was written since the last GUI frame, see PPUViewer.h
+    if (this->isLoaded()) {
+
+        this->viewer.update();
+        if (this->showPatternTables)
+            this->viewer.drawPatternTables(&this->showPatternTables);
+        if (this->showNametables)
+            this->viewer.drawNametables(&this->showNametables);
+        if (this->showSprites)
+            this->viewer.drawSprites(&this->showSprites);
+
+    }
+
 }
 
 void GUIClass::drawFileDialog() {
@@ -565,40 +684,34 @@ void GUIClass::drawFileDialog() {
 
         this->loadedFile = filebrowser.GetSelected().string();
 
-        if (loadedFile.find(".nes") != std::string::npos && ((loadedFile.find_last_of(".") - loadedFile.find_last_of("\\")) > 1)) {
+        if ((loadedFile.find(".nes") != std::string::npos || isRomArchiveName(loadedFile)) && ((loadedFile.find_last_of(".") - loadedFile.find_last_of("\\")) > 1)) {
 
             //  save current game first
             this->saveGame();
             
             //  grab the file path name and load the new ROM in
             try {
-                this->cartridge->storeMapper(selectMapper(this->cartridge->load(this->loadedFile)));
+                //  a watched ROM is copied instead of mapped, so it can be rebuilt while it runs
+                this->cartridge->storeMapper(selectMapper(this->cartridge->load(this->loadedFile, this->watchEnabled)));
+                this->loadedPath = this->loadedFile;
+                this->recordWatched();
 
                 //  store just the file name itself
                 this->loadedFile = loadedFile.substr(loadedFile.find_last_of("\\") + 1);
 
+                //  the PPU still points into the old mapper(nametables and patterns), so it has to pick up the new one before the CPU runs it
+                if (this->PPU)
+                  this->PPU->reset();
+
                 //  reset the CPU to a known state to start the new ROM
                 //  emulation requires the cartridge ROM be loaded before the CPU can be started/restarted
                 //  because the CPU must read a specific section of the ROM(0xFFFC and 0xFFFD) to find where to begin execution
                 this->CPU->reset();
 
-                //  we would need to reset all components here that require it(APU and PPU specifically)
+                //  we would need to reset all components here that require it(APU specifically)
 
-                //  check if we have the PPU loaded, if not, we can ignore this
-                if (this->PPU) {
+                this->fitWindow();
 
-                  this->PPU->reset();
-                  uint32_t x, y;
-                  std::tie(x, y) = this->PPU->getResolution();
-                  if (this->gameTexture.getSize().y != y) {
-
-                    this->window.close();
-                    this->window.create(sf::VideoMode(x, y), this->progName);
-                    this->window.setSize(sf::Vector2u(x * 3, y * 3));
-                    this->window.setFramerateLimit(this->PPU->getTVFrameRate());
-                    this->gameTexture.create(x, y);
-                  }
-                }
                 // We've succesfully loaded a ROM, disable error window if user hasn't closed it
                 showMapperError = false;
 
@@ -645,6 +758,233 @@ void GUIClass::drawFileDialog() {
     
 }
 
+void GUIClass::fitWindow() {
+
+    //  check if we have the PPU loaded, if not, we can ignore this
+    if (this->PPU) {
+
+      uint32_t x, y;
+      std::tie(x, y) = this->PPU->getResolution();
+      if (this->resolution != sf::Vector2u(x, y)) {
+
+        this->window.close();
+        this->window.create(sf::VideoMode(x, y), this->progName);
+        this->window.setSize(sf::Vector2u(x * 3, y * 3));
+        this->resolution = sf::Vector2u(x, y);
+      }
+      this->window.setFramerateLimit(this->PPU->getTVFrameRate());
+      this->fitTexture();
+    }
+
+}
+
+sf::Vector2u GUIClass::filterOutputSize() {
+
+    switch (this->videoFilter) {
+
+    case VIDEO_FILTERS::FILTER_NTSC:
+        return sf::Vector2u(this->resolution.x * NTSC_OUTPUT_SCALE, this->resolution.y);
+    case VIDEO_FILTERS::FILTER_SCALE2X:
+        return sf::Vector2u(this->resolution.x * 2, this->resolution.y * 2);
+    case VIDEO_FILTERS::FILTER_SCALE3X:
+        return sf::Vector2u(this->resolution.x * 3, this->resolution.y * 3);
+    default:
+        return this->resolution;
+
+    }
+
+}
+
+void GUIClass::fitTexture() {
+
+    //  only ever grows, so switching back to a smaller filter does not throw the texture away again
+    sf::Vector2u size = this->filterOutputSize();
+    sf::Vector2u current = this->gameTexture.getSize();
+    if (current.x < size.x || current.y < size.y)
+        this->gameTexture.create(std::max(current.x, size.x), std::max(current.y, size.y));
+
+}
+
+void GUIClass::recordWatched() {
+
+    //  the file as it is now is what later checks compare against, so turning watching on does not reload straight away
+    std::error_code error;
+    std::filesystem::path path(this->loadedPath);
+    this->watchedSize = std::filesystem::file_size(path, error);
+    this->watchedTime = std::filesystem::last_write_time(path, error);
+    this->reloadPending = false;
+
+}
+
+void GUIClass::startWatching() {
+
+    this->recordWatched();
+    if (!this->watchEnabled || !this->isLoaded())
+        return;
+
+    //  the running ROM is mapped, which keeps it from being rebuilt(see RomImage.h), so it is swapped for a copy of itself,
+    //  being the same build, it goes in under the running game, unless it was loaded padded out(see CartridgeClass::reload)
+    try {
+
+        if (!this->cartridge->reload(this->loadedPath, CartridgeClass::read(this->loadedPath, true))) {
+
+            if (this->PPU)
+                this->PPU->reset();
+            this->CPU->reset();
+
+        }
+
+    }
+    //  a ROM that can no longer be read keeps running mapped, the exception logs why
+    catch (MapperException e) {}
+    catch (CartridgeException e) {}
+
+}
+
+void GUIClass::watchRom() {
+
+    //  a few checks a second is quick enough to feel instant, and costs next to nothing
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (now < this->nextWatch)
+        return;
+    this->nextWatch = now + std::chrono::milliseconds(250);
+
+    //  some tools delete the ROM before writing the new one, so a missing file is just checked again later
+    std::error_code error;
+    std::filesystem::path path(this->loadedPath);
+    uintmax_t size = std::filesystem::file_size(path, error);
+    if (error)
+        return;
+    std::filesystem::file_time_type modified = std::filesystem::last_write_time(path, error);
+    if (error)
+        return;
+
+    //  the assembler may still be writing it, so a change is only reloaded once the file has looked the same for a whole check
+    if (size != this->watchedSize || modified != this->watchedTime) {
+
+        this->watchedSize = size;
+        this->watchedTime = modified;
+        this->reloadPending = true;
+
+    }
+    else if (this->reloadPending) {
+
+        //  and once it reads as a whole ROM, a build that is cut short or not quite written yet is looked at again at the next check
+        std::unique_ptr<romStruct> rom = CartridgeClass::readComplete(this->loadedPath);
+        if (rom == nullptr)
+            return;
+
+        this->reloadPending = false;
+        this->hotReload(std::move(rom));
+
+    }
+
+}
+
+//  copies what an accessor points at into snapshot, and back out again as long as it is still the same size
+static void takeSnapshot(std::vector<uint8_t>& snapshot, void* data, size_t size) {
+
+    if (data != nullptr)
+        snapshot.assign((uint8_t*)data, (uint8_t*)data + size);
+
+}
+
+static void restoreSnapshot(const std::vector<uint8_t>& snapshot, void* data, size_t size) {
+
+    if (data != nullptr && !snapshot.empty() && snapshot.size() == size)
+        std::memcpy(data, snapshot.data(), size);
+
+}
+
+void GUIClass::hotReload(std::unique_ptr<romStruct> rom) {
+
+    //  whether the new build can be swapped in under the running game is only known once it has been read, so the state is kept either way
+    HotReloadSnapshot snapshot;
+    if (this->keepStateOnReload) {
+
+        takeSnapshot(snapshot.cpuRam, this->CPU->get_cpu_ram(), this->CPU->get_cpu_ram_size());
+        takeSnapshot(snapshot.cpuRegs, this->CPU->get_cpu_regs(), this->CPU->get_cpu_regs_size());
+        takeSnapshot(snapshot.prgRam, this->cartridge->get_prg_ram(), this->cartridge->get_prg_ram_size());
+        if (this->PPU) {
+
+            takeSnapshot(snapshot.ppuRegs, this->PPU->get_ppu_regs(), this->PPU->get_ppu_regs_size());
+            takeSnapshot(snapshot.nametables, this->PPU->get_ppu_nametables(), this->PPU->get_ppu_nametables_size());
+            takeSnapshot(snapshot.palettes, this->PPU->get_ppu_palettes(), this->PPU->get_ppu_palettes_size());
+            takeSnapshot(snapshot.oam, this->PPU->get_ppu_oam(), this->PPU->get_ppu_oam_size());
+
+        }
+
+    }
+
+    try {
+
+        //  the same layout is swapped in under the running game(see CartridgeClass::reload), which keeps everything else, the game carries on by itself
+        bool inPlace = this->cartridge->reload(this->loadedPath, std::move(rom));
+        if (inPlace && this->keepStateOnReload)
+            return;
+
+        //  otherwise it starts over the same way a newly loaded ROM does, see drawFileDialog
+        if (this->PPU)
+            this->PPU->reset();
+        this->CPU->reset();
+
+        //  and gets back what it had, as far as the new build still has room for it
+        if (!inPlace && this->keepStateOnReload) {
+
+            restoreSnapshot(snapshot.cpuRam, this->CPU->get_cpu_ram(), this->CPU->get_cpu_ram_size());
+            restoreSnapshot(snapshot.cpuRegs, this->CPU->get_cpu_regs(), this->CPU->get_cpu_regs_size());
+            restoreSnapshot(snapshot.prgRam, this->cartridge->get_prg_ram(), this->cartridge->get_prg_ram_size());
+            if (this->PPU) {
+
+                restoreSnapshot(snapshot.ppuRegs, this->PPU->get_ppu_regs(), this->PPU->get_ppu_regs_size());
+                restoreSnapshot(snapshot.nametables, this->PPU->get_ppu_nametables(), this->PPU->get_ppu_nametables_size());
+                restoreSnapshot(snapshot.palettes, this->PPU->get_ppu_palettes(), this->PPU->get_ppu_palettes_size());
+                restoreSnapshot(snapshot.oam, this->PPU->get_ppu_oam(), this->PPU->get_ppu_oam_size());
+                this->PPU->invalidate();
+
+            }
+
+        }
+
+        this->fitWindow();
+        showMapperError = false;
+
+    }
+    //  a build that cannot be loaded leaves the old one running
+    catch (MapperException e)
+    {
+        ErrorLogClass errorLog = ErrorLogClass();
+        showMapperError = true;
+        errorLog.Write("Unsupported Mapper. Cannot reload file: " + this->loadedPath);
+    }
+    catch (CartridgeException e)
+    {
+        ErrorLogClass errorLog = ErrorLogClass();
+        showMapperError = true;
+        errorLog.Write("Cartridge error. Cannot reload file: " + this->loadedPath);
+    }
+
+}
+
+void GUIClass::drawPaletteDialog() {
+
+    //  "Load Palette" was pressed, a bad palette file is logged by PaletteClass and the current colors are kept
+
+    this->paletteBrowser.Display();
+
+    if (this->paletteBrowser.HasSelected()) {
+
+        if (this->palette.load(this->paletteBrowser.GetSelected().string()))
+            this->viewer.invalidate();
+        this->paletteBrowser.ClearSelected();
+        showPaletteDialog = false;
+
+    }
+    else if (!this->paletteBrowser.IsOpened())
+        showPaletteDialog = false;
+
+}
+
 void GUIClass::drawErrorWindow() {
 
     // Error caused by trying to load a ROM that uses an unsupported mapper
@@ -658,12 +998,7 @@ void GUIClass::drawErrorWindow() {
 void GUIClass::saveGame() {
 
     // Only save if a ROM is loaded
-    if (this->isLoaded()) {
-
-        std::string saveFile = this->cartridge->getSaveFile();
-        std::ofstream output(saveFile, std::ios::out | std::ios::binary);
-
-        output.write((char*)this->cartridge->get_prg_ram(), this->cartridge->get_prg_ram_size());
-    }
+    if (this->isLoaded())
+        this->cartridge->save();
 }
 
@@ -0,0 +1,57 @@
+#include ".\include\HeaderDatabase.h"
+
+//	the entries, and one past the end which is never looked up, so the array is not empty when the database is
+static constexpr HeaderFix headerFixes[] = {
+
+#define HEADER_FIX(crc, mapper, submapper, mirror, tv, prgRam, prgNvram, chrRam) { crc, mapper, submapper, mirrorEnum::mirror, tvEnum::tv, prgRam, prgNvram, chrRam },
+#include ".\include\HeaderDatabase.inc"
+#undef HEADER_FIX
+	HeaderFix()
+
+};
+
+static constexpr size_t headerFixCount = (sizeof(headerFixes) / sizeof(headerFixes[0])) - 1;
+
+static constexpr HeaderTable<headerFixCount> headerTable(headerFixes);
+
+const HeaderFix* findHeaderFix(uint32_t crc) {
+
+	return headerTable.find(headerFixes, crc);
+
+}
+
+void applyHeaderFix(romHeaderStruct& header, const HeaderFix& fix) {
+
+	//	see: https://wiki.nesdev.com/w/index.php/NES_2.0#Header
+	bool nes2 = (header.flags7 & 0b00001100) == 0b00001000;
+
+	header.flags6 = (uint8_t)(((fix.mapperID & 0x0F) << 4) | (header.flags6 & 0b00000100) | (fix.prgNvramShift ? 0b00000010 : 0));
+	if (fix.mirroring == mirrorEnum::FOURSCREEN)
+		header.flags6 |= 0b00001000;
+	else if (fix.mirroring == mirrorEnum::VERTICAL)
+		header.flags6 |= 0b00000001;
+
+	header.flags7 = (uint8_t)((fix.mapperID & 0xF0) | 0b00001000 | (header.flags7 & 0b00000011));
+	header.flags8 = (uint8_t)((fix.submapperID << 4) | ((fix.mapperID >> 8) & 0x0F));
+	header.prgRamSize = (uint8_t)((fix.prgNvramShift << 4) | (fix.prgRamShift & 0x0F));
+	header.chrRamSize = fix.chrRamShift & 0x0F;
+
+	switch (fix.tvType) {
+
+	case tvEnum::PAL: header.timing = 1; break;
+	case tvEnum::DENDY: header.timing = 3; break;
+	default: header.timing = 0; break;
+
+	}
+
+	//	iNES headers have no size MSBs, and anything past byte 9 is often left over junk("DiskDude!")
+	if (!nes2) {
+
+		header.prgChrSizeMSB = 0;
+		header.flags13 = 0;
+		header.miscROMs = 0;
+		header.expandDevice = 0;
+
+	}
+
+}
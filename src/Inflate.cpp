@@ -0,0 +1,352 @@
+#include <algorithm>	//	std::min, std::fill
+#include <cstring>		//	std::memcpy
+
+#include ".\include\Inflate.h"
+#include ".\include\custom_exceptions.h"
+
+//	see RFC 1951 3.2.5 for these: https://www.rfc-editor.org/rfc/rfc1951#section-3.2.5
+static const uint16_t lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+//	the order the code length code lengths come in, see RFC 1951 3.2.7
+static const uint8_t codeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+InflateClass::InflateClass(const uint8_t* _data, size_t _size) {
+
+	this->data = _data;
+	this->size = _size;
+	this->window.resize(WINDOW_SIZE);
+
+}
+
+size_t InflateClass::read(uint8_t* out, size_t size) {
+
+	size_t done = 0;
+	while (done < size) {
+
+		//	hand out whatever has been inflated already, which may wrap around the end of the window
+		if (this->pending) {
+
+			uint32_t start = (this->windowPosition - this->pending) & (WINDOW_SIZE - 1);
+			uint32_t count = (uint32_t)std::min<size_t>({ (size_t)this->pending, size - done, (size_t)(WINDOW_SIZE - start) });
+			std::memcpy(out + done, &this->window[start], count);
+			this->pending -= count;
+			done += count;
+			continue;
+
+		}
+
+		if (this->ended)
+			break;
+		this->inflateSome();
+
+	}
+
+	return done;
+
+}
+
+void InflateClass::refill() {
+
+	while (this->bitCount <= 56) {
+
+		uint64_t byte = 0;
+		if (this->position < this->size)
+			byte = this->data[this->position++];
+		else
+			this->padBits += 8;
+
+		this->bitBuffer |= byte << this->bitCount;
+		this->bitCount += 8;
+
+	}
+
+}
+
+uint32_t InflateClass::bits(uint8_t count) {
+
+	if (this->bitCount < count)
+		this->refill();
+	if (count > this->bitCount - std::min(this->padBits, this->bitCount))
+		throw CartridgeException("Compressed ROM is truncated");
+
+	uint32_t value = (uint32_t)(this->bitBuffer & ((1ull << count) - 1));
+	this->bitBuffer >>= count;
+	this->bitCount -= count;
+	return value;
+
+}
+
+uint16_t InflateClass::decode(const Huffman& huffman) {
+
+	if (this->bitCount < 15)
+		this->refill();
+
+	uint8_t length = 0;
+	uint16_t symbol = 0;
+	uint16_t entry = huffman.fast[this->bitBuffer & ((1 << FAST_BITS) - 1)];
+	if (entry) {
+
+		symbol = entry >> 4;
+		length = entry & 0x0F;
+
+	}
+	else {
+
+		//	longer codes are worked out a bit at a time, codes are packed starting from their top bit: https://www.rfc-editor.org/rfc/rfc1951#section-3.1.1
+		int32_t code = 0, first = 0, index = 0;
+		for (length = 1; length < 16; length++) {
+
+			code |= (int32_t)((this->bitBuffer >> (length - 1)) & 1);
+			int32_t count = huffman.counts[length];
+			if (code - count < first) {
+
+				symbol = huffman.symbols[index + (code - first)];
+				break;
+
+			}
+			index += count;
+			first = (first + count) << 1;
+			code <<= 1;
+
+		}
+
+		if (length == 16)
+			throw CartridgeException("Compressed ROM has a bad code");
+
+	}
+
+	this->bits(length);
+	return symbol;
+
+}
+
+void InflateClass::build(Huffman& huffman, const uint8_t* lengths, uint16_t count) {
+
+	std::fill(std::begin(huffman.counts), std::end(huffman.counts), 0);
+	std::fill(std::begin(huffman.fast), std::end(huffman.fast), 0);
+	for (uint16_t symbol = 0; symbol < count; symbol++)
+		huffman.counts[lengths[symbol]]++;
+	huffman.counts[0] = 0;
+
+	//	more codes of a length than there is room for can never decode properly, codes that are left unused just never come up
+	int32_t left = 1;
+	for (uint8_t length = 1; length < 16; length++) {
+
+		left = (left << 1) - huffman.counts[length];
+		if (left < 0)
+			throw CartridgeException("Compressed ROM has a bad code table");
+
+	}
+
+	//	symbols in code order, and where each length starts in it
+	uint16_t offsets[16] = { 0 };
+	for (uint8_t length = 1; length < 15; length++)
+		offsets[length + 1] = offsets[length] + huffman.counts[length];
+	for (uint16_t symbol = 0; symbol < count; symbol++)
+		if (lengths[symbol])
+			huffman.symbols[offsets[lengths[symbol]]++] = symbol;
+
+	//	the short codes go in the lookup table, bit reversed since they are read from the bottom of the bit buffer, once for every value of the bits past them
+	uint32_t code = 0;
+	uint16_t index = 0;
+	for (uint8_t length = 1; length <= FAST_BITS; length++) {
+
+		for (uint16_t i = 0; i < huffman.counts[length]; i++, code++) {
+
+			uint32_t reversed = 0;
+			for (uint8_t bit = 0; bit < length; bit++)
+				reversed |= ((code >> bit) & 1) << (length - 1 - bit);
+
+			for (uint32_t slot = reversed; slot < (1u << FAST_BITS); slot += (1u << length))
+				huffman.fast[slot] = (uint16_t)((huffman.symbols[index] << 4) | length);
+			index++;
+
+		}
+		code <<= 1;
+
+	}
+
+}
+
+void InflateClass::readBlockHeader() {
+
+	this->lastBlock = this->bits(1) != 0;
+	this->blockType = (uint8_t)this->bits(2);
+	this->inBlock = true;
+
+	switch (this->blockType) {
+
+	case 0: {
+
+		//	stored blocks start on a byte, with their length and its complement
+		this->bits((uint8_t)(this->bitCount & 7));
+		uint32_t length = this->bits(16);
+		if ((length ^ 0xFFFF) != this->bits(16))
+			throw CartridgeException("Compressed ROM has a bad stored block");
+		this->storedRemaining = length;
+		break;
+
+	}
+	case 1: {
+
+		//	the fixed codes, see RFC 1951 3.2.6
+		uint8_t lengths[288];
+		std::fill(lengths, lengths + 144, 8);
+		std::fill(lengths + 144, lengths + 256, 9);
+		std::fill(lengths + 256, lengths + 280, 7);
+		std::fill(lengths + 280, lengths + 288, 8);
+		this->build(this->literals, lengths, 288);
+
+		std::fill(lengths, lengths + 30, 5);
+		this->build(this->distances, lengths, 30);
+		break;
+
+	}
+	case 2:
+		this->readDynamicTables();
+		break;
+	default:
+		throw CartridgeException("Compressed ROM has a bad block type");
+
+	}
+
+}
+
+void InflateClass::readDynamicTables() {
+
+	//	see RFC 1951 3.2.7: https://www.rfc-editor.org/rfc/rfc1951#section-3.2.7
+	uint16_t literalCount = (uint16_t)this->bits(5) + 257;
+	uint16_t distanceCount = (uint16_t)this->bits(5) + 1;
+	uint8_t codeLengthCount = (uint8_t)this->bits(4) + 4;
+	if (literalCount > 286 || distanceCount > 30)
+		throw CartridgeException("Compressed ROM has a bad code table");
+
+	uint8_t lengths[288 + 32] = { 0 };
+	for (uint8_t i = 0; i < codeLengthCount; i++)
+		lengths[codeLengthOrder[i]] = (uint8_t)this->bits(3);
+	Huffman codeLengths;
+	this->build(codeLengths, lengths, 19);
+
+	//	literal and distance code lengths are run length coded together
+	std::fill(std::begin(lengths), std::end(lengths), 0);
+	uint16_t index = 0;
+	while (index < literalCount + distanceCount) {
+
+		uint16_t symbol = this->decode(codeLengths);
+		if (symbol < 16) {
+
+			lengths[index++] = (uint8_t)symbol;
+			continue;
+
+		}
+
+		uint8_t repeat = 0, value = 0;
+		if (symbol == 16) {
+
+			if (index == 0)
+				throw CartridgeException("Compressed ROM has a bad code table");
+			value = lengths[index - 1];
+			repeat = 3 + (uint8_t)this->bits(2);
+
+		}
+		else if (symbol == 17)
+			repeat = 3 + (uint8_t)this->bits(3);
+		else
+			repeat = 11 + (uint8_t)this->bits(7);
+
+		if (index + repeat > literalCount + distanceCount)
+			throw CartridgeException("Compressed ROM has a bad code table");
+		std::fill(lengths + index, lengths + index + repeat, value);
+		index += repeat;
+
+	}
+
+	if (lengths[256] == 0)
+		throw CartridgeException("Compressed ROM has a bad code table");
+
+	this->build(this->literals, lengths, literalCount);
+	this->build(this->distances, lengths + literalCount, distanceCount);
+
+}
+
+void InflateClass::inflateSome() {
+
+	//	at most 32KB at a time, so the 32KB before it is still in the window for copies to come from
+	const uint32_t mask = WINDOW_SIZE - 1;
+	uint32_t produced = 0, limit = WINDOW_SIZE / 2;
+	uint8_t* window = this->window.data();
+
+	while (produced < limit) {
+
+		//	a copy that did not fit last time
+		if (this->copyLength) {
+
+			uint32_t count = std::min(this->copyLength, limit - produced);
+			for (uint32_t i = 0; i < count; i++, this->windowPosition++)
+				window[this->windowPosition & mask] = window[(this->windowPosition - this->copyDistance) & mask];
+			this->copyLength -= count;
+			produced += count;
+			continue;
+
+		}
+
+		if (!this->inBlock) {
+
+			if (this->lastBlock) {
+
+				this->ended = true;
+				break;
+
+			}
+			this->readBlockHeader();
+			continue;
+
+		}
+
+		if (this->blockType == 0) {
+
+			uint32_t count = std::min(this->storedRemaining, limit - produced);
+			for (uint32_t i = 0; i < count; i++)
+				window[this->windowPosition++ & mask] = (uint8_t)this->bits(8);
+			this->storedRemaining -= count;
+			produced += count;
+			if (this->storedRemaining == 0)
+				this->inBlock = false;
+			continue;
+
+		}
+
+		uint16_t symbol = this->decode(this->literals);
+		if (symbol < 256) {
+
+			window[this->windowPosition++ & mask] = (uint8_t)symbol;
+			produced++;
+
+		}
+		else if (symbol == 256)
+			this->inBlock = false;
+		else {
+
+			symbol -= 257;
+			if (symbol >= 29)
+				throw CartridgeException("Compressed ROM has a bad length");
+			this->copyLength = lengthBase[symbol] + this->bits(lengthExtra[symbol]);
+
+			uint16_t distance = this->decode(this->distances);
+			if (distance >= 30)
+				throw CartridgeException("Compressed ROM has a bad distance");
+			this->copyDistance = distanceBase[distance] + this->bits(distanceExtra[distance]);
+			if (this->copyDistance > this->total + produced)
+				throw CartridgeException("Compressed ROM has a bad distance");
+
+		}
+
+	}
+
+	this->total += produced;
+	this->pending = produced;
+
+}
@@ -0,0 +1,91 @@
+#include ".\include\MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>		//	open
+#include <unistd.h>		//	close
+#include <sys/mman.h>	//	mmap, munmap
+#include <sys/stat.h>	//	fstat
+#endif
+
+bool MappedFileClass::open(const std::string& filename) {
+
+	this->close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+
+		CloseHandle(file);
+		return false;
+
+	}
+
+	//	the mapping keeps the file open on its own, so the file handle is not needed past here
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (mapping == nullptr)
+		return false;
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+	if (view == nullptr) {
+
+		CloseHandle(mapping);
+		return false;
+
+	}
+
+	this->mapping = mapping;
+	this->view = (uint8_t*)view;
+	this->length = (size_t)size.QuadPart;
+#else
+	int file = ::open(filename.c_str(), O_RDONLY);
+	if (file < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(file, &info) != 0 || info.st_size == 0) {
+
+		::close(file);
+		return false;
+
+	}
+
+	//	same as on Windows, the mapping holds on to the file by itself
+	void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+	::close(file);
+	if (view == MAP_FAILED)
+		return false;
+
+	this->view = (uint8_t*)view;
+	this->length = (size_t)info.st_size;
+#endif
+
+	return true;
+
+}
+
+void MappedFileClass::close() {
+
+	if (this->view == nullptr)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(this->view);
+	CloseHandle((HANDLE)this->mapping);
+	this->mapping = nullptr;
+#else
+	munmap(this->view, this->length);
+#endif
+
+	this->view = nullptr;
+	this->length = 0;
+
+}
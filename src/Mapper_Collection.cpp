@@ -1,29 +1,32 @@
 #include ".\include\Mapper_Collection.h"
 
-MapperClass* selectMapper(romStruct* _rom) {
+std::unique_ptr<MapperClass> selectMapper(std::unique_ptr<romStruct> _rom) {
 
-	MapperClass* mapper = nullptr;
+	std::unique_ptr<MapperClass> mapper;
 
-	uint8_t mapperID = (_rom->header.flags7 & 0b11110000) | ((_rom->header.flags6 & 0b11110000) >> 4);
+	uint8_t mapperID = romMapperID(_rom->header);
 	switch (mapperID) {
 
 	case 0:
-		mapper = new Mapper000(_rom);
+		mapper = std::make_unique<Mapper000>(std::move(_rom));
 		break;
 	case 1:
-		mapper = new Mapper001(_rom);
+		mapper = std::make_unique<Mapper001>(std::move(_rom));
 		break;
 	case 2:
-		mapper = new Mapper002(_rom);
+		mapper = std::make_unique<Mapper002>(std::move(_rom));
 		break;
 	case 3:
-		mapper = new Mapper003(_rom);
+		mapper = std::make_unique<Mapper003>(std::move(_rom));
+		break;
+	case 4:
+		mapper = std::make_unique<Mapper004>(std::move(_rom));
 		break;
 	case 7:
-		mapper = new Mapper007(_rom);
+		mapper = std::make_unique<Mapper007>(std::move(_rom));
 		break;
 	default:
-		delete _rom;	//	rom is useless, just delete it
+		//	the ROM is useless, and is freed along with _rom
 		throw MapperException("MapperID " + std::to_string(mapperID) + " not supported");
 
 	}
@@ -0,0 +1,201 @@
+#include <cmath>
+#include <algorithm>
+
+#include ".\include\NtscFilter.h"
+#include ".\include\simd_util.h"
+
+//	voltage levels of the signal, relative to sync, see: https://wiki.nesdev.com/w/index.php/NTSC_video#Terminated_measurement
+static const float signalLow[4] = { 0.350f, 0.518f, 0.962f, 1.550f };
+static const float signalHigh[4] = { 1.094f, 1.506f, 1.962f, 1.962f };
+static const float signalBlack = 0.518f, signalWhite = 1.962f, signalAttenuation = 0.746f;
+
+//	line the decoded colors up with the ones in our palette
+static const float decodeHue = 3.9f;
+static const float decodeSaturation = 1.5f;
+
+static const float pi = 3.14159265f;
+
+NtscFilterClass::NtscFilterClass() {
+
+	this->buildKernels();
+
+#ifdef SIMD_X86
+	this->useSSE2 = cpuHasSSE2();
+#endif
+
+}
+
+void NtscFilterClass::submitFrame(const FrameBuffer& frame) {
+
+	//	the previous frame has had a whole frame's worth of time, so this should rarely have to wait
+	this->wait();
+	if (this->workingStarted) {
+
+		std::swap(this->output, this->working);
+		this->outputWidth = this->workingWidth;
+		this->outputHeight = this->workingHeight;
+		this->outputReady = true;
+
+	}
+
+	this->input.width = frame.width;
+	this->input.height = frame.height;
+	this->input.pixels = frame.pixels;
+
+	this->workingWidth = frame.width * NTSC_OUTPUT_SCALE;
+	this->workingHeight = frame.height;
+	this->workingPhase = this->framePhase;
+	this->working.resize((size_t)this->workingWidth * this->workingHeight);
+	this->workingStarted = true;
+
+	//	NTSC frames are an odd number of samples long, so the subcarrier starts a third of a cycle later every frame
+	this->framePhase = (this->framePhase + 1) % NTSC_PHASES;
+
+	if (this->pool != nullptr)
+		this->pool->start(frame.height, [this](uint32_t first, uint32_t last) { this->filterRows(first, last); });
+	else
+		this->filterRows(0, frame.height);
+
+}
+
+void NtscFilterClass::flush() {
+
+	this->wait();
+	this->workingStarted = false;
+	this->outputReady = false;
+
+}
+
+void NtscFilterClass::buildKernels() {
+
+	this->kernels.assign((size_t)512 * NTSC_PHASES * NTSC_TAPS * 4, 0.0f);
+
+	for (uint16_t pixel = 0; pixel < 512; pixel++) {
+
+		//	see: https://wiki.nesdev.com/w/index.php/NTSC_video#Brightness_Levels
+		int32_t color = pixel & 0x0F;
+		int32_t level = (pixel >> 4) & 0x03;
+		int32_t emphasis = pixel >> 6;
+
+		//	colors 14 and 15 are forced to level 1, color 0 only emits the high level, 13 to 15 only the low level
+		if (color > 13)
+			level = 1;
+		float low = signalLow[level], high = signalHigh[level];
+		if (color == 0)
+			low = high;
+		if (color > 12)
+			high = low;
+
+		for (uint32_t phase = 0; phase < NTSC_PHASES; phase++) {
+
+			//	the 8 samples the PPU puts out for this pixel
+			float samples[8];
+			for (int32_t p = 0; p < 8; p++) {
+
+				int32_t samplePhase = (int32_t)(phase * 4) + p;
+				auto inColorPhase = [samplePhase](int32_t c) { return ((c + samplePhase) % 12) < 6; };
+
+				float signal = inColorPhase(color) ? high : low;
+				if (((emphasis & 1) && inColorPhase(0)) || ((emphasis & 2) && inColorPhase(4)) || ((emphasis & 4) && inColorPhase(8)))
+					signal *= signalAttenuation;
+
+				samples[p] = (signal - signalBlack) / (signalWhite - signalBlack);
+
+			}
+
+			//	output pixels are centered every 4 samples starting 2 samples before the pixel, and each one averages the 12 samples around its center
+			for (int32_t tap = 0; tap < (int32_t)NTSC_TAPS; tap++) {
+
+				int32_t center = -2 + (tap * 4);
+				float y = 0.0f, i = 0.0f, q = 0.0f;
+
+				for (int32_t p = std::max(center - 6, 0); p < std::min(center + 6, 8); p++) {
+
+					float angle = pi * ((float)((phase * 4) + p) + decodeHue) / 6.0f;
+					y += samples[p] / 12.0f;
+					i += samples[p] * std::cos(angle) * decodeSaturation / 12.0f;
+					q += samples[p] * std::sin(angle) * decodeSaturation / 12.0f;
+
+				}
+
+				//	YIQ to RGB, see: https://en.wikipedia.org/wiki/YIQ
+				float* entry = &this->kernels[((((size_t)pixel * NTSC_PHASES) + phase) * NTSC_TAPS + tap) * 4];
+				entry[0] = y + (0.946882f * i) + (0.623557f * q);
+				entry[1] = y - (0.274788f * i) - (0.635691f * q);
+				entry[2] = y - (1.108545f * i) + (1.709007f * q);
+				entry[3] = 0.0f;
+
+			}
+
+		}
+
+	}
+
+}
+
+void NtscFilterClass::filterRows(uint32_t first, uint32_t last) {
+
+	uint32_t width = this->input.width;
+
+	//	one accumulator per output pixel, plus one on each side for the taps that spill over the edges
+	std::vector<float> sums(((size_t)width * NTSC_OUTPUT_SCALE + 2) * 4);
+
+	for (uint32_t y = first; y < last; y++) {
+
+		const uint16_t* pixels = &this->input.pixels[(size_t)y * width];
+		uint32_t* colors = &this->working[(size_t)y * this->workingWidth];
+		uint32_t rowPhase = (this->workingPhase + y) % NTSC_PHASES;
+		std::fill(sums.begin(), sums.end(), 0.0f);
+
+#ifdef SIMD_X86
+		if (this->useSSE2) {
+
+			//	every pixel adds its taps into the 4 output pixels starting 1 before its own
+			__m128* accumulators = (__m128*)&sums.at(0);
+			for (uint32_t x = 0; x < width; x++) {
+
+				const float* taps = this->kernel(pixels[x] & (FRAME_PIXEL_BITMASKS::F_INDEX | FRAME_PIXEL_BITMASKS::F_EMPHASIS), (rowPhase + (x * 2)) % NTSC_PHASES);
+				__m128* sum = accumulators + (x * NTSC_OUTPUT_SCALE);
+				for (uint32_t tap = 0; tap < NTSC_TAPS; tap++)
+					_mm_storeu_ps((float*)(sum + tap), _mm_add_ps(_mm_loadu_ps((const float*)(sum + tap)), _mm_loadu_ps(taps + (tap * 4))));
+
+			}
+
+			const __m128 scale = _mm_set1_ps(255.0f), zero = _mm_setzero_ps();
+			for (uint32_t x = 0; x < this->workingWidth; x++) {
+
+				__m128 color = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps((const float*)(accumulators + x + 1)), scale), zero), scale);
+				__m128i bytes = _mm_cvtps_epi32(color);
+				bytes = _mm_packs_epi32(bytes, bytes);
+				bytes = _mm_packus_epi16(bytes, bytes);
+				colors[x] = (uint32_t)_mm_cvtsi128_si32(bytes) | 0xFF000000;
+
+			}
+
+			continue;
+
+		}
+#endif
+
+		for (uint32_t x = 0; x < width; x++) {
+
+			const float* taps = this->kernel(pixels[x] & (FRAME_PIXEL_BITMASKS::F_INDEX | FRAME_PIXEL_BITMASKS::F_EMPHASIS), (rowPhase + (x * 2)) % NTSC_PHASES);
+			float* sum = &sums[(size_t)x * NTSC_OUTPUT_SCALE * 4];
+			for (uint32_t i = 0; i < NTSC_TAPS * 4; i++)
+				sum[i] += taps[i];
+
+		}
+
+		for (uint32_t x = 0; x < this->workingWidth; x++) {
+
+			//	written a byte at a time so the output is in R, G, B, A order no matter the endianness
+			uint8_t* color = (uint8_t*)&colors[x];
+			for (uint32_t channel = 0; channel < 3; channel++)
+				color[channel] = (uint8_t)std::lround(std::min(std::max(sums[((size_t)x + 1) * 4 + channel] * 255.0f, 0.0f), 255.0f));
+			color[3] = 0xFF;
+
+		}
+
+	}
+
+}
@@ -4,9 +4,9 @@
 
 #include ".\include\PPU.h"
 #include ".\include\CPU.h"
-#include ".\include\GUI.h"
 #include ".\include\Cartridge.h"
 #include ".\include\romStruct.h"
+#include ".\include\TileCache.h"
 
 #include ".\include\custom_exceptions.h"
 #include ".\include\ErrorLog.h"
@@ -17,6 +17,12 @@ PPUClass::PPUClass() {
 	this->nametables.resize(0x0800);
 	this->palettes.resize(0x0020);
 	this->OAM.resize(0x0100);
+
+	this->compose = selectComposeKernel();
+
+	//	the CPU can cycle us before the ROM's region is known, reset() rebuilds this once it is
+	this->buildActionTable(tvEnum::NTSC);
+	this->buildEmphasisTable(tvEnum::NTSC);
 	
 }
 
@@ -29,12 +35,17 @@ uint8_t PPUClass::access(uint16_t addr, uint8_t data, bool isWrite) {
 		
 		if (isWrite) {
 
-			this->nametables[this->addressMirrorAdjust(addr)] = data;
+			this->nametable(addr) = data;
+
+			uint8_t* slot = this->nametableSlots[(addr >> 10) & 0x03];
+			for (uint8_t i = 0; i < 4; i++)
+				if (this->nametableSlots[i] == slot)
+					this->dirty |= 1 << i;
 			return 0;
 
 		}
 
-		return this->nametables[this->addressMirrorAdjust(addr)];
+		return this->nametable(addr);
 
 	}
 	else if (addr <= 0x3FFF) { // Palette Memory
@@ -43,13 +54,14 @@ uint8_t PPUClass::access(uint16_t addr, uint8_t data, bool isWrite) {
 
 			if ((addr & 0x13) == 0x10) addr &= ~0x10;
 			this->palettes.at(addr & 0x1F) = data;
+			this->dirty |= DIRTY_BITMASKS::D_PALETTE;
 			return 0;
 
 		}
 		else {
 
 			if ((addr & 0x13) == 0x10) addr &= ~0x10;
-			return (this->palettes.at(addr & 0x1F) & ((this->registers.MASK & MASK_BITMASKS::GREYSCALE) ? 0x30 : 0xFF));
+			return (this->palettes.at(addr & 0x1F) & this->greyMask);
 
 		}
 
@@ -73,7 +85,9 @@ void PPUClass::write(uint16_t addr, uint8_t& data) {
 		break;
 
 	case 0x0001: // MASK Register
+		this->composeDrawn();
 		this->registers.MASK = data;
+		this->greyMask = (this->registers.MASK & MASK_BITMASKS::GREYSCALE) ? 0x30 : 0xFF;
 		break;
 
 	case 0x0003: // OAMADDR Register
@@ -82,11 +96,14 @@ void PPUClass::write(uint16_t addr, uint8_t& data) {
 
 	case 0x0004: // OAMDATA Register
 		this->OAM[this->registers.OAMADDR++] = data;
+		this->dirty |= DIRTY_BITMASKS::D_OAM;
+		this->spritesDirty = true;
 		break;
 
 	case 0x0005: // PPUSCROLL Register
 		if (!this->latch) {
 
+			this->composeDrawn();
 			this->fineX = data & 7;
 			this->tAddr.cX = data >> 3;
 
@@ -107,14 +124,17 @@ void PPUClass::write(uint16_t addr, uint8_t& data) {
 
 			this->tAddr.l = data;
 			this->vAddr.r = this->tAddr.r;
+			this->follow_a12();
 
 		}
 		this->latch = !this->latch;
 		break;
 
 	case 0x0007: // PPUDATA Register
+		this->composeDrawn();
 		this->access(this->vAddr.addr, data, true);
 		this->vAddr.addr += (this->registers.CTRL & CTRL_BITMASKS::INCREMENT) ? 32 : 1;
+		this->follow_a12();
 		break;
 
 	}
@@ -130,6 +150,7 @@ uint8_t PPUClass::read(uint16_t addr) {
 	switch (addr) {
 
 	case 0x0002: // STATUS Register
+		this->composeDrawn();
 		this->result = (this->registers.STAT & 0xE0) | (this->result & 0x1F);
 
 		ClearRegisterBits(this->registers.STAT, STAT_BITMASKS::VBLANK);
@@ -145,6 +166,7 @@ uint8_t PPUClass::read(uint16_t addr) {
 		if (this->vAddr.addr >= 0x3F00)
 			this->result = buffer;
 		this->vAddr.addr += (this->registers.CTRL & CTRL_BITMASKS::INCREMENT) ? 32 : 1;
+		this->follow_a12();
 		return this->result;
 
 	default:
@@ -156,20 +178,17 @@ uint8_t PPUClass::read(uint16_t addr) {
 
 std::tuple<uint32_t, uint32_t> PPUClass::getResolution() {
 
-	try {
-
-		return std::make_tuple(this->tvResolutionX[this->cartridge->getTV()], this->tvResolutionY[this->cartridge->getTV()]);
+	//	PAL and Dendy only have a longer vblank, the visible picture is the same for every region
+	return std::make_tuple(VISIBLE_WIDTH, VISIBLE_SCANLINES);
 
-	}
-	catch (const CartridgeException& e) {
+}
 
-		ErrorLogClass log = ErrorLogClass();
-		
-		log.Write("Cannot get resolution from cartridge.");
+std::tuple<uint32_t, uint32_t> PPUClass::getScroll() {
 
-		return std::make_tuple(0, 0);
-
-	}
+	//	T holds the scroll the next frame starts from, in the 512x480 space of all 4 nametables: https://wiki.nesdev.com/w/index.php/PPU_scrolling
+	uint32_t x = ((this->tAddr.nt & 0x01) * VISIBLE_WIDTH) + (this->tAddr.cX * 8) + this->fineX;
+	uint32_t y = ((this->tAddr.nt >> 1) * VISIBLE_SCANLINES) + (this->tAddr.cY * 8) + this->tAddr.fY;
+	return std::make_tuple(x, y);
 
 }
 
@@ -177,7 +196,7 @@ uint32_t PPUClass::getTVFrameRate() {
 
 	try {
 
-		return this->tvFrameRate[this->cartridge->getTV()];
+		return regionFrameRate(this->cartridge->getTV());
 
 	}
 	catch (const CartridgeException& e) {
@@ -201,37 +220,42 @@ void PPUClass::reset() {
 	ResetRegister(this->registers.CTRL);
 	ResetRegister(this->registers.MASK);
 	ResetRegister(this->registers.STAT);
+	this->greyMask = 0xFF;
 	
 	// Clear out the OAM and nametable data
 	std::fill(this->OAM.begin(), this->OAM.end(), 0x00);
 	std::fill(this->nametables.begin(), this->nametables.end(), 0xFF);
+	this->spritesDirty = true;
+	this->nametableSlots = this->cartridge->loadNametables(&this->nametables.at(0));
+
+	//	four-screen carts point the slots at their own VRAM instead(see Mapper.h), which is cleared the same way, so nothing survives a reset
+	for (uint8_t i = 0; i < 4; i++)
+		std::fill(this->nametableSlots[i], this->nametableSlots[i] + 0x0400, 0xFF);
+	this->tiles = this->cartridge->getTileCache();
+	this->dirty = 0xFF;
+
+	//	the scanline layout depends on the region, and whether the mapper cares about A12
+	this->watchA12 = this->cartridge->watchesA12();
+	this->a12 = false;
+	this->buildActionTable(this->cartridge->getTV());
+	this->buildEmphasisTable(this->cartridge->getTV());
 
 	//	Also need to reset the scanline and current pixel
 	this->scanline = 0;
 	this->scanlinePixel = 0;
+	this->composed = 0;
 
 	// Also need to reset the pixels here, to ensure the screen is the proper size based on the type of ROM(NTSC vs. PAL)
-	this->pixels.create(this->tvResolutionX[this->cartridge->getTV()], this->tvResolutionY[this->cartridge->getTV()]);
+	this->frame.create(VISIBLE_WIDTH, VISIBLE_SCANLINES);
 
 }
 
+template<tvEnum tv>
 void PPUClass::cycle() {
 
-	uint32_t resWidth, resHeight;
-	std::tie(resWidth, resHeight) = this->getResolution();
-
-	//	check if we are in the PRE phase
-	if (scanline == -1)
-		this->pre_scanline();
-	//	grab the TV's height, this will tell us how many scanlines are drawn
-	else if ((uint32_t)scanline < resHeight)
-		frame_scanline();
-	//	for the POST scanline, here we can update the GUI's frame to render
-	else if ((uint32_t)scanline == (resHeight))
-		post_scanline();
-	//	for the VBLANK start of scanlines, the only thing that happens is on 241(second scanline after VISIBLE scanlines complete), setting the VBLANK flag
-	else if ((uint32_t)scanline == (resHeight + 1))
-		blank_scanline();
+	uint32_t actions = this->dotActions[this->scanlineTypes[this->scanline + 1]][this->scanlinePixel];
+	if (actions)
+		this->runActions(actions);
 
 	//	check to see if the next scanline pixel is past the scanline size
 	if (++(this->scanlinePixel) > 340) {
@@ -240,130 +264,324 @@ void PPUClass::cycle() {
 		this->scanlinePixel %= 341;
 
 		//	check if the next scanline is past the size, if so, reset
-		if ((uint32_t)(++(this->scanline)) > (this->tvResolutionY[this->cartridge->getTV()] + 20))
+		if (++(this->scanline) > RegionTiming<tv>::LAST_SCANLINE)
 			this->scanline = -1;
 
 	}
 
 }
 
-void PPUClass::pre_scanline() {
+template void PPUClass::cycle<tvEnum::NTSC>();
+template void PPUClass::cycle<tvEnum::PAL>();
+template void PPUClass::cycle<tvEnum::DENDY>();
 
-	if (this->scanlinePixel == 1) {
-		// Clear the Status register without disturbing the unused bits.
-		ClearRegisterBits(this->registers.STAT, (STAT_BITMASKS::S_0_HIT | STAT_BITMASKS::S_OVERFLOW));
-		ClearRegisterBits(this->registers.STAT, STAT_BITMASKS::VBLANK);
-	}
-	//	prerender piggybacks off the rendered, because the PPU still does accesses before the frame happens
-	this->frame_scanline();
+void PPUClass::buildEmphasisTable(tvEnum tv) {
 
-	// Copy vertical bits from t to v between pixels 280 and 304 in the pre-scanline
-	// according to documentation at: https://wiki.nesdev.com/w/index.php/PPU_scrolling#During_dots_280_to_304_of_the_pre-render_scanline_.28end_of_vblank.29
-	if (this->scanlinePixel >= 280 || this->scanlinePixel <= 304)
-		this->vertical_update();
-	//	according to documentation, we skip over the last pixel on the prerendered scanline only on odd frames: https://wiki.nesdev.com/w/index.php/PPU_rendering#Pre-render_scanline_.28-1_or_261.29
-	else if (this->scanlinePixel == 340 && this->isOddFrame)
-		this->scanlinePixel++;
+	bool swapped = regionSwapsEmphasis(tv);
+	for (uint8_t bits = 0; bits < 8; bits++) {
+
+		uint8_t emphasis = bits;
+		if (swapped)
+			emphasis = (bits & 0x04) | ((bits & 0x01) << 1) | ((bits & 0x02) >> 1);
+		this->emphasisBits[bits] = (uint16_t)(emphasis << 6);
+
+	}
 
 }
 
-void PPUClass::frame_scanline() {
+void PPUClass::buildActionTable(tvEnum tv) {
 
-	//	there are a total of 340 "pixels" to handle on a scanline, 240 are visible, the rest still perform tasks
-	static uint16_t address = 0;
+	int16_t lastScanline = RegionTiming<tvEnum::NTSC>::LAST_SCANLINE, vblankScanline = RegionTiming<tvEnum::NTSC>::VBLANK_SCANLINE;
+	if (tv == tvEnum::PAL) {
 
-	//	this entire section basically takes care of what pixel is handled on each scanline within the visible frame: https://wiki.nesdev.com/w/images/d/d1/Ntsc_timing.png
-	if ((this->scanlinePixel >= 2 && this->scanlinePixel <= 255) || (this->scanlinePixel >= 322 && this->scanlinePixel <= 337)) {
+		lastScanline = RegionTiming<tvEnum::PAL>::LAST_SCANLINE;
+		vblankScanline = RegionTiming<tvEnum::PAL>::VBLANK_SCANLINE;
 
-		this->pixelDraw();
+	}
+	else if (tv == tvEnum::DENDY) {
 
-		//	for the visible segment, there are only 8 different possibilities that can happen
-		switch (this->scanlinePixel % 8) {
+		lastScanline = RegionTiming<tvEnum::DENDY>::LAST_SCANLINE;
+		vblankScanline = RegionTiming<tvEnum::DENDY>::VBLANK_SCANLINE;
 
-		//	NT reads cost 2 cycles, so first grab the address, then read from it
-		case 1: address = this->addressNT(); this->reload_shift(); break;
-		case 2: this->NT = this->access(address); break;
+	}
 
-		//	same as NT, AT reads cost 2 cycles, uses Loopy's
-		case 3: address = this->addressAT(); break;
-		case 4:
-			this->AT = this->access(address);
-			if (this->vAddr.cY & 2)
-				this->AT >>= 4;
-			if (this->vAddr.cX & 2)
-				this->AT >>= 2;
-			break;
+	for (int16_t line = -1; line <= lastScanline; line++) {
 
-		// Background is broken up into 2 parts, so this will take 4 cycles to perform
-		
-		// Background lower byte
-		case 5: address = this->addressBG(); break;
-		case 6: this->BGL = this->access(address); break;
+		if (line == -1)
+			this->scanlineTypes[line + 1] = SCANLINE_TYPES::PRE;
+		else if (line < (int16_t)VISIBLE_SCANLINES)
+			this->scanlineTypes[line + 1] = SCANLINE_TYPES::FRAME;
+		else if (line == (int16_t)VISIBLE_SCANLINES)
+			this->scanlineTypes[line + 1] = SCANLINE_TYPES::POST;
+		else if (line == vblankScanline)
+			this->scanlineTypes[line + 1] = SCANLINE_TYPES::BLANK;
+		else
+			this->scanlineTypes[line + 1] = SCANLINE_TYPES::IDLE;
+
+	}
+
+	for (uint8_t type = 0; type < SCANLINE_TYPES::SCANLINE_TYPE_COUNT; type++)
+		std::fill(std::begin(this->dotActions[type]), std::end(this->dotActions[type]), 0);
 
-		// Background upper byte
-		case 7: address += 8; break;
-		case 0: this->BGH = this->access(address); this->horizontal_scroll(); break;
+	//	the pre-render scanline does all the same fetches as a visible scanline, it just does not draw anything
+	//	this entire section follows what pixel is handled on each scanline within the visible frame: https://wiki.nesdev.com/w/images/d/d1/Ntsc_timing.png
+	for (uint16_t dot = 1; dot <= 340; dot++) {
+
+		uint32_t actions = 0;
+
+		if ((dot >= 2 && dot <= 255) || (dot >= 322 && dot <= 337)) {
+
+			//	for the visible segment, there are only 8 different possibilities that can happen
+			//	NT and AT reads cost 2 cycles, so first grab the address, then read from it
+			//	background is broken up into 2 parts, but the tile cache hands us both planes already decoded, so the upper byte fetch has nothing left to do
+			switch (dot % 8) {
+
+			case 1: actions = A_NT_ADDR | A_RELOAD; break;
+			case 2: actions = A_NT_FETCH; break;
+			case 3: actions = A_AT_ADDR; break;
+			case 4: actions = A_AT_FETCH; break;
+			case 5: actions = A_BG_ADDR; break;
+			case 6: actions = A_BG_FETCH; break;
+			case 0: actions = A_SCROLL_X; break;
+
+			}
 
 		}
+		else if (dot == 1)
+			actions = A_CLEAR_OAM | A_NT_ADDR;
+		//	at dot 256 we vertical scroll to wrap to the next nametable appropriately: https://wiki.nesdev.com/w/index.php/PPU_scrolling#At_dot_256_of_each_scanline
+		else if (dot == 256)
+			actions = A_SCROLL_Y;
+		//	at dot 257 we copy the bits related to horizontal position from t to v: https://wiki.nesdev.com/w/index.php/PPU_scrolling#At_dot_257_of_each_scanline
+		else if (dot == 257)
+			actions = A_EVAL_SPRITES | A_RELOAD | A_UPDATE_X;
+		//	get the sprites and nametable address in preparation for the next scanline
+		else if (dot == 321)
+			actions = A_LOAD_SPRITES | A_NT_ADDR;
+		else if (dot == 339)
+			actions = A_NT_ADDR;
+		else if (dot == 338 || dot == 340)
+			actions = A_NT_FETCH;
+
+		this->dotActions[SCANLINE_TYPES::PRE][dot] = actions;
+		this->dotActions[SCANLINE_TYPES::FRAME][dot] = actions;
+
+		//	pixels are composed a group at a time, once the last pixel of the group is reached(pixel x is drawn on dot x + 2)
+		if (dot >= 2 + COMPOSE_GROUP_SIZE - 1 && dot <= 257 && ((dot - 2) % COMPOSE_GROUP_SIZE) == (COMPOSE_GROUP_SIZE - 1))
+			this->dotActions[SCANLINE_TYPES::FRAME][dot] |= A_COMPOSE;
 
 	}
-	else if (this->scanlinePixel == 1)
-	{
-		this->clear_oam();
-		address = this->addressNT();
+
+	this->dotActions[SCANLINE_TYPES::PRE][1] |= A_CLEAR_STATUS;
+
+	//	copy vertical bits from t to v between pixels 280 and 304 in the pre-scanline
+	//	according to documentation at: https://wiki.nesdev.com/w/index.php/PPU_scrolling#During_dots_280_to_304_of_the_pre-render_scanline_.28end_of_vblank.29
+	for (uint16_t dot = 280; dot <= 304; dot++)
+		this->dotActions[SCANLINE_TYPES::PRE][dot] |= A_UPDATE_Y;
+
+	//	according to documentation, only NTSC skips over the last pixel on the prerendered scanline on odd frames: https://wiki.nesdev.com/w/index.php/PPU_rendering#Pre-render_scanline_.28-1_or_261.29
+	if (tv == tvEnum::NTSC)
+		this->dotActions[SCANLINE_TYPES::PRE][339] |= A_SKIP_DOT;
+
+	//	sprite patterns are fetched on dots 261 to 320 in 8 dot slots, then the next line's first background tile on dot 325
+	if (this->watchA12) {
+
+		for (uint16_t dot = 261; dot <= 325; dot += 8) {
+
+			this->dotActions[SCANLINE_TYPES::PRE][dot] |= A_WATCH_A12;
+			this->dotActions[SCANLINE_TYPES::FRAME][dot] |= A_WATCH_A12;
+
+		}
+
 	}
-	else if (this->scanlinePixel == 256) {
-		// At pixel 256 we vertical scroll to wrap to the next nametable appropriately
-		// For more info: https://wiki.nesdev.com/w/index.php/PPU_scrolling#At_dot_256_of_each_scanline
-		this->pixelDraw();
-		this->BGH = this->access(address);
-		this->vertical_scroll();
 
+	//	for the POST scanline, here we can update the GUI's frame to render
+	this->dotActions[SCANLINE_TYPES::POST][0] = A_SUBMIT_FRAME;
+	this->dotActions[SCANLINE_TYPES::BLANK][1] = A_SET_VBLANK;
+
+}
+
+void PPUClass::runActions(uint32_t actions) {
+
+	if (actions & A_CLEAR_STATUS) {
+		// Clear the Status register without disturbing the unused bits.
+		ClearRegisterBits(this->registers.STAT, (STAT_BITMASKS::S_0_HIT | STAT_BITMASKS::S_OVERFLOW));
+		ClearRegisterBits(this->registers.STAT, STAT_BITMASKS::VBLANK);
 	}
-	else if (this->scanlinePixel == 257) {
-		// At pixel 257 we copy the bits related to horizontal position from t to v.
-		// For more info: https://wiki.nesdev.com/w/index.php/PPU_scrolling#At_dot_257_of_each_scanline
+
+	if (actions & A_CLEAR_OAM)
+		this->clear_oam();
+	if (actions & A_EVAL_SPRITES)
 		this->evaluate_sprites();
-		this->pixelDraw();
+	if (actions & A_COMPOSE)
+		this->composeUpTo(this->scanlinePixel - 1);
+
+	if (actions & A_NT_ADDR)
+		this->fetchAddress = this->addressNT();
+	if (actions & A_RELOAD)
 		this->reload_shift();
-		this->horizontal_update();
+	if (actions & A_NT_FETCH)
+		this->NT = this->nametable(this->fetchAddress);
 
-	}
-	else if (this->scanlinePixel == 321) {
-		// Get Nametable address in preparation for the next scanline
-		// For more info: https://wiki.nesdev.com/w/images/d/d1/Ntsc_timing.png
-		this->load_sprites();
-		address = this->addressNT();
+	//	same as NT, AT reads cost 2 cycles, uses Loopy's
+	if (actions & A_AT_ADDR)
+		this->fetchAddress = this->addressAT();
+	if (actions & A_AT_FETCH) {
+
+		this->AT = this->nametable(this->fetchAddress);
+		if (this->vAddr.cY & 2)
+			this->AT >>= 4;
+		if (this->vAddr.cX & 2)
+			this->AT >>= 2;
 
 	}
-	else if (this->scanlinePixel == 339)
-		address = this->addressNT();
-	else if (this->scanlinePixel == 338 || this->scanlinePixel == 340)
-		this->NT = this->access(address);
 
-}
+	if (actions & A_BG_ADDR)
+		this->fetchAddress = this->addressBG();
+	if (actions & A_BG_FETCH)
+		this->BG = this->tiles->row(this->fetchAddress, false).packed;
 
-void PPUClass::post_scanline() {
+	if (actions & A_SCROLL_X)
+		this->horizontal_scroll();
+	if (actions & A_SCROLL_Y)
+		this->vertical_scroll();
+	if (actions & A_UPDATE_X)
+		this->horizontal_update();
+	if (actions & A_UPDATE_Y)
+		this->vertical_update();
 
-	//	we only need to update the frame once
-	if (this->scanlinePixel == 0)
-		this->GUI->updateFrame(this->pixels);
+	if (actions & A_LOAD_SPRITES) {
 
-}
+		this->load_sprites();
+		this->bgFill = 0;
+		this->composed = 0;
 
-void PPUClass::blank_scanline() {
+	}
 
-	if (this->scanlinePixel == 1) {
+	if (actions & A_SET_VBLANK) {
 
 		// Set VBlank flag
 		SetRegisterBits(this->registers.STAT, STAT_BITMASKS::VBLANK);
-		
-		if (this->registers.CTRL & CTRL_BITMASKS::NMI) // if NMI is set
+
+		//	the CPU is nullptr while the PPU runs on its own thread, the CPU raises NMI itself then
+		if ((this->registers.CTRL & CTRL_BITMASKS::NMI) && this->CPU) // if NMI is set
 		{
 			this->CPU->setNMI(true);
 		}
+
+	}
+
+	//	we only need to update the frame once
+	if ((actions & A_SUBMIT_FRAME) && this->sink)
+		this->sink->submitFrame(this->frame);
+
+	if (actions & A_WATCH_A12)
+		this->watch_a12();
+
+	if ((actions & A_SKIP_DOT) && this->isOddFrame && this->rendering())
+		this->scanlinePixel++;
+
+}
+
+void PPUClass::watch_a12() {
+
+	//	nothing is fetched while rendering is off
+	if (!this->rendering())
+		return;
+
+	bool high = (this->registers.CTRL & CTRL_BITMASKS::BACKGROUND) != 0;
+
+	if (this->scanlinePixel < 320) {
+
+		//	the last fetch before the first sprite slot was the background's, at dot 253
+		uint8_t slot = (uint8_t)((this->scanlinePixel - 261) / 8);
+		if (slot == 0)
+			this->a12 = high;
+
+		//	8x16 sprites pick the table with bit 0 of the tile index, empty slots fetch tile 0xFF, which is in 0x1000
+		if (this->sprite_height() == 16)
+			high = (this->secondaryOAM[slot].data.index & 0x01) != 0;
+		else
+			high = (this->registers.CTRL & CTRL_BITMASKS::SPRITE) != 0;
+
+	}
+
+	if (high && !this->a12)
+		this->cartridge->clockA12();
+	this->a12 = high;
+
+}
+
+void PPUClass::follow_a12() {
+
+	//	while the PPU is fetching it owns the bus, and watch_a12 follows it
+	if (!this->watchA12 || (this->rendering() && this->scanline < (int16_t)VISIBLE_SCANLINES))
+		return;
+
+	bool high = (this->vAddr.addr & 0x1000) != 0;
+	if (high && !this->a12)
+		this->cartridge->clockA12();
+	this->a12 = high;
+
+}
+
+uint64_t PPUClass::dotsToA12Rise(int16_t lastScanline) {
+
+	//	turning rendering on is a write, which the pipeline asks again after
+	if (!this->watchA12 || !this->rendering())
+		return A12_NEVER;
+
+	bool background = (this->registers.CTRL & CTRL_BITMASKS::BACKGROUND) != 0;
+	bool sprites = (this->registers.CTRL & CTRL_BITMASKS::SPRITE) != 0;
+	bool a12 = this->a12;
+
+	//	dots from here to dot 0 of the scanline being looked at, the same as watch_a12 would see it, a frame and a bit is enough to come back round to the same fetches
+	int64_t lineStart = -(int64_t)this->scanlinePixel;
+	int16_t line = this->scanline;
+	for (int32_t lines = 0; lines <= lastScanline + 2; lines++) {
+
+		uint8_t type = this->scanlineTypes[line + 1];
+		if (type == SCANLINE_TYPES::PRE || type == SCANLINE_TYPES::FRAME) {
+
+			//	secondary OAM is only filled in at dot 257 of a visible scanline, the pre-render scanline's is cleared and never filled, so every slot fetches tile 0xFF
+			bool known = (type == SCANLINE_TYPES::PRE) || (lines == 0 && this->scanlinePixel > 257);
+			for (int16_t dot = 261; dot <= 325; dot += 8) {
+
+				if (lines == 0 && dot < this->scanlinePixel)
+					continue;
+
+				bool high = background;
+				if (dot < 320) {
+
+					uint8_t slot = (uint8_t)((dot - 261) / 8);
+					if (slot == 0)
+						a12 = background;
+
+					if (this->sprite_height() != 16)
+						high = sprites;
+					else if (!known)
+						return (uint64_t)(lineStart + dot + 1);
+					else
+						high = (type == SCANLINE_TYPES::PRE) || (this->secondaryOAM[slot].data.index & 0x01) != 0;
+
+				}
+
+				if (high && !a12)
+					return (uint64_t)(lineStart + dot + 1);
+				a12 = high;
+
+			}
+
+		}
+
+		//	the pre-render scanline may be a dot short, taking it as short can only make the answer early
+		lineStart += (line == -1) ? 340 : 341;
+		line = (line >= lastScanline) ? -1 : line + 1;
+
 	}
 
+	return A12_NEVER;
+
 }
 
 void PPUClass::horizontal_scroll() {
@@ -406,11 +624,16 @@ void PPUClass::vertical_scroll() {
 
 void PPUClass::reload_shift() {
 
-	this->bgShiftL = (this->bgShiftL & 0xFF00) | (uint16_t)this->BGL;
-	this->bgShiftH = (this->bgShiftH & 0xFF00) | (uint16_t)this->BGH;
+	if (this->bgFill + 8 > sizeof(this->bgLine))
+		return;
+
+	//	transparent pixels stay 0 no matter the attribute, so the compose kernels can test them directly
+	for (uint8_t i = 0; i < 8; i++) {
+
+		uint8_t pixel = (this->BG >> (14 - (i * 2))) & 0x03;
+		this->bgLine[this->bgFill++] = pixel ? (pixel | ((this->AT & 0x03) << 2)) : 0;
 
-	this->ATLatchL = (this->AT & 0b01);
-	this->ATLatchH = (this->AT & 0b10);
+	}
 
 }
 
@@ -423,8 +646,7 @@ void PPUClass::clear_oam() {
 		this->secondaryOAM[i].data.index = 0xFF;
 		this->secondaryOAM[i].data.attributes = 0xFF;
 		this->secondaryOAM[i].data.x = 0xFF;
-		this->secondaryOAM[i].dataL = 0x00;
-		this->secondaryOAM[i].dataH = 0x00;
+		std::fill(std::begin(this->secondaryOAM[i].pixels), std::end(this->secondaryOAM[i].pixels), 0x00);
 
 	}
 
@@ -432,6 +654,36 @@ void PPUClass::clear_oam() {
 
 void PPUClass::evaluate_sprites() {
 
+	if (this->spritesDirty || this->spriteBucketHeight != this->sprite_height())
+		this->bucket_sprites();
+
+	//	the pre-render scanline never has any sprites
+	if (this->scanline < 0 || this->scanline >= (int16_t)VISIBLE_SCANLINES)
+		return;
+
+	//	crowded scanlines go through the full scan, which is where the overflow flag is worked out
+	if (this->spriteBucketCounts[this->scanline] >= 8) {
+
+		this->scan_sprites();
+		return;
+
+	}
+
+	for (uint8_t n = 0; n < this->spriteBucketCounts[this->scanline]; n++) {
+
+		uint8_t i = this->spriteBuckets[this->scanline][n];
+		this->secondaryOAM[n].id = i;
+		this->secondaryOAM[n].data.y = this->OAM[i * 4];
+		this->secondaryOAM[n].data.index = this->OAM[i * 4 + 1];
+		this->secondaryOAM[n].data.attributes = this->OAM[i * 4 + 2];
+		this->secondaryOAM[n].data.x = this->OAM[i * 4 + 3];
+
+	}
+
+}
+
+void PPUClass::scan_sprites() {
+
 	uint32_t n = 0;
 	for (uint8_t i = 0; i < 64; i++) {
 
@@ -457,8 +709,32 @@ void PPUClass::evaluate_sprites() {
 
 }
 
+void PPUClass::bucket_sprites() {
+
+	std::fill(std::begin(this->spriteBucketCounts), std::end(this->spriteBucketCounts), 0);
+	this->spriteBucketHeight = this->sprite_height();
+	this->spritesDirty = false;
+
+	//	going through OAM in order keeps every bucket in OAM order
+	for (uint8_t i = 0; i < 64; i++) {
+
+		uint32_t last = std::min((uint32_t)this->OAM[i * 4] + this->spriteBucketHeight, VISIBLE_SCANLINES);
+		for (uint32_t line = this->OAM[i * 4]; line < last; line++) {
+
+			if (this->spriteBucketCounts[line] < 8)
+				this->spriteBuckets[line][this->spriteBucketCounts[line]] = i;
+			this->spriteBucketCounts[line]++;
+
+		}
+
+	}
+
+}
+
 void PPUClass::load_sprites() {
 
+	std::fill(std::begin(this->spriteLine), std::end(this->spriteLine), 0x00);
+
 	uint16_t address = 0;
 	for (uint8_t i = 0; i < 8; i++) {
 
@@ -480,82 +756,76 @@ void PPUClass::load_sprites() {
 			spriteY ^= (this->sprite_height() - 1);
 		address += spriteY + (spriteY & 8);
 
-		this->primaryOAM[i].dataL = this->access(address);
-		this->primaryOAM[i].dataH = this->access(address + 8); // Add 8 because we're storing into the higher order byte
+		//	the tile cache already has the flipped version of the row
+		const TileRow& row = this->tiles->row(address, this->primaryOAM[i].data.attributes & 0x40);
+		std::copy(std::begin(row.pixels), std::end(row.pixels), std::begin(this->primaryOAM[i].pixels));
 
 	}
 
-}
-
-void PPUClass::pixelDraw() {
+	//	lower sprite slots have priority, so they are written last
+	for (int8_t i = 7; i >= 0; i--) {
 
-	uint8_t palette = 0, objPalette = 0;
-	bool objPriority = false;
-	int32_t x = this->scanlinePixel - 2;
+		if (this->primaryOAM[i].id == 0x40) continue;
 
-	if ((this->scanline < this->tvResolutionY[this->cartridge->getTV()]) && (x >= 0) && (x < 256)) {
+		uint8_t attributes = ((this->primaryOAM[i].data.attributes & 0x03) << 2) | (this->primaryOAM[i].data.attributes & SPRITE_PIXEL_BITMASKS::S_BEHIND);
+		if (this->primaryOAM[i].id == 0)
+			attributes |= SPRITE_PIXEL_BITMASKS::S_ZERO;
 
-		//	background
-		if (this->registers.MASK & MASK_BITMASKS::BG_ENABLE && !(!(this->registers.MASK & MASK_BITMASKS::BG_LEFT_COL) && (x < 8))) {
+		uint8_t* line = &this->spriteLine[this->primaryOAM[i].data.x];
+		for (uint32_t j = 0; j < 8; j++) {
 
-			palette = (((this->bgShiftH >> (15 - this->fineX)) & 1) << 1) | ((this->bgShiftL >> (15 - this->fineX)) & 1);
-			if (palette)
-				palette |= ((((this->atShiftH >> (7 - this->fineX)) & 1) << 1) | ((this->atShiftL >> (7 - this->fineX)) & 1)) << 2;
+			if (this->primaryOAM[i].pixels[j])
+				line[j] = this->primaryOAM[i].pixels[j] | attributes;
 
 		}
 
-		//	sprites
-		if (this->registers.MASK & MASK_BITMASKS::S_ENABLE && !(!(this->registers.MASK & MASK_BITMASKS::S_LEFT_COL) && (x < 8))) {
+	}
 
-			for (int8_t i = 7; i >= 0; i--) {
+}
 
-				if (this->primaryOAM[i].id == 0x40) continue;
+void PPUClass::composeGroup(int32_t x, uint32_t count) {
 
-				uint32_t spriteX = x - this->primaryOAM[i].data.x;
-				if (spriteX >= 8) continue;
-				if (this->primaryOAM[i].data.attributes & 0x40) spriteX ^= 7;
+	uint8_t colors[COMPOSE_GROUP_SIZE];
+	uint64_t bgMask = 0, spriteMask = 0, hitMask = ~0ULL;
 
-				uint8_t spritePalette = (((this->primaryOAM[i].dataH >> (7 - spriteX)) & 1) << 1) | ((this->primaryOAM[i].dataL >> (7 - spriteX)) & 1);
-				if (spritePalette == 0) continue;
+	//	the left column bits only hide the first 8 pixels, the group's pixels from 8 - x on are past them
+	uint64_t pastLeft = (x >= 8) ? ~0ULL : (x > 0) ? (~0ULL << ((8 - x) * 8)) : 0;
+	if (this->registers.MASK & MASK_BITMASKS::BG_ENABLE)
+		bgMask = (this->registers.MASK & MASK_BITMASKS::BG_LEFT_COL) ? ~0ULL : pastLeft;
+	if (this->registers.MASK & MASK_BITMASKS::S_ENABLE)
+		spriteMask = (this->registers.MASK & MASK_BITMASKS::S_LEFT_COL) ? ~0ULL : pastLeft;
 
-				if (this->primaryOAM[i].id == 0 && palette && x != 0xFF)
-					SetRegisterBits(this->registers.STAT, STAT_BITMASKS::S_0_HIT);
-					
-				spritePalette |= (this->primaryOAM[i].data.attributes & 0x03) << 2;
-				objPalette = spritePalette + 16;
-				objPriority = this->primaryOAM[i].data.attributes & 0x20;
+	//	sprite 0 hit is never detected at x == 255
+	if (x + COMPOSE_GROUP_SIZE > 255)
+		hitMask = (x < 255) ? (~0ULL >> ((COMPOSE_GROUP_SIZE - (255 - x)) * 8)) : 0;
 
-			}
-
-		}
+	//	the kernels always compose a whole group, anything past count is left for the next call, which composes it again with whatever MASK is by then
+	uint32_t hit = this->compose(&this->bgLine[x + this->fineX], &this->spriteLine[x], bgMask, spriteMask, hitMask, &this->palettes.at(0), this->greyMask, colors);
+	if (hit < count)
+		SetRegisterBits(this->registers.STAT, STAT_BITMASKS::S_0_HIT);
 
-		if (objPalette && ((palette == 0) || (objPriority == 0))) palette = objPalette;
+	//	emphasis is kept alongside the index, the frame sink decides what to do with it
+	uint16_t emphasis = this->emphasisBits[(this->registers.MASK & MASK_BITMASKS::COLOR_EMPH) >> 5];
+	uint16_t* output = this->frame.row(this->scanline) + x;
+	for (uint32_t j = 0; j < count; j++)
+		output[j] = (colors[j] & FRAME_PIXEL_BITMASKS::F_INDEX) | emphasis;
 
-		uint16_t address = 0x3F00 + (this->rendering() ? palette : 0);
-		uint8_t data = this->access(address);
-		this->pixels.setPixel(x, this->scanline, sf::Color(this->paletteColors[data]));
+}
 
-	}
+void PPUClass::composeUpTo(int32_t end) {
 
-	this->bgShiftL <<= 1;
-	this->bgShiftH <<= 1;
-	this->atShiftL = (this->atShiftL << 1) | this->ATLatchL;
-	this->atShiftH = (this->atShiftH << 1) | this->ATLatchH;
+	for (int32_t x = this->composed; x < end; x += COMPOSE_GROUP_SIZE)
+		this->composeGroup(x, (uint32_t)std::min<int32_t>(COMPOSE_GROUP_SIZE, end - x));
+	this->composed = std::max(this->composed, end);
 
 }
 
-uint16_t PPUClass::addressMirrorAdjust(uint16_t addr) {
-
-	switch (this->cartridge->getMirror()) {
+void PPUClass::composeDrawn() {
 
-	case mirrorEnum::HORIZONTAL: return ((addr / 2) & 0x0400) + (addr % 0x0400);
-	case mirrorEnum::VERTICAL: return addr % 0x0800;
-	case mirrorEnum::SINGLEA: return addr % 0x0400;
-	case mirrorEnum::SINGLEB: return (addr % 0x0400) + 0x0400;
-	case mirrorEnum::FOURSCREEN: return addr;
-	default: return addr - 0x2000;
-
-	}
+	//	the dot before scanlinePixel is the last one run, and pixel x is drawn on dot x + 2,
+	//	past the last pixel the line is already composed, and from dot 321 on composed counts for the next line
+	if (this->scanlineTypes[this->scanline + 1] == SCANLINE_TYPES::FRAME && this->scanlinePixel - 2 <= (int32_t)VISIBLE_WIDTH)
+		this->composeUpTo(this->scanlinePixel - 2);
 
 }
 
@@ -0,0 +1,363 @@
+#include <algorithm>
+#include <chrono>
+
+#include ".\include\PPUPipeline.h"
+#include ".\include\CPU.h"
+#include ".\include\Cartridge.h"
+
+//	how many times the PPU thread checks for more work before it starts sleeping, which it will do between frames
+const uint32_t PIPELINE_IDLE_SPINS = 2048;
+
+PPUPipelineClass::PPUPipelineClass(CPUClass* _CPU, PPUClass* _PPU) {
+
+	this->CPU = _CPU;
+	this->PPU = _PPU;
+	this->log.resize(PIPELINE_LOG_SIZE);
+
+	//	NMIs are raised by the CPU's side of the pipeline instead, and frames are handed over at the end of runFrame
+	this->savedCPU = this->PPU->CPU;
+	this->savedSink = this->PPU->sink;
+	this->PPU->CPU = nullptr;
+	this->PPU->sink = this;
+
+	this->thread = std::thread(&PPUPipelineClass::run, this);
+
+}
+
+PPUPipelineClass::~PPUPipelineClass() {
+
+	this->stopping.store(true, std::memory_order_release);
+	this->thread.join();
+
+	this->PPU->CPU = this->savedCPU;
+	this->PPU->sink = this->savedSink;
+
+}
+
+void PPUPipelineClass::begin(tvEnum tv) {
+
+	switch (tv) {
+
+	case tvEnum::PAL:
+		this->dot = &PPUClass::cycle<tvEnum::PAL>;
+		this->vblankScanline = RegionTiming<tvEnum::PAL>::VBLANK_SCANLINE;
+		this->lastScanline = RegionTiming<tvEnum::PAL>::LAST_SCANLINE;
+		break;
+	case tvEnum::DENDY:
+		this->dot = &PPUClass::cycle<tvEnum::DENDY>;
+		this->vblankScanline = RegionTiming<tvEnum::DENDY>::VBLANK_SCANLINE;
+		this->lastScanline = RegionTiming<tvEnum::DENDY>::LAST_SCANLINE;
+		break;
+	default:
+		this->dot = &PPUClass::cycle<tvEnum::NTSC>;
+		this->vblankScanline = RegionTiming<tvEnum::NTSC>::VBLANK_SCANLINE;
+		this->lastScanline = RegionTiming<tvEnum::NTSC>::LAST_SCANLINE;
+		break;
+
+	}
+
+	//	the PPU thread is idle, and the PPU may have been reset or given a new ROM since the last frame, so everything is worked out again from where it is now
+	int16_t scanline = this->PPU->scanline, pixel = this->PPU->scanlinePixel;
+	this->CTRL = this->PPU->registers.CTRL;
+	this->openBus = this->PPU->result;
+	this->vblankFlag = this->PPU->registers.STAT & STAT_BITMASKS::VBLANK;
+	this->lastVBlank = this->vblankEnds = this->now;
+	this->watchA12 = this->PPU->watchA12;
+	this->predictA12();
+
+	//	mappers counting A12 rises share their IRQ counter with the PPU thread, so their writes wait for it instead(see mapperWrite)
+	this->PPU->cartridge->deferPpuChanges(this->watchA12 ? nullptr : this);
+	this->publish();
+	this->status.store((this->now << 8) | (this->PPU->registers.STAT & (STAT_BITMASKS::S_0_HIT | STAT_BITMASKS::S_OVERFLOW)), std::memory_order_release);
+
+	//	vblank starts on dot 1, so once that has run the PPU sits on dot 2
+	if (scanline >= 0 && (scanline < this->vblankScanline || (scanline == this->vblankScanline && pixel < 2))) {
+
+		//	past the pre-render scanline, so the odd frame skipped dot is behind us and the time is exact
+		uint64_t at = this->now + ((uint64_t)(this->vblankScanline - scanline) * 341) + (2 - pixel);
+		this->vblankAt.store(at, std::memory_order_release);
+		this->nextVBlank = at;
+		return;
+
+	}
+
+	//	in vblank(which lasts until dot 1 of the pre-render scanline), sprite 0 hit and overflow are already final
+	if (scanline != -1 || pixel < 2) {
+
+		this->vblankEnds = this->now + ((scanline == -1) ? (2 - pixel) : (((uint64_t)(this->lastScanline - scanline) * 341) + (341 - pixel) + 2));
+		this->frameFlags.store(this->PPU->registers.STAT & (STAT_BITMASKS::S_0_HIT | STAT_BITMASKS::S_OVERFLOW), std::memory_order_relaxed);
+		this->flagsAt.store(this->now, std::memory_order_release);
+
+	}
+
+	//	the next vblank is published once the PPU reaches scanline 0, until then use the earliest it could be(the pre-render scanline can be a dot short)
+	uint64_t toScanline0 = (scanline == -1) ? (341 - pixel) : (((uint64_t)(this->lastScanline - scanline) * 341) + (341 - pixel) + 341);
+	this->vblankAt.store(this->now, std::memory_order_release);
+	this->nextVBlank = this->now + toScanline0 - 1 + ((uint64_t)this->vblankScanline * 341) + 2;
+
+}
+
+void PPUPipelineClass::finish() {
+
+	this->sync();
+	this->PPU->cartridge->deferPpuChanges(nullptr);
+
+	if (this->frameReady.load(std::memory_order_acquire)) {
+
+		this->frameReady.store(false, std::memory_order_relaxed);
+		if (this->savedSink != nullptr)
+			this->savedSink->submitFrame(this->frame);
+
+	}
+
+}
+
+uint8_t PPUPipelineClass::access(uint16_t address, uint8_t data, bool isWrite) {
+
+	if (isWrite) {
+
+		if ((address & 0x07) == 0x0000)
+			this->CTRL = data;
+		this->openBus = data;
+		this->push(address, data, false);
+
+		//	PPUSCROLL, OAMADDR and OAMDATA cannot change when A12 rises
+		if (this->watchA12 && (address & 0x07) != 0x0003 && (address & 0x07) != 0x0004 && (address & 0x07) != 0x0005)
+			this->syncA12();
+		return 0;
+
+	}
+
+	switch (address & 0x07) {
+
+	case 0x0002: // STATUS Register
+		return this->readStatus(address);
+
+	case 0x0004: // OAMDATA Register
+	case 0x0007: // PPUDATA Register
+		break;
+
+	default:
+		//	write only registers return whatever was last on the bus
+		return this->openBus;
+
+	}
+
+	this->sync();
+	uint8_t value = this->PPU->read(address);
+	this->openBus = value;
+	if (this->watchA12)
+		this->predictA12();
+	return value;
+
+}
+
+uint8_t PPUPipelineClass::readStatus(uint16_t address) {
+
+	const uint8_t spriteFlags = STAT_BITMASKS::S_0_HIT | STAT_BITMASKS::S_OVERFLOW;
+	uint8_t flags = 0;
+
+	if (this->now >= this->lastVBlank && this->now < this->vblankEnds) {
+
+		//	the PPU only has to have reached vblank, not the CPU
+		if (this->flagsAt.load(std::memory_order_acquire) < this->lastVBlank) {
+
+			this->publish();
+			while (this->flagsAt.load(std::memory_order_acquire) < this->lastVBlank)
+				std::this_thread::yield();
+
+		}
+		flags = this->frameFlags.load(std::memory_order_relaxed);
+
+	}
+	else {
+
+		//	while rendering, sprite 0 hit and overflow are only ever set until the pre-render scanline, which is past the next vblank,
+		//	so flags the PPU has reported set since the last one are still set, anything else needs the PPU to have reached the CPU(but not the rest of the log)
+		uint64_t reported = this->status.load(std::memory_order_acquire);
+		if ((reported >> 8) < this->vblankEnds || (reported & spriteFlags) != spriteFlags) {
+
+			this->publish();
+			while ((reported >> 8) < this->now) {
+
+				std::this_thread::yield();
+				reported = this->status.load(std::memory_order_acquire);
+
+			}
+
+		}
+		flags = (uint8_t)(reported & spriteFlags);
+
+	}
+
+	uint8_t value = (this->vblankFlag ? STAT_BITMASKS::VBLANK : 0) | flags | (this->openBus & STAT_BITMASKS::UNUSED);
+	this->vblankFlag = false;
+	this->openBus = value;
+
+	//	the read still clears the flag and the latch on the PPU's side
+	this->push(address, 0, true);
+	return value;
+
+}
+
+void PPUPipelineClass::sync() {
+
+	this->publish();
+	while (this->ran.load(std::memory_order_acquire) != this->now || this->consumed.load(std::memory_order_acquire) != this->head)
+		std::this_thread::yield();
+
+}
+
+void PPUPipelineClass::submitFrame(const FrameBuffer& frame) {
+
+	this->frame.width = frame.width;
+	this->frame.height = frame.height;
+	this->frame.pixels = frame.pixels;
+	this->frameReady.store(true, std::memory_order_release);
+
+}
+
+PipelineEntry& PPUPipelineClass::claim() {
+
+	//	the log is full, the PPU is a long way behind
+	if (this->head - this->consumed.load(std::memory_order_acquire) >= PIPELINE_LOG_SIZE) {
+
+		this->publish();
+		while (this->head - this->consumed.load(std::memory_order_acquire) >= PIPELINE_LOG_SIZE)
+			std::this_thread::yield();
+
+	}
+
+	PipelineEntry& entry = this->log[this->head % PIPELINE_LOG_SIZE];
+	entry.time = this->now;
+	return entry;
+
+}
+
+void PPUPipelineClass::push(uint16_t address, uint8_t data, bool isRead) {
+
+	PipelineEntry& entry = this->claim();
+	entry.address = address;
+	entry.data = data;
+	entry.isRead = isRead;
+	entry.isMapper = false;
+	this->published.store(++this->head, std::memory_order_release);
+
+}
+
+void PPUPipelineClass::deferPpuChange(const MapperPpuChange& change) {
+
+	PipelineEntry& entry = this->claim();
+	entry.isMapper = true;
+	entry.change = change;
+	this->published.store(++this->head, std::memory_order_release);
+
+}
+
+void PPUPipelineClass::checkVBlank() {
+
+	//	the PPU has not reached scanline 0 yet, it will have before the CPU could reach this vblank
+	uint64_t at = this->vblankAt.load(std::memory_order_acquire);
+	if (at <= this->lastVBlank)
+		this->publish();
+	while (at <= this->lastVBlank) {
+
+		std::this_thread::yield();
+		at = this->vblankAt.load(std::memory_order_acquire);
+
+	}
+
+	if (at > this->now) {
+
+		this->nextVBlank = at;
+		return;
+
+	}
+
+	//	the same as the PPU does when vblank starts, with CTRL as of the dot before
+	this->lastVBlank = at;
+	this->vblankEnds = at + ((uint64_t)(this->lastScanline + 1 - this->vblankScanline) * 341);
+	this->vblankFlag = true;
+	if (this->CTRL & CTRL_BITMASKS::NMI)
+		this->CPU->setNMI(true);
+
+	this->nextVBlank = at + ((uint64_t)(this->lastScanline + 2) * 341) - 1;
+
+}
+
+void PPUPipelineClass::predictA12() {
+
+	//	only called with the PPU caught up to the CPU
+	uint64_t dots = this->watchA12 ? this->PPU->dotsToA12Rise(this->lastScanline) : A12_NEVER;
+	this->nextA12 = (dots == A12_NEVER) ? A12_NEVER : this->now + dots;
+
+}
+
+void PPUPipelineClass::run() {
+
+	uint64_t ran = this->ran.load(std::memory_order_relaxed);
+	uint32_t consumed = this->consumed.load(std::memory_order_relaxed);
+	uint32_t idle = 0;
+
+	while (!this->stopping.load(std::memory_order_acquire)) {
+
+		//	apply everything the CPU did at this point in time
+		uint32_t published = this->published.load(std::memory_order_acquire);
+		while (consumed != published && this->log[consumed % PIPELINE_LOG_SIZE].time <= ran) {
+
+			PipelineEntry& entry = this->log[consumed % PIPELINE_LOG_SIZE];
+			if (entry.isMapper)
+				this->PPU->cartridge->applyPpuChange(entry.change);
+			else if (entry.isRead)
+				this->PPU->read(entry.address);
+			else {
+
+				uint8_t data = entry.data;
+				this->PPU->write(entry.address, data);
+
+			}
+			this->consumed.store(++consumed, std::memory_order_release);
+
+		}
+
+		//	anything stamped before the target was published before it, so it has to be looked at again after loading the target
+		uint64_t until = this->target.load(std::memory_order_acquire);
+		published = this->published.load(std::memory_order_acquire);
+		if (consumed != published)
+			until = std::min(until, this->log[consumed % PIPELINE_LOG_SIZE].time);
+
+		if (ran >= until) {
+
+			if (++idle < PIPELINE_IDLE_SPINS)
+				std::this_thread::yield();
+			else
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+			continue;
+
+		}
+		idle = 0;
+
+		while (ran < until) {
+
+			(this->PPU->*this->dot)();
+			ran++;
+
+			//	tell the CPU when the next vblank is as soon as it is certain, and what the sprite flags were once it starts
+			if (this->PPU->scanline == 0 && this->PPU->scanlinePixel == 0)
+				this->vblankAt.store(ran + ((uint64_t)this->vblankScanline * 341) + 2, std::memory_order_release);
+			else if (this->PPU->scanline == this->vblankScanline && this->PPU->scanlinePixel == 2) {
+
+				this->frameFlags.store(this->PPU->registers.STAT & (STAT_BITMASKS::S_0_HIT | STAT_BITMASKS::S_OVERFLOW), std::memory_order_relaxed);
+				this->flagsAt.store(ran, std::memory_order_release);
+
+			}
+
+		}
+		//	sprite 0 hit is only set once its group is composed, so the pixels drawn so far are composed before the flags are reported
+		this->PPU->composeDrawn();
+		this->status.store((ran << 8) | (this->PPU->registers.STAT & (STAT_BITMASKS::S_0_HIT | STAT_BITMASKS::S_OVERFLOW)), std::memory_order_release);
+		this->ran.store(ran, std::memory_order_release);
+
+	}
+
+}
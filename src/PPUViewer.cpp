@@ -0,0 +1,265 @@
+#include <tuple>
+#include <algorithm>
+
+#include ".\include\PPUViewer.h"
+#include ".\include\TileCache.h"
+
+#include ".\imgui.h"
+#include ".\imgui-SFML.h"
+
+void PPUViewerClass::update() {
+
+	if (this->PPU == nullptr || this->cartridge == nullptr || !this->cartridge->loaded())
+		return;
+
+	uint8_t chr = this->cartridge->takeChrDirty();
+	uint8_t written = this->PPU->takeDirty();
+
+	//	every view is colored from palette RAM
+	if (written & DIRTY_BITMASKS::D_PALETTE) {
+
+		this->invalidate();
+		return;
+
+	}
+
+	this->patternPending |= chr;
+
+	//	a changed tile could be anywhere in the nametables, so any change to the background's pattern table redraws all of them
+	uint8_t backgroundBanks = (this->PPU->getCTRL() & CTRL_BITMASKS::BACKGROUND) ? 0xF0 : 0x0F;
+	if (chr & backgroundBanks)
+		this->nametablePending = DIRTY_BITMASKS::D_NAMETABLE;
+	else
+		this->nametablePending |= (written & DIRTY_BITMASKS::D_NAMETABLE);
+
+	if (chr || (written & DIRTY_BITMASKS::D_OAM))
+		this->spritesPending = true;
+
+}
+
+void PPUViewerClass::invalidate() {
+
+	this->patternPending = 0xFF;
+	this->nametablePending = DIRTY_BITMASKS::D_NAMETABLE;
+	this->spritesPending = true;
+
+}
+
+void PPUViewerClass::drawPatternTables(bool* open) {
+
+	ImGui::Begin("Pattern Tables", open);
+
+	if (ImGui::SliderInt("Palette", &this->patternPalette, 0, 7))
+		this->patternPending = 0xFF;
+
+	if (this->patternPixels.empty()) {
+
+		this->patternPixels.assign(128 * 256, 0);
+		this->patternTexture.create(128, 256);
+		this->patternPending = 0xFF;
+
+	}
+
+	if (this->patternPending && this->cartridge->loaded()) {
+
+		this->loadColors();
+
+		for (uint16_t bank = 0; bank < 8; bank++) {
+
+			if (!(this->patternPending & (1 << bank)))
+				continue;
+
+			//	64 tiles per 1KB, laid out 16 to a row
+			for (uint16_t i = 0; i < 64; i++) {
+
+				uint16_t tile = (bank * 64) + i;
+				uint32_t x = (tile & 0x0F) * 8, y = (tile >> 4) * 8;
+				this->drawTile(tile * 16, 0, (uint8_t)this->patternPalette, this->colors[0], &this->patternPixels[(y * 128) + x], 128);
+
+			}
+
+			this->patternTexture.update((uint8_t*)&this->patternPixels[(size_t)bank * 32 * 128], 128, 32, 0, bank * 32);
+
+		}
+
+		this->patternPending = 0;
+
+	}
+
+	ImGui::Image(this->patternTexture, sf::Vector2f(256, 512));
+	ImGui::End();
+
+}
+
+void PPUViewerClass::drawNametables(bool* open) {
+
+	ImGui::Begin("Nametables", open);
+	ImGui::Checkbox("Show Scroll", &this->showScroll);
+
+	if (this->nametablePixels.empty()) {
+
+		this->nametablePixels.assign(4 * 256 * 240, 0);
+		this->nametableTexture.create(512, 480);
+		this->nametablePending = DIRTY_BITMASKS::D_NAMETABLE;
+
+	}
+
+	//	switching the background's pattern table or the mirroring changes what is shown without anything being written
+	uint8_t patterns = (this->PPU->getCTRL() & CTRL_BITMASKS::BACKGROUND) ? 1 : 0;
+	if (patterns != this->nametablePatterns) {
+
+		this->nametablePatterns = patterns;
+		this->nametablePending = DIRTY_BITMASKS::D_NAMETABLE;
+
+	}
+	for (uint8_t i = 0; i < 4; i++) {
+
+		const uint8_t* slot = this->PPU->getNametableSlot(i);
+		if (slot != this->nametableSlots[i]) {
+
+			this->nametableSlots[i] = slot;
+			this->nametablePending |= 1 << i;
+
+		}
+
+	}
+
+	if (this->nametablePending && this->cartridge->loaded()) {
+
+		this->loadColors();
+
+		for (uint8_t i = 0; i < 4; i++) {
+
+			const uint8_t* slot = this->nametableSlots[i];
+			if (!(this->nametablePending & (1 << i)) || slot == nullptr)
+				continue;
+
+			uint32_t* pixels = &this->nametablePixels[(size_t)i * 256 * 240];
+			for (uint32_t y = 0; y < 30; y++) {
+
+				for (uint32_t x = 0; x < 32; x++) {
+
+					//	each attribute byte covers 4x4 tiles, 2 bits per 2x2 of them: https://wiki.nesdev.com/w/index.php/PPU_attribute_tables
+					uint8_t attribute = slot[0x03C0 + ((y / 4) * 8) + (x / 4)];
+					uint8_t palette = (attribute >> (((y & 0x02) << 1) | (x & 0x02))) & 0x03;
+					this->drawTile((patterns * 0x1000) + (slot[(y * 32) + x] * 16), 0, palette, this->colors[0], &pixels[(y * 8 * 256) + (x * 8)], 256);
+
+				}
+
+			}
+
+			this->nametableTexture.update((uint8_t*)pixels, 256, 240, (i & 0x01) * 256, (i >> 1) * 240);
+
+		}
+
+		this->nametablePending = 0;
+
+	}
+
+	ImVec2 origin = ImGui::GetCursorScreenPos();
+	ImGui::Image(this->nametableTexture, sf::Vector2f(512, 480));
+
+	if (this->showScroll) {
+
+		//	the screen wraps around the nametables, so it can be split into as many as 4 pieces
+		uint32_t scrollX, scrollY;
+		std::tie(scrollX, scrollY) = this->PPU->getScroll();
+
+		ImDrawList* drawList = ImGui::GetWindowDrawList();
+		drawList->PushClipRect(origin, ImVec2(origin.x + 512, origin.y + 480), true);
+		for (int32_t wrapX = 0; wrapX <= 512; wrapX += 512) {
+
+			for (int32_t wrapY = 0; wrapY <= 480; wrapY += 480) {
+
+				float left = origin.x + (float)scrollX - wrapX, top = origin.y + (float)scrollY - wrapY;
+				drawList->AddRect(ImVec2(left, top), ImVec2(left + 256, top + 240), IM_COL32(255, 0, 0, 255));
+
+			}
+
+		}
+		drawList->PopClipRect();
+
+	}
+
+	ImGui::End();
+
+}
+
+void PPUViewerClass::drawSprites(bool* open) {
+
+	ImGui::Begin("Sprites", open);
+
+	if (this->spritePixels.empty()) {
+
+		this->spritePixels.assign(64 * 128, 0);
+		this->spriteTexture.create(64, 128);
+		this->spritesPending = true;
+
+	}
+
+	uint8_t ctrl = this->PPU->getCTRL() & (CTRL_BITMASKS::SPRITE | CTRL_BITMASKS::S_HEIGHT);
+	if (ctrl != this->spriteCTRL) {
+
+		this->spriteCTRL = ctrl;
+		this->spritesPending = true;
+
+	}
+
+	if (this->spritesPending && this->cartridge->loaded()) {
+
+		this->loadColors();
+
+		//	pixel 0 is left transparent, so the sprites show up on the window background
+		std::fill(this->spritePixels.begin(), this->spritePixels.end(), 0);
+
+		for (uint16_t i = 0; i < 64; i++) {
+
+			uint8_t index = this->PPU->getOAM((i * 4) + 1);
+			uint8_t attributes = this->PPU->getOAM((i * 4) + 2);
+			uint32_t* cell = &this->spritePixels[((i / 8) * 16 * 64) + ((i % 8) * 8)];
+
+			//	see: https://wiki.nesdev.com/w/index.php/PPU_OAM#Byte_1
+			if (ctrl & CTRL_BITMASKS::S_HEIGHT) {
+
+				//	8x16 sprites pick their own pattern table, and flipping vertically also swaps the 2 tiles
+				uint16_t address = ((index & 0x01) * 0x1000) + ((index & 0xFE) * 16);
+				bool flipY = attributes & 0x80;
+				this->drawTile(address + (flipY ? 16 : 0), attributes, 4 + (attributes & 0x03), 0, cell, 64);
+				this->drawTile(address + (flipY ? 0 : 16), attributes, 4 + (attributes & 0x03), 0, cell + (8 * 64), 64);
+
+			}
+			else
+				this->drawTile((((ctrl & CTRL_BITMASKS::SPRITE) >> 3) * 0x1000) + (index * 16), attributes, 4 + (attributes & 0x03), 0, cell, 64);
+
+		}
+
+		this->spriteTexture.update((uint8_t*)&this->spritePixels.at(0), 64, 128, 0, 0);
+		this->spritesPending = false;
+
+	}
+
+	ImGui::Image(this->spriteTexture, sf::Vector2f(256, 512));
+	ImGui::End();
+
+}
+
+void PPUViewerClass::loadColors() {
+
+	//	the first color of every palette is the backdrop: https://wiki.nesdev.com/w/index.php/PPU_palettes#Memory_Map
+	const uint32_t* table = this->palette->getTable();
+	for (uint8_t i = 0; i < 32; i++)
+		this->colors[i] = table[this->PPU->getPalette((i & 0x03) ? i : 0) & 0x3F];
+
+}
+
+void PPUViewerClass::drawTile(uint16_t address, uint8_t attributes, uint8_t palette, uint32_t backdrop, uint32_t* pixels, uint32_t stride) {
+
+	for (uint16_t y = 0; y < 8; y++) {
+
+		const TileRow& row = this->cartridge->chr_tile_row(address + ((attributes & 0x80) ? 7 - y : y), attributes & 0x40);
+		for (uint16_t x = 0; x < 8; x++)
+			pixels[(y * stride) + x] = row.pixels[x] ? this->colors[(palette * 4) + row.pixels[x]] : backdrop;
+
+	}
+
+}
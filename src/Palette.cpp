@@ -0,0 +1,162 @@
+#include <fstream>
+
+#include ".\include\Palette.h"
+#include ".\include\ErrorLog.h"
+#include ".\include\simd_util.h"
+
+//	this follows directly with RGBA32(NOT ARGB32), only the RGB part is used to build the table
+static const uint32_t defaultColors[64] = { 0x666666FF, 0x002A88FF, 0x1412A7FF, 0x3B00A4FF, 0x5C007EFF, 0x6E0040FF, 0x6C0600FF, 0x561D00FF,
+											0x333500FF, 0x0B4800FF, 0x005200FF, 0x004F08FF, 0x00404DFF, 0x000000FF, 0x000000FF, 0x000000FF,
+											0xADADADFF, 0x155FD9FF, 0x4240FFFF, 0x7527FEFF, 0xA01ACCFF, 0xB71E7BFF, 0xB53120FF, 0x994E00FF,
+											0x6b6d00FF, 0x388700FF, 0x0c9300FF, 0x008F32FF, 0x007C8DFF, 0x000000FF, 0x000000FF, 0x000000FF,
+											0xFFFEFFFF, 0x64B0FFFF, 0x9290FFFF, 0xC676FFFF, 0xF36AFFFF, 0xFE6ECCFF, 0xFE8170FF, 0xEA9E22FF,
+											0xBCBE00FF, 0x88D800FF, 0x5CE430FF, 0x45E082FF, 0x48CDDEFF, 0x4F4F4FFF, 0x000000FF, 0x000000FF,
+											0xFFFEFFFF, 0xC0DFFFFF, 0xd3D2FFFF, 0xE8C8FFFF, 0xFBC2FFFF, 0xFEC4EAFF, 0xFECCC5FF, 0xF7D8A5FF,
+											0xE4E594FF, 0xCFEF96FF, 0xBDf4ABFF, 0xB3F3CCFF, 0xB5EBF2FF, 0xB8B8B8FF, 0x000000FF, 0x000000FF };
+
+#ifdef SIMD_X86
+//	looks up 8 pixels per gather, returns how many pixels were converted so the rest can be finished scalar
+TARGET_AVX2 static size_t convertAVX2(const uint32_t* table, const uint16_t* input, uint32_t* output, size_t count) {
+
+	const __m256i indexMask = _mm256_set1_epi32(FRAME_PIXEL_BITMASKS::F_INDEX | FRAME_PIXEL_BITMASKS::F_EMPHASIS);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+
+		__m256i indexes = _mm256_and_si256(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(input + i))), indexMask);
+		_mm256_storeu_si256((__m256i*)(output + i), _mm256_i32gather_epi32((const int*)table, indexes, 4));
+
+	}
+
+	return i;
+
+}
+#endif
+
+PaletteClass::PaletteClass() {
+
+	this->loadDefault();
+
+#ifdef SIMD_X86
+	this->useAVX2 = cpuHasAVX2();
+#endif
+
+}
+
+bool PaletteClass::load(std::string fileName) {
+
+	ErrorLogClass log = ErrorLogClass();
+
+	std::ifstream file(fileName, std::ios::in | std::ios::binary);
+	if (!file.is_open()) {
+
+		log.Write("Cannot open palette file: " + fileName);
+		return false;
+
+	}
+
+	file.seekg(0, std::ios::end);
+	size_t size = (size_t)file.tellg();
+	file.seekg(0, std::ios::beg);
+
+	//	64 colors without emphasis, or all 8 emphasis combinations one after the other
+	if (size != 64 * 3 && size != PALETTE_LUT_SIZE * 3) {
+
+		log.Write("Palette file must be 192 or 1536 bytes: " + fileName);
+		return false;
+
+	}
+
+	std::vector<uint8_t> colors(size);
+	file.read((char*)&colors.at(0), size);
+	if (file.fail()) {
+
+		log.Write("Cannot read palette file: " + fileName);
+		return false;
+
+	}
+
+	if (size == 64 * 3)
+		this->generate(&colors.at(0));
+	else
+		this->fill(&colors.at(0));
+
+	return true;
+
+}
+
+void PaletteClass::loadDefault() {
+
+	uint8_t colors[64 * 3];
+	for (uint32_t i = 0; i < 64; i++) {
+
+		colors[i * 3 + 0] = (uint8_t)(defaultColors[i] >> 24);
+		colors[i * 3 + 1] = (uint8_t)(defaultColors[i] >> 16);
+		colors[i * 3 + 2] = (uint8_t)(defaultColors[i] >> 8);
+
+	}
+
+	this->generate(colors);
+
+}
+
+void PaletteClass::convert(const FrameBuffer& frame, AlignedVector<uint32_t>& output) {
+
+	output.resize(frame.pixels.size());
+
+	const uint16_t* input = frame.pixels.data();
+	uint32_t* colors = output.data();
+	size_t count = frame.pixels.size();
+	size_t i = 0;
+
+#ifdef SIMD_X86
+	if (this->useAVX2)
+		i = convertAVX2(this->table, input, colors, count);
+#endif
+
+	for (; i < count; i++)
+		colors[i] = this->table[input[i] & (FRAME_PIXEL_BITMASKS::F_INDEX | FRAME_PIXEL_BITMASKS::F_EMPHASIS)];
+
+}
+
+void PaletteClass::generate(const uint8_t* colors) {
+
+	uint8_t expanded[PALETTE_LUT_SIZE * 3];
+
+	//	emphasis bit 0 is red, 1 is green, 2 is blue(MASK bits 5 to 7), every channel not emphasized is darkened to about 81.6%
+	for (uint32_t emphasis = 0; emphasis < 8; emphasis++) {
+
+		for (uint32_t i = 0; i < 64; i++) {
+
+			for (uint32_t channel = 0; channel < 3; channel++) {
+
+				uint32_t value = colors[i * 3 + channel];
+				if (emphasis && !(emphasis & (1 << channel)))
+					value = (value * 816) / 1000;
+
+				expanded[(emphasis * 64 + i) * 3 + channel] = (uint8_t)value;
+
+			}
+
+		}
+
+	}
+
+	this->fill(expanded);
+
+}
+
+void PaletteClass::fill(const uint8_t* colors) {
+
+	for (uint32_t i = 0; i < PALETTE_LUT_SIZE; i++) {
+
+		//	written a byte at a time so the table is in R, G, B, A order no matter the endianness
+		uint8_t* entry = (uint8_t*)&this->table[i];
+		entry[0] = colors[i * 3 + 0];
+		entry[1] = colors[i * 3 + 1];
+		entry[2] = colors[i * 3 + 2];
+		entry[3] = 0xFF;
+
+	}
+
+}
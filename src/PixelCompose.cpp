@@ -0,0 +1,123 @@
+#include ".\include\PixelCompose.h"
+
+#include ".\include\simd_util.h"
+
+//	for how the PPU decides which pixel wins, see: https://wiki.nesdev.com/w/index.php/PPU_sprite_priority
+uint32_t composeScalar(const uint8_t* background, const uint8_t* sprites, uint64_t bgMask, uint64_t spriteMask, uint64_t hitMask,
+	const uint8_t* palettes, uint8_t greyMask, uint8_t* output) {
+
+	uint32_t hit = COMPOSE_GROUP_SIZE;
+
+	for (uint32_t i = 0; i < COMPOSE_GROUP_SIZE; i++) {
+
+		uint8_t bg = background[i] & (uint8_t)(bgMask >> (i * 8));
+		uint8_t sprite = sprites[i] & (uint8_t)(spriteMask >> (i * 8));
+		uint8_t palette = bg;
+
+		if (sprite & SPRITE_PIXEL_BITMASKS::S_PIXEL) {
+
+			if ((sprite & SPRITE_PIXEL_BITMASKS::S_ZERO) && bg && (uint8_t)(hitMask >> (i * 8)) && hit == COMPOSE_GROUP_SIZE)
+				hit = i;
+
+			if (!bg || !(sprite & SPRITE_PIXEL_BITMASKS::S_BEHIND))
+				palette = 0x10 | (sprite & (SPRITE_PIXEL_BITMASKS::S_PALETTE | SPRITE_PIXEL_BITMASKS::S_PIXEL));
+
+		}
+
+		output[i] = palettes[palette] & greyMask;
+
+	}
+
+	return hit;
+
+}
+
+#ifdef SIMD_X86
+
+//	index of the lowest set bit of a non zero mask
+static inline uint32_t lowestBit(uint32_t mask) {
+
+#ifdef _MSC_VER
+	unsigned long index = 0;
+	_BitScanForward(&index, mask);
+	return (uint32_t)index;
+#else
+	return (uint32_t)__builtin_ctz(mask);
+#endif
+
+}
+
+//	priority and sprite 0 hit for all 8 pixels at once, returns the palette RAM indexes in the low 8 bytes
+static inline __m128i composeIndexesSSE2(const uint8_t* background, const uint8_t* sprites, uint64_t bgMask, uint64_t spriteMask, uint64_t hitMask, uint32_t& hit) {
+
+	const __m128i zero = _mm_setzero_si128();
+
+	__m128i bg = _mm_and_si128(_mm_loadl_epi64((const __m128i*)background), _mm_loadl_epi64((const __m128i*)&bgMask));
+	__m128i sprite = _mm_and_si128(_mm_loadl_epi64((const __m128i*)sprites), _mm_loadl_epi64((const __m128i*)&spriteMask));
+
+	//	0xFF where the pixel is transparent
+	__m128i bgClear = _mm_cmpeq_epi8(bg, zero);
+	__m128i spriteClear = _mm_cmpeq_epi8(_mm_and_si128(sprite, _mm_set1_epi8(SPRITE_PIXEL_BITMASKS::S_PIXEL)), zero);
+
+	//	sprite 0 hit needs an opaque sprite 0 pixel over an opaque background pixel
+	__m128i zeroSprite = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_and_si128(sprite, _mm_set1_epi8(SPRITE_PIXEL_BITMASKS::S_ZERO)), zero), _mm_loadl_epi64((const __m128i*)&hitMask));
+	//	one bit per pixel, the lowest one set is the first pixel it happens on
+	uint32_t hits = (uint32_t)_mm_movemask_epi8(_mm_andnot_si128(_mm_or_si128(bgClear, spriteClear), zeroSprite)) & 0xFF;
+	hit = hits ? lowestBit(hits) : COMPOSE_GROUP_SIZE;
+
+	//	the sprite wins if it is opaque, and either the background is transparent or the sprite is in front
+	__m128i front = _mm_cmpeq_epi8(_mm_and_si128(sprite, _mm_set1_epi8(SPRITE_PIXEL_BITMASKS::S_BEHIND)), zero);
+	__m128i useSprite = _mm_andnot_si128(spriteClear, _mm_or_si128(bgClear, front));
+
+	__m128i spriteIndex = _mm_or_si128(_mm_and_si128(sprite, _mm_set1_epi8(SPRITE_PIXEL_BITMASKS::S_PALETTE | SPRITE_PIXEL_BITMASKS::S_PIXEL)), _mm_set1_epi8(0x10));
+	return _mm_or_si128(_mm_and_si128(useSprite, spriteIndex), _mm_andnot_si128(useSprite, bg));
+
+}
+
+static uint32_t composeSSE2(const uint8_t* background, const uint8_t* sprites, uint64_t bgMask, uint64_t spriteMask, uint64_t hitMask,
+	const uint8_t* palettes, uint8_t greyMask, uint8_t* output) {
+
+	uint32_t hit = COMPOSE_GROUP_SIZE;
+	uint8_t indexes[16];
+	_mm_storeu_si128((__m128i*)indexes, composeIndexesSSE2(background, sprites, bgMask, spriteMask, hitMask, hit));
+
+	//	SSE2 has no byte shuffle, so the palette RAM lookup stays scalar
+	for (uint32_t i = 0; i < COMPOSE_GROUP_SIZE; i++)
+		output[i] = palettes[indexes[i]] & greyMask;
+
+	return hit;
+
+}
+
+TARGET_SSSE3 static uint32_t composeSSSE3(const uint8_t* background, const uint8_t* sprites, uint64_t bgMask, uint64_t spriteMask, uint64_t hitMask,
+	const uint8_t* palettes, uint8_t greyMask, uint8_t* output) {
+
+	uint32_t hit = COMPOSE_GROUP_SIZE;
+	__m128i indexes = composeIndexesSSE2(background, sprites, bgMask, spriteMask, hitMask, hit);
+
+	//	palette RAM is only 32 bytes, so it fits in 2 registers and can be looked up with a shuffle each
+	__m128i low = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)palettes), indexes);
+	__m128i high = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(palettes + 16)), indexes);
+	__m128i useHigh = _mm_cmpeq_epi8(_mm_and_si128(indexes, _mm_set1_epi8(0x10)), _mm_set1_epi8(0x10));
+	__m128i colors = _mm_or_si128(_mm_and_si128(useHigh, high), _mm_andnot_si128(useHigh, low));
+
+	_mm_storel_epi64((__m128i*)output, _mm_and_si128(colors, _mm_set1_epi8((char)greyMask)));
+
+	return hit;
+
+}
+
+#endif
+
+composeKernel selectComposeKernel() {
+
+#ifdef SIMD_X86
+	if (cpuHasSSSE3())
+		return composeSSSE3;
+	if (cpuHasSSE2())
+		return composeSSE2;
+#endif
+
+	return composeScalar;
+
+}
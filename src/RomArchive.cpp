@@ -0,0 +1,149 @@
+#include <algorithm>	//	std::transform
+#include <cctype>		//	std::tolower
+
+#include ".\include\RomArchive.h"
+#include ".\include\custom_exceptions.h"
+
+//	both formats are little endian throughout
+static uint16_t read16(const uint8_t* data) { return (uint16_t)(data[0] | (data[1] << 8)); }
+static uint32_t read32(const uint8_t* data) { return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24); }
+
+static std::string lowercase(std::string text) {
+
+	std::transform(text.begin(), text.end(), text.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+	return text;
+
+}
+
+static bool endsWith(const std::string& text, const std::string& ending) {
+
+	return text.size() >= ending.size() && text.compare(text.size() - ending.size(), ending.size(), ending) == 0;
+
+}
+
+//	see: https://www.rfc-editor.org/rfc/rfc1952#section-2.3
+static void findGzipRom(const uint8_t* data, size_t size, RomArchiveEntry& entry) {
+
+	//	the header is at least 10 bytes, and the CRC32 and size of what is in it are the last 8
+	if (size < 18 || data[2] != 8)
+		throw CartridgeException("Compressed ROM is not deflated");
+
+	uint8_t flags = data[3];
+	size_t offset = 10;
+
+	//	extra field, file name, comment, then a CRC16 of the header, each only if its flag is set
+	if (flags & 0x04)
+		offset += (offset + 2 <= size) ? 2 + (size_t)read16(data + offset) : size;
+	for (uint32_t flag : { 0x08u, 0x10u }) {
+
+		if (!(flags & flag))
+			continue;
+		while (offset < size && data[offset] != 0)
+			offset++;
+		offset++;
+
+	}
+	if (flags & 0x02)
+		offset += 2;
+
+	if (offset + 8 > size)
+		throw CartridgeException("Compressed ROM is truncated");
+
+	entry.offset = offset;
+	entry.packedSize = size - 8 - offset;
+	entry.crc32 = read32(data + size - 8);
+	entry.size = read32(data + size - 4);
+	entry.deflated = true;
+
+}
+
+//	see: https://pkware.cachefly.net/webdocs/casestudies/APPNOTE.TXT, the central directory at the end is what is trusted, since local headers may leave sizes out
+static void findZipRom(const uint8_t* data, size_t size, RomArchiveEntry& entry) {
+
+	//	the end of central directory record is 22 bytes, plus up to 64KB of comment
+	size_t end = size;
+	if (size >= 22) {
+
+		size_t stop = (size - 22 > 0xFFFF) ? size - 22 - 0xFFFF : 0;
+		for (size_t i = size - 22; ; i--) {
+
+			if (read32(data + i) == 0x06054B50) {
+
+				end = i;
+				break;
+
+			}
+			if (i == stop)
+				break;
+
+		}
+
+	}
+	if (end == size)
+		throw CartridgeException("Compressed ROM has no directory");
+
+	uint16_t count = read16(data + end + 10);
+	size_t offset = read32(data + end + 16);
+
+	for (uint16_t i = 0; i < count; i++) {
+
+		if (offset + 46 > size || read32(data + offset) != 0x02014B50)
+			throw CartridgeException("Compressed ROM has a bad directory");
+
+		uint16_t method = read16(data + offset + 10);
+		uint16_t nameLength = read16(data + offset + 28);
+		size_t next = offset + 46 + nameLength + read16(data + offset + 30) + read16(data + offset + 32);
+		if (offset + 46 + nameLength > size)
+			throw CartridgeException("Compressed ROM has a bad directory");
+
+		std::string name = lowercase(std::string((const char*)data + offset + 46, nameLength));
+		if (!endsWith(name, ".nes")) {
+
+			offset = next;
+			continue;
+
+		}
+
+		if (method != 0 && method != 8)
+			throw CartridgeException("Compressed ROM " + name + " uses an unsupported compression method");
+
+		entry.crc32 = read32(data + offset + 16);
+		entry.packedSize = read32(data + offset + 20);
+		entry.size = read32(data + offset + 24);
+		entry.deflated = (method == 8);
+
+		//	the local header's name and extra field can differ in length from the central directory's
+		size_t local = read32(data + offset + 42);
+		if (local + 30 > size || read32(data + local) != 0x04034B50)
+			throw CartridgeException("Compressed ROM has a bad directory");
+		entry.offset = local + 30 + read16(data + local + 26) + read16(data + local + 28);
+
+		if (entry.offset + entry.packedSize > size)
+			throw CartridgeException("Compressed ROM is truncated");
+		return;
+
+	}
+
+	throw CartridgeException("Compressed ROM has no .nes file in it");
+
+}
+
+bool findArchivedRom(const uint8_t* data, size_t size, RomArchiveEntry& entry) {
+
+	if (size >= 4 && data[0] == 0x1F && data[1] == 0x8B)
+		findGzipRom(data, size, entry);
+	else if (size >= 4 && read32(data) == 0x04034B50)
+		findZipRom(data, size, entry);
+	else
+		return false;
+
+	return true;
+
+}
+
+bool isRomArchiveName(const std::string& filename) {
+
+	std::string name = lowercase(filename);
+	return endsWith(name, ".gz") || endsWith(name, ".zip");
+
+}
@@ -0,0 +1,56 @@
+#include ".\include\RomArena.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>	//	mmap, munmap
+#endif
+
+size_t RomArenaClass::reserve(size_t size) {
+
+	size_t offset = (this->length + REGION_ALIGNMENT - 1) & ~(REGION_ALIGNMENT - 1);
+	this->length = offset + size;
+	return offset;
+
+}
+
+bool RomArenaClass::allocate() {
+
+	if (this->length == 0)
+		return true;
+
+#ifdef _WIN32
+	//	VirtualAlloc hands back zeroed memory
+	void* memory = VirtualAlloc(nullptr, this->length, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	if (memory == nullptr)
+		return false;
+#else
+	//	anonymous mappings are zeroed, and only take up memory once they are touched
+	void* memory = mmap(nullptr, this->length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED)
+		return false;
+#endif
+
+	this->memory = (uint8_t*)memory;
+	return true;
+
+}
+
+void RomArenaClass::release() {
+
+	if (this->memory != nullptr) {
+
+#ifdef _WIN32
+		VirtualFree(this->memory, 0, MEM_RELEASE);
+#else
+		munmap(this->memory, this->length);
+#endif
+
+	}
+
+	this->memory = nullptr;
+	this->length = 0;
+
+}
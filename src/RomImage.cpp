@@ -0,0 +1,173 @@
+#include <mutex>			//	std::mutex, std::lock_guard
+#include <unordered_map>	//	std::unordered_map
+#include <algorithm>		//	std::min
+#include <cstring>			//	std::memcpy
+#include <fstream>			//	std::ifstream
+#include <vector>			//	std::vector
+
+#include ".\include\RomImage.h"
+#include ".\include\RomStruct.h"
+#include ".\include\RomArchive.h"
+#include ".\include\Inflate.h"
+#include ".\include\Checksum.h"
+
+#include ".\include\custom_exceptions.h"
+
+//	nothing that big is a ROM, this keeps a bad archive from asking for gigabytes
+static const size_t MAX_INFLATED_ROM_SIZE = 0x8000000;
+
+//	every image still in use, by the canonical path of its file, see RomImageClass::open
+static std::mutex imagesLock;
+static std::unordered_map<std::string, std::weak_ptr<RomImageClass>> images;
+
+//	ensure the file read is an NES rom by checking the ID
+static void checkMagic(const uint8_t* header, size_t size) {
+
+	if (size < sizeof(romHeaderStruct) || nesMagic.compare(0, 4, (const char*)header, 4) != 0)
+		throw CartridgeException("Cartridge not NES format. HeaderID: " + std::string((const char*)header, std::min<size_t>(4, size)));
+
+}
+
+std::shared_ptr<RomImageClass> RomImageClass::open(const std::string& filename, bool copy) {
+
+	//	a copy is never shared, whoever asks for one wants an image that does not hold on to the file, which a shared one might
+	if (copy) {
+
+		std::shared_ptr<RomImageClass> image = std::make_shared<RomImageClass>();
+		image->load(filename, true);
+		return image;
+
+	}
+
+	//	the same file reached through a different path is still the same image
+	//	a file that cannot be looked at is still loaded, but not shared
+	std::error_code error;
+	std::filesystem::path path = std::filesystem::weakly_canonical(std::filesystem::u8path(filename), error);
+	std::string key = path.u8string();
+	bool shareable = !error;
+	uintmax_t fileSize = std::filesystem::file_size(path, error);
+	shareable = shareable && !error;
+	std::filesystem::file_time_type modified = std::filesystem::last_write_time(path, error);
+	shareable = shareable && !error;
+
+	if (shareable) {
+
+		std::lock_guard<std::mutex> lock(imagesLock);
+		auto found = images.find(key);
+		if (found != images.end()) {
+
+			std::shared_ptr<RomImageClass> image = found->second.lock();
+			if (image && image->fileSize == fileSize && image->modified == modified)
+				return image;
+
+		}
+
+	}
+
+	//	loaded without holding the lock, so different ROMs(see RomIndexClass::scan) load in parallel
+	std::shared_ptr<RomImageClass> image = std::make_shared<RomImageClass>();
+	image->fileSize = fileSize;
+	image->modified = modified;
+	image->load(filename, false);
+
+	//	a file that changed while it was read is not shared either, the next load reads it again
+	if (!shareable)
+		return image;
+	uintmax_t sizeAfter = std::filesystem::file_size(path, error);
+	std::filesystem::file_time_type modifiedAfter = std::filesystem::last_write_time(path, error);
+	if (error || sizeAfter != fileSize || modifiedAfter != modified)
+		return image;
+
+	std::lock_guard<std::mutex> lock(imagesLock);
+
+	//	whoever loaded the same file first while we were at it wins, so there is only ever one copy
+	std::weak_ptr<RomImageClass>& entry = images[key];
+	std::shared_ptr<RomImageClass> other = entry.lock();
+	if (other && other->fileSize == fileSize && other->modified == modified)
+		return other;
+	entry = image;
+
+	//	images nobody uses any more are forgotten along the way, so indexing a whole library does not leave one behind for every ROM
+	for (auto it = images.begin(); it != images.end();)
+		it = it->second.expired() ? images.erase(it) : std::next(it);
+
+	return image;
+
+}
+
+void RomImageClass::load(const std::string& filename, bool copy) {
+
+	//	a copy reads the file with plain reads, so it is never mapped, not even while it is read, and nothing keeps it from being rebuilt(see GUIClass::watchRom)
+	std::vector<uint8_t> contents;
+	if (copy) {
+
+		std::ifstream input(std::filesystem::u8path(filename), std::ios::in | std::ios::binary | std::ios::ate);
+		if (!input)
+			throw CartridgeException("Cartridge file: " + filename + " not found");
+		contents.resize((size_t)input.tellg());
+		input.seekg(0);
+		if (!input.read((char*)contents.data(), contents.size()))
+			throw CartridgeException("Cartridge file: " + filename + " could not be read");
+
+	}
+	else if (!this->file.open(filename))
+		throw CartridgeException("Cartridge file: " + filename + " not found");
+	const uint8_t* data = copy ? contents.data() : this->file.data();
+	size_t size = copy ? contents.size() : this->file.size();
+
+	RomArchiveEntry archived;
+	archived.size = size;
+	bool isArchive = findArchivedRom(data, size, archived);
+	if (!isArchive || !archived.deflated) {
+
+		//	a stored ROM is never read past what the archive holds of it, whatever size it claims to be
+		const uint8_t* stored = data + archived.offset;
+		size_t storedSize = isArchive ? std::min(archived.size, archived.packedSize) : archived.size;
+		checkMagic(stored, storedSize);
+
+		//	nothing has checked a stored ROM yet, where inflating would have
+		if (isArchive && (archived.size != archived.packedSize || crc32(stored, storedSize) != archived.crc32))
+			throw CartridgeException("Compressed ROM is damaged");
+
+		//	anything but a compressed ROM(stored ROMs in a zip included) is used straight out of the mapped file
+		this->length = storedSize;
+		if (!copy) {
+
+			this->start = this->file.data() + archived.offset;
+			return;
+
+		}
+
+		size_t offset = this->arena.reserve(storedSize);
+		if (!this->arena.allocate())
+			throw CartridgeException("Not enough memory to load the cartridge");
+		this->start = this->arena.at(offset);
+		std::memcpy(this->start, stored, storedSize);
+		return;
+
+	}
+
+	//	the header is inflated and checked first, so an archive with something else in it costs 16 bytes of inflating
+	InflateClass inflate(data + archived.offset, archived.packedSize);
+	uint8_t header[sizeof(romHeaderStruct)] = { 0 };
+	checkMagic(header, inflate.read(header, sizeof(header)));
+	if (archived.size < sizeof(header))
+		throw CartridgeException("Compressed ROM is damaged");
+	if (archived.size > MAX_INFLATED_ROM_SIZE)
+		throw CartridgeException("Compressed ROM is too large");
+
+	size_t offset = this->arena.reserve(archived.size);
+	if (!this->arena.allocate())
+		throw CartridgeException("Not enough memory to load the cartridge");
+	this->start = this->arena.at(offset);
+	this->length = archived.size;
+
+	std::memcpy(this->start, header, sizeof(header));
+	size_t bodySize = inflate.read(this->start + sizeof(header), archived.size - sizeof(header));
+	if (bodySize != archived.size - sizeof(header) || crc32(this->start, archived.size) != archived.crc32)
+		throw CartridgeException("Compressed ROM is damaged");
+
+	//	the archive is not needed once it is inflated
+	this->file.close();
+
+}
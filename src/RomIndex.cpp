@@ -0,0 +1,287 @@
+#include <filesystem>	//	std::filesystem
+#include <fstream>		//	std::ifstream, std::ofstream
+#include <sstream>		//	std::istringstream
+#include <algorithm>	//	std::sort, std::lower_bound
+#include <cstring>		//	std::memcmp
+#include <cctype>		//	std::tolower
+
+#include ".\include\RomIndex.h"
+#include ".\include\Cartridge.h"
+#include ".\include\Checksum.h"
+#include ".\include\WorkerPool.h"
+#include ".\include\RomArchive.h"
+#include ".\include\ErrorLog.h"
+
+#include ".\include\custom_exceptions.h"
+
+//	the first line of every index file, bumped whenever the line format changes
+static const std::string indexVersion = "nes_emu ROM index 2";
+
+RomIndexClass::RomIndexClass(uint32_t _threadCount) {
+
+	this->threadCount = _threadCount;
+
+}
+
+bool RomIndexClass::load(const std::string& indexFile) {
+
+	this->entries.clear();
+	this->rebuildLookups();
+
+	std::ifstream input(indexFile);
+	std::string line;
+	if (!input.is_open() || !std::getline(input, line) || line != indexVersion)
+		return false;
+
+	//	valid, crc32, sha1, mapper, submapper, nes2, tv, prg size, chr size, chr ram, prg ram size, battery, mirroring, header fixed, file size, modified, then the path, which takes up the rest of the line
+	while (std::getline(input, line)) {
+
+		std::istringstream fields(line);
+		RomIndexEntry entry;
+		std::string sha1;
+		uint32_t valid, mapperID, submapperID, nes2, tvType, chrRam, battery, mirroring, headerFixed;
+
+		fields >> valid >> std::hex >> entry.crc32 >> sha1 >> std::dec >> mapperID >> submapperID >> nes2 >> tvType >> entry.prgSize >> entry.chrSize >> chrRam
+			>> entry.prgRamSize >> battery >> mirroring >> headerFixed >> entry.fileSize >> entry.modified;
+		fields.get();
+		std::getline(fields, entry.path);
+		if (fields.fail() || sha1.size() != 40 || entry.path.empty())
+			continue;
+
+		for (uint8_t i = 0; i < 20; i++)
+			entry.sha1[i] = (uint8_t)std::stoul(sha1.substr((size_t)i * 2, 2), nullptr, 16);
+		entry.valid = valid != 0;
+		entry.mapperID = (uint8_t)mapperID;
+		entry.submapperID = (uint8_t)submapperID;
+		entry.nes2 = nes2 != 0;
+		entry.tvType = (tvEnum)tvType;
+		entry.chrRam = chrRam != 0;
+		entry.battery = battery != 0;
+		entry.mirroring = (mirrorEnum)mirroring;
+		entry.headerFixed = headerFixed != 0;
+		this->entries.push_back(entry);
+
+	}
+
+	std::sort(this->entries.begin(), this->entries.end(), [](const RomIndexEntry& a, const RomIndexEntry& b) { return a.path < b.path; });
+	this->rebuildLookups();
+	return true;
+
+}
+
+bool RomIndexClass::save(const std::string& indexFile) {
+
+	//	written next to the old index first, so a failed save never leaves half of one behind
+	std::string temporary = indexFile + ".tmp";
+	{
+		std::ofstream output(temporary, std::ios::out | std::ios::trunc);
+		if (!output.is_open())
+			return false;
+
+		output << indexVersion << '\n';
+		for (const RomIndexEntry& entry : this->entries) {
+
+			output << (entry.valid ? 1 : 0) << '\t' << std::hex << entry.crc32 << std::dec << '\t' << Sha1Class::toHex(entry.sha1) << '\t'
+				<< (uint32_t)entry.mapperID << '\t' << (uint32_t)entry.submapperID << '\t' << (entry.nes2 ? 1 : 0) << '\t' << (uint32_t)entry.tvType << '\t'
+				<< entry.prgSize << '\t' << entry.chrSize << '\t' << (entry.chrRam ? 1 : 0) << '\t'
+				<< entry.prgRamSize << '\t' << (entry.battery ? 1 : 0) << '\t' << (uint32_t)entry.mirroring << '\t' << (entry.headerFixed ? 1 : 0) << '\t'
+				<< entry.fileSize << '\t' << entry.modified << '\t' << entry.path << '\n';
+
+		}
+
+		if (output.fail())
+			return false;
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporary, indexFile, error);
+	return !error;
+
+}
+
+uint32_t RomIndexClass::scan(const std::string& directory, bool recursive) {
+
+	std::error_code error;
+	std::filesystem::path root = std::filesystem::absolute(directory, error).lexically_normal();
+	if (error || !std::filesystem::is_directory(root, error))
+		return 0;
+
+	std::string prefix = root.u8string();
+	if (prefix.back() != std::filesystem::path::preferred_separator)
+		prefix += (char)std::filesystem::path::preferred_separator;
+
+	//	entries outside of this directory are kept as they are, the ones inside are what the listing below is checked against,
+	//	so they are compacted into entries and looked up from there, findPath would otherwise index into the ones that were moved out
+	std::vector<RomIndexEntry> updated, inside;
+	for (RomIndexEntry& entry : this->entries) {
+
+		if (entry.path.compare(0, prefix.size(), prefix) != 0)
+			updated.push_back(std::move(entry));
+		else
+			inside.push_back(std::move(entry));
+
+	}
+	this->entries = std::move(inside);
+	this->rebuildLookups();
+
+	//	only listing the directory and checking sizes/times happens on this thread, that is all an unchanged library costs
+	std::vector<size_t> stale;
+	auto visit = [&](const std::filesystem::directory_entry& file) {
+
+		std::error_code fileError;
+		std::string extension = file.path().extension().u8string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+		if ((extension != ".nes" && !isRomArchiveName(extension)) || !file.is_regular_file(fileError))
+			return;
+
+		RomIndexEntry entry;
+		entry.path = file.path().u8string();
+		entry.fileSize = file.file_size(fileError);
+		entry.modified = (int64_t)file.last_write_time(fileError).time_since_epoch().count();
+		if (fileError)
+			return;
+
+		const RomIndexEntry* known = this->findPath(entry.path);
+		if (known != nullptr && known->fileSize == entry.fileSize && known->modified == entry.modified)
+			entry = *known;
+		else
+			stale.push_back(updated.size());
+		updated.push_back(entry);
+
+	};
+
+	std::filesystem::directory_options options = std::filesystem::directory_options::skip_permission_denied;
+	if (recursive) {
+
+		for (auto it = std::filesystem::recursive_directory_iterator(root, options, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+			visit(*it);
+
+	}
+	else {
+
+		for (auto it = std::filesystem::directory_iterator(root, options, error); !error && it != std::filesystem::directory_iterator(); it.increment(error))
+			visit(*it);
+
+	}
+
+	//	each file is mapped, parsed and hashed on its own, so they split up across threads without sharing anything
+	if (!stale.empty()) {
+
+		std::vector<std::string> errors(stale.size());
+		WorkerPoolClass pool(this->threadCount);
+		pool.start((uint32_t)stale.size(), [&](uint32_t first, uint32_t last) {
+
+			for (uint32_t i = first; i < last; i++)
+				errors[i] = RomIndexClass::hashFile(updated[stale[i]]);
+
+		});
+		pool.wait();
+
+		ErrorLogClass log;
+		for (size_t i = 0; i < stale.size(); i++) {
+
+			if (!errors[i].empty())
+				log.Write(updated[stale[i]].path + ": " + errors[i]);
+
+		}
+
+	}
+
+	std::sort(updated.begin(), updated.end(), [](const RomIndexEntry& a, const RomIndexEntry& b) { return a.path < b.path; });
+	this->entries = std::move(updated);
+	this->rebuildLookups();
+
+	return (uint32_t)stale.size();
+
+}
+
+const RomIndexEntry* RomIndexClass::findCRC32(uint32_t crc) {
+
+	auto found = this->byCRC32.find(crc);
+	return (found != this->byCRC32.end()) ? &this->entries[found->second] : nullptr;
+
+}
+
+const RomIndexEntry* RomIndexClass::findSHA1(const uint8_t sha1[20]) {
+
+	uint64_t key;
+	std::memcpy(&key, sha1, sizeof(key));
+
+	auto range = this->bySHA1.equal_range(key);
+	for (auto it = range.first; it != range.second; it++) {
+
+		if (std::memcmp(this->entries[it->second].sha1, sha1, 20) == 0)
+			return &this->entries[it->second];
+
+	}
+	return nullptr;
+
+}
+
+const RomIndexEntry* RomIndexClass::findPath(const std::string& path) {
+
+	auto found = this->byPath.find(path);
+	return (found != this->byPath.end()) ? &this->entries[found->second] : nullptr;
+
+}
+
+void RomIndexClass::rebuildLookups() {
+
+	this->byCRC32.clear();
+	this->bySHA1.clear();
+	this->byPath.clear();
+
+	for (size_t i = 0; i < this->entries.size(); i++) {
+
+		const RomIndexEntry& entry = this->entries[i];
+		this->byPath[entry.path] = i;
+		if (!entry.valid)
+			continue;
+
+		uint64_t key;
+		std::memcpy(&key, entry.sha1, sizeof(key));
+		this->byCRC32.insert({ entry.crc32, i });
+		this->bySHA1.insert({ key, i });
+
+	}
+
+}
+
+std::string RomIndexClass::hashFile(RomIndexEntry& entry) {
+
+	DeferExceptionLog defer;
+	std::unique_ptr<romStruct> rom;
+	try {
+
+		rom = CartridgeClass::read(entry.path);
+
+	}
+	catch (const std::exception& e) {
+
+		entry.valid = false;
+		return e.what();
+
+	}
+
+	//	the same bytes the header database goes by, so entries can be copied straight into HeaderDatabase.inc
+	size_t offset = std::min(romDataOffset(rom->header), rom->image.size());
+	Sha1Class sha1;
+	sha1.update(rom->image.data() + offset, std::min(romDataSize(rom->header), rom->image.size() - offset));
+
+	entry.valid = true;
+	entry.crc32 = rom->crc32;
+	sha1.finish(entry.sha1);
+	entry.mapperID = romMapperID(rom->header);
+	entry.nes2 = (rom->header.flags7 & 0b00001100) == 0b00001000;
+	entry.submapperID = entry.nes2 ? (rom->header.flags8 >> 4) : 0;
+	entry.tvType = rom->tvType;
+	entry.prgSize = (uint32_t)rom->prg_rom.size();
+	entry.chrSize = (uint32_t)rom->chr_rom.size();
+	entry.chrRam = rom->chr_ram;
+	entry.prgRamSize = (uint32_t)rom->prg_ram.size();
+	entry.battery = (rom->header.flags6 & 0b00000010) != 0;
+	entry.mirroring = (rom->header.flags6 & 0b00001000) ? mirrorEnum::FOURSCREEN : ((rom->header.flags6 & 0b00000001) ? mirrorEnum::VERTICAL : mirrorEnum::HORIZONTAL);
+	entry.headerFixed = rom->headerFixed;
+	return "";
+
+}
@@ -0,0 +1,141 @@
+#include <filesystem>
+
+#include ".\include\SaveWriter.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>		//	open
+#include <unistd.h>		//	write, fsync, close
+#include <cstdio>		//	std::rename
+#endif
+
+SaveWriterClass::~SaveWriterClass() {
+
+	if (!this->thread.joinable())
+		return;
+
+	this->wait();
+
+	{
+		std::unique_lock<std::mutex> guard(this->lock);
+		this->stopping = true;
+	}
+	this->wake.notify_all();
+
+	this->thread.join();
+
+}
+
+void SaveWriterClass::write(const std::string& filename, const uint8_t* data, size_t size) {
+
+	{
+		std::unique_lock<std::mutex> guard(this->lock);
+
+		//	the copy is all the game's PRG RAM, at most a few KB, so taking it costs the emulation thread next to nothing
+		this->queued[filename].assign(data, data + size);
+
+		if (!this->thread.joinable())
+			this->thread = std::thread(&SaveWriterClass::work, this);
+	}
+	this->wake.notify_all();
+
+}
+
+void SaveWriterClass::wait() {
+
+	std::unique_lock<std::mutex> guard(this->lock);
+	this->done.wait(guard, [this] { return this->queued.empty() && !this->writing; });
+
+}
+
+std::vector<std::string> SaveWriterClass::takeFailures() {
+
+	std::unique_lock<std::mutex> guard(this->lock);
+	std::vector<std::string> failures;
+	failures.swap(this->failures);
+	return failures;
+
+}
+
+void SaveWriterClass::work() {
+
+	std::unique_lock<std::mutex> guard(this->lock);
+
+	while (true) {
+
+		this->wake.wait(guard, [this] { return this->stopping || !this->queued.empty(); });
+		if (this->stopping)
+			return;
+
+		std::string filename = this->queued.begin()->first;
+		std::vector<uint8_t> data = std::move(this->queued.begin()->second);
+		this->queued.erase(this->queued.begin());
+		this->writing = true;
+
+		//	the disk is only waited on unlocked, so the emulation thread can queue the next save meanwhile
+		guard.unlock();
+		bool written = SaveWriterClass::writeFile(filename, data);
+		guard.lock();
+
+		if (!written)
+			this->failures.push_back(filename);
+		this->writing = false;
+		if (this->queued.empty())
+			this->done.notify_all();
+
+	}
+
+}
+
+bool SaveWriterClass::writeFile(const std::string& filename, const std::vector<uint8_t>& data) {
+
+	std::filesystem::path path = std::filesystem::u8path(filename);
+	std::filesystem::path written = std::filesystem::u8path(filename + ".tmp");
+
+#ifdef _WIN32
+	HANDLE file = CreateFileW(written.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	DWORD size = 0;
+	bool flushed = WriteFile(file, data.data(), (DWORD)data.size(), &size, nullptr) && size == data.size() && FlushFileBuffers(file);
+	CloseHandle(file);
+
+	//	write through, so the move itself is on the disk too before this returns
+	return flushed && MoveFileExW(written.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+	int file = ::open(written.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (file < 0)
+		return false;
+
+	size_t size = 0;
+	while (size < data.size()) {
+
+		ssize_t count = ::write(file, data.data() + size, data.size() - size);
+		if (count <= 0)
+			break;
+		size += (size_t)count;
+
+	}
+	bool flushed = size == data.size() && fsync(file) == 0;
+	::close(file);
+
+	if (!flushed || std::rename(written.c_str(), path.c_str()) != 0)
+		return false;
+
+	//	the move only lasts a power cut once the directory holding the save is flushed as well
+	std::filesystem::path folder = path.has_parent_path() ? path.parent_path() : std::filesystem::path(".");
+	int directory = ::open(folder.c_str(), O_RDONLY);
+	if (directory >= 0) {
+
+		fsync(directory);
+		::close(directory);
+
+	}
+	return true;
+#endif
+
+}
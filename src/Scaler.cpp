@@ -0,0 +1,243 @@
+#include <algorithm>
+
+#include ".\include\Scaler.h"
+#include ".\include\simd_util.h"
+
+//	neighbours of the pixel being scaled(E) are named
+//	A B C
+//	D E F
+//	G H I
+
+static inline void scale2xPixel(uint16_t B, uint16_t D, uint16_t E, uint16_t F, uint16_t H, uint16_t* top, uint16_t* bottom) {
+
+	//	only pixels sitting on an edge get changed
+	if (B != H && D != F) {
+
+		top[0] = (D == B) ? D : E;
+		top[1] = (B == F) ? F : E;
+		bottom[0] = (D == H) ? D : E;
+		bottom[1] = (H == F) ? F : E;
+		return;
+
+	}
+
+	top[0] = top[1] = bottom[0] = bottom[1] = E;
+
+}
+
+static inline void scale3xPixel(uint16_t A, uint16_t B, uint16_t C, uint16_t D, uint16_t E, uint16_t F, uint16_t G, uint16_t H, uint16_t I, uint16_t* top, uint16_t* middle, uint16_t* bottom) {
+
+	if (B != H && D != F) {
+
+		top[0] = (D == B) ? D : E;
+		top[1] = ((D == B && E != C) || (B == F && E != A)) ? B : E;
+		top[2] = (B == F) ? F : E;
+		middle[0] = ((D == B && E != G) || (D == H && E != A)) ? D : E;
+		middle[1] = E;
+		middle[2] = ((B == F && E != I) || (H == F && E != C)) ? F : E;
+		bottom[0] = (D == H) ? D : E;
+		bottom[1] = ((D == H && E != I) || (H == F && E != G)) ? H : E;
+		bottom[2] = (H == F) ? F : E;
+		return;
+
+	}
+
+	top[0] = top[1] = top[2] = middle[0] = middle[1] = middle[2] = bottom[0] = bottom[1] = bottom[2] = E;
+
+}
+
+#ifdef SIMD_X86
+//	mask ? a : b, per 16 bit lane
+static inline __m128i selectLanes(__m128i mask, __m128i a, __m128i b) {
+
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+
+}
+#endif
+
+ScalerClass::ScalerClass() {
+
+#ifdef SIMD_X86
+	this->useSSE2 = cpuHasSSE2();
+#endif
+
+}
+
+void ScalerClass::submitFrame(const FrameBuffer& frame) {
+
+	//	the previous frame has had a whole frame's worth of time, so this should rarely have to wait
+	this->wait();
+	if (this->workingStarted) {
+
+		std::swap(this->output, this->working);
+		this->outputReady = true;
+
+	}
+
+	if (this->padded.width != frame.width + 2 || this->padded.height != frame.height + 2)
+		this->padded.create(frame.width + 2, frame.height + 2);
+
+	for (uint32_t y = 0; y < frame.height; y++) {
+
+		const uint16_t* source = &frame.pixels[(size_t)y * frame.width];
+		uint16_t* destination = this->padded.row(y + 1);
+		std::copy(source, source + frame.width, destination + 1);
+		destination[0] = source[0];
+		destination[frame.width + 1] = source[frame.width - 1];
+
+	}
+	std::copy(this->padded.row(1), this->padded.row(2), this->padded.row(0));
+	std::copy(this->padded.row(frame.height), this->padded.row(frame.height + 1), this->padded.row(frame.height + 1));
+
+	if (this->working.width != frame.width * this->factor || this->working.height != frame.height * this->factor)
+		this->working.create(frame.width * this->factor, frame.height * this->factor);
+	this->workingStarted = true;
+
+	void (ScalerClass::*rows)(uint32_t, uint32_t) = (this->factor == 3) ? &ScalerClass::scale3xRows : &ScalerClass::scale2xRows;
+	if (this->pool != nullptr)
+		this->pool->start(frame.height, [this, rows](uint32_t first, uint32_t last) { (this->*rows)(first, last); });
+	else
+		(this->*rows)(0, frame.height);
+
+}
+
+void ScalerClass::setFactor(uint32_t factor) {
+
+	this->flush();
+	this->factor = (factor == 3) ? 3 : 2;
+
+}
+
+void ScalerClass::flush() {
+
+	this->wait();
+	this->workingStarted = false;
+	this->outputReady = false;
+
+}
+
+void ScalerClass::scale2xRows(uint32_t first, uint32_t last) {
+
+	//	signed, so x - 1 can reach the left border
+	int32_t width = (int32_t)this->padded.width - 2;
+
+	for (uint32_t y = first; y < last; y++) {
+
+		//	all offset by 1, so index -1 and width are the border
+		const uint16_t* above = this->padded.row(y) + 1;
+		const uint16_t* center = this->padded.row(y + 1) + 1;
+		const uint16_t* below = this->padded.row(y + 2) + 1;
+		uint16_t* top = this->working.row(y * 2);
+		uint16_t* bottom = this->working.row((y * 2) + 1);
+
+		int32_t x = 0;
+
+#ifdef SIMD_X86
+		if (this->useSSE2) {
+
+			for (; x + 8 <= width; x += 8) {
+
+				__m128i B = _mm_loadu_si128((const __m128i*)(above + x));
+				__m128i D = _mm_loadu_si128((const __m128i*)(center + x - 1));
+				__m128i E = _mm_loadu_si128((const __m128i*)(center + x));
+				__m128i F = _mm_loadu_si128((const __m128i*)(center + x + 1));
+				__m128i H = _mm_loadu_si128((const __m128i*)(below + x));
+
+				__m128i edge = _mm_andnot_si128(_mm_or_si128(_mm_cmpeq_epi16(B, H), _mm_cmpeq_epi16(D, F)), _mm_set1_epi32(-1));
+				__m128i E0 = selectLanes(_mm_and_si128(edge, _mm_cmpeq_epi16(D, B)), D, E);
+				__m128i E1 = selectLanes(_mm_and_si128(edge, _mm_cmpeq_epi16(B, F)), F, E);
+				__m128i E2 = selectLanes(_mm_and_si128(edge, _mm_cmpeq_epi16(D, H)), D, E);
+				__m128i E3 = selectLanes(_mm_and_si128(edge, _mm_cmpeq_epi16(H, F)), F, E);
+
+				//	each input pixel is 2 output pixels wide, so interleave the left and right halves
+				_mm_storeu_si128((__m128i*)(top + (x * 2)), _mm_unpacklo_epi16(E0, E1));
+				_mm_storeu_si128((__m128i*)(top + (x * 2) + 8), _mm_unpackhi_epi16(E0, E1));
+				_mm_storeu_si128((__m128i*)(bottom + (x * 2)), _mm_unpacklo_epi16(E2, E3));
+				_mm_storeu_si128((__m128i*)(bottom + (x * 2) + 8), _mm_unpackhi_epi16(E2, E3));
+
+			}
+
+		}
+#endif
+
+		for (; x < width; x++)
+			scale2xPixel(above[x], center[x - 1], center[x], center[x + 1], below[x], top + (x * 2), bottom + (x * 2));
+
+	}
+
+}
+
+void ScalerClass::scale3xRows(uint32_t first, uint32_t last) {
+
+	int32_t width = (int32_t)this->padded.width - 2;
+
+	for (uint32_t y = first; y < last; y++) {
+
+		const uint16_t* above = this->padded.row(y) + 1;
+		const uint16_t* center = this->padded.row(y + 1) + 1;
+		const uint16_t* below = this->padded.row(y + 2) + 1;
+		uint16_t* top = this->working.row(y * 3);
+		uint16_t* middle = this->working.row((y * 3) + 1);
+		uint16_t* bottom = this->working.row((y * 3) + 2);
+
+		int32_t x = 0;
+
+#ifdef SIMD_X86
+		if (this->useSSE2) {
+
+			//	there is no 3 way interleave, so the results go through a small buffer
+			uint16_t results[9][8];
+
+			for (; x + 8 <= width; x += 8) {
+
+				__m128i A = _mm_loadu_si128((const __m128i*)(above + x - 1));
+				__m128i B = _mm_loadu_si128((const __m128i*)(above + x));
+				__m128i C = _mm_loadu_si128((const __m128i*)(above + x + 1));
+				__m128i D = _mm_loadu_si128((const __m128i*)(center + x - 1));
+				__m128i E = _mm_loadu_si128((const __m128i*)(center + x));
+				__m128i F = _mm_loadu_si128((const __m128i*)(center + x + 1));
+				__m128i G = _mm_loadu_si128((const __m128i*)(below + x - 1));
+				__m128i H = _mm_loadu_si128((const __m128i*)(below + x));
+				__m128i I = _mm_loadu_si128((const __m128i*)(below + x + 1));
+
+				__m128i edge = _mm_andnot_si128(_mm_or_si128(_mm_cmpeq_epi16(B, H), _mm_cmpeq_epi16(D, F)), _mm_set1_epi32(-1));
+				__m128i DB = _mm_and_si128(edge, _mm_cmpeq_epi16(D, B));
+				__m128i BF = _mm_and_si128(edge, _mm_cmpeq_epi16(B, F));
+				__m128i DH = _mm_and_si128(edge, _mm_cmpeq_epi16(D, H));
+				__m128i HF = _mm_and_si128(edge, _mm_cmpeq_epi16(H, F));
+				__m128i EA = _mm_cmpeq_epi16(E, A), EC = _mm_cmpeq_epi16(E, C), EG = _mm_cmpeq_epi16(E, G), EI = _mm_cmpeq_epi16(E, I);
+
+				_mm_storeu_si128((__m128i*)results[0], selectLanes(DB, D, E));
+				_mm_storeu_si128((__m128i*)results[1], selectLanes(_mm_or_si128(_mm_andnot_si128(EC, DB), _mm_andnot_si128(EA, BF)), B, E));
+				_mm_storeu_si128((__m128i*)results[2], selectLanes(BF, F, E));
+				_mm_storeu_si128((__m128i*)results[3], selectLanes(_mm_or_si128(_mm_andnot_si128(EG, DB), _mm_andnot_si128(EA, DH)), D, E));
+				_mm_storeu_si128((__m128i*)results[4], E);
+				_mm_storeu_si128((__m128i*)results[5], selectLanes(_mm_or_si128(_mm_andnot_si128(EI, BF), _mm_andnot_si128(EC, HF)), F, E));
+				_mm_storeu_si128((__m128i*)results[6], selectLanes(DH, D, E));
+				_mm_storeu_si128((__m128i*)results[7], selectLanes(_mm_or_si128(_mm_andnot_si128(EI, DH), _mm_andnot_si128(EG, HF)), H, E));
+				_mm_storeu_si128((__m128i*)results[8], selectLanes(HF, F, E));
+
+				for (int32_t i = 0; i < 8; i++) {
+
+					int32_t column = (x + i) * 3;
+					for (int32_t j = 0; j < 3; j++) {
+
+						top[column + j] = results[j][i];
+						middle[column + j] = results[3 + j][i];
+						bottom[column + j] = results[6 + j][i];
+
+					}
+
+				}
+
+			}
+
+		}
+#endif
+
+		for (; x < width; x++)
+			scale3xPixel(above[x - 1], above[x], above[x + 1], center[x - 1], center[x], center[x + 1], below[x - 1], below[x], below[x + 1], top + (x * 3), middle + (x * 3), bottom + (x * 3));
+
+	}
+
+}
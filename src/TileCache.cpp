@@ -0,0 +1,56 @@
+#include <algorithm>
+
+#include ".\include\TileCache.h"
+#include ".\include\mappers\Mapper.h"
+
+TileCacheClass::TileCacheClass(MapperClass* _mapper) {
+
+	this->mapper = _mapper;
+
+	//	the pattern tables are 8KB, which is 512 tiles of 16 bytes each
+	this->rows.resize(512 * 16);
+	this->decoded.resize(512, false);
+
+}
+
+void TileCacheClass::invalidateWindow(uint16_t address, uint16_t size) {
+
+	uint16_t first = (address >> 4) & 0x01FF;
+	uint16_t count = std::min<uint16_t>(size >> 4, 512 - first);
+	std::fill(this->decoded.begin() + first, this->decoded.begin() + first + count, false);
+
+	for (uint16_t kb = (first >> 6); kb < ((first + count + 0x3F) >> 6); kb++)
+		this->dirty |= 1 << kb;
+
+}
+
+void TileCacheClass::decode(uint16_t tile) {
+
+	for (uint16_t y = 0; y < 8; y++) {
+
+		//	the low plane is the first 8 bytes of the tile, the high plane the next 8
+		uint16_t address = (tile << 4) | y;
+		uint8_t low = this->mapper->chrRead(address);
+		uint8_t high = this->mapper->chrRead(address | 0x08);
+
+		TileRow& normal = this->rows[((size_t)tile << 4) | y];
+		TileRow& flipped = this->rows[((size_t)tile << 4) | 0x08 | y];
+		normal.packed = 0;
+		flipped.packed = 0;
+
+		for (uint8_t x = 0; x < 8; x++) {
+
+			//	bit 7 of each plane is the leftmost pixel
+			uint8_t pixel = (((high >> (7 - x)) & 1) << 1) | ((low >> (7 - x)) & 1);
+			normal.pixels[x] = pixel;
+			flipped.pixels[7 - x] = pixel;
+			normal.packed |= (uint16_t)pixel << (14 - (x * 2));
+			flipped.packed |= (uint16_t)pixel << (x * 2);
+
+		}
+
+	}
+
+	this->decoded[tile] = true;
+
+}
@@ -0,0 +1,85 @@
+#include <algorithm>
+
+#include ".\include\WorkerPool.h"
+
+WorkerPoolClass::WorkerPoolClass(uint32_t threadCount) {
+
+	if (threadCount == 0) {
+
+		//	hardware_concurrency is allowed to return 0 when it cannot tell
+		uint32_t hardware = std::thread::hardware_concurrency();
+		threadCount = (hardware > 1) ? hardware - 1 : 1;
+
+	}
+
+	for (uint32_t i = 0; i < threadCount; i++)
+		this->threads.push_back(std::thread(&WorkerPoolClass::work, this));
+
+}
+
+WorkerPoolClass::~WorkerPoolClass() {
+
+	this->wait();
+
+	{
+		std::unique_lock<std::mutex> guard(this->lock);
+		this->stopping = true;
+	}
+	this->wake.notify_all();
+
+	for (uint32_t i = 0; i < this->threads.size(); i++)
+		this->threads.at(i).join();
+
+}
+
+void WorkerPoolClass::start(uint32_t count, std::function<void(uint32_t first, uint32_t last)> task) {
+
+	this->wait();
+
+	{
+		std::unique_lock<std::mutex> guard(this->lock);
+
+		//	a few chunks per thread, so one slow chunk does not hold up the whole job
+		this->task = task;
+		this->count = count;
+		this->chunkCount = std::min<uint32_t>(count, (uint32_t)this->threads.size() * 4);
+		this->chunkSize = this->chunkCount ? (count + this->chunkCount - 1) / this->chunkCount : 0;
+		this->chunkCount = this->chunkSize ? (count + this->chunkSize - 1) / this->chunkSize : 0;
+		this->nextChunk = 0;
+		this->remaining = this->chunkCount;
+	}
+	this->wake.notify_all();
+
+}
+
+void WorkerPoolClass::wait() {
+
+	std::unique_lock<std::mutex> guard(this->lock);
+	this->done.wait(guard, [this] { return this->remaining == 0; });
+
+}
+
+void WorkerPoolClass::work() {
+
+	std::unique_lock<std::mutex> guard(this->lock);
+
+	while (true) {
+
+		this->wake.wait(guard, [this] { return this->stopping || this->nextChunk < this->chunkCount; });
+		if (this->stopping)
+			return;
+
+		uint32_t first = this->nextChunk++ * this->chunkSize;
+		uint32_t last = std::min(first + this->chunkSize, this->count);
+
+		//	the task itself runs unlocked, so the other workers can grab their chunks
+		guard.unlock();
+		this->task(first, last);
+		guard.lock();
+
+		if (--this->remaining == 0)
+			this->done.notify_all();
+
+	}
+
+}
@@ -1,14 +1,32 @@
+#include <cinttypes>	//	(u)intx_t datatypes
+
 #include ".\include\ErrorLog.h"
 #include ".\include\custom_exceptions.h"
 
+static thread_local uint32_t deferred = 0;
+
+DeferExceptionLog::DeferExceptionLog() {
+
+	deferred++;
+}
+
+DeferExceptionLog::~DeferExceptionLog() {
+
+	deferred--;
+}
+
 CartridgeException::CartridgeException(const std::string& message) throw() : std::runtime_error(message) {
 
+	if (deferred)
+		return;
 	ErrorLogClass log = ErrorLogClass();
 	log.Write(message);
 }
 
 MapperException::MapperException(const std::string& message) throw() : std::runtime_error(message) {
 
+	if (deferred)
+		return;
 	ErrorLogClass log = ErrorLogClass();
 	log.Write(message);
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <cinttypes>	//	(u)intx_t
 #include <vector>		//	std::vector
+#include <memory>		//	std::unique_ptr
 
 #ifdef CPU_LOGGING
 #include <fstream>		//	std::ifstream, std::ofstream
@@ -13,6 +14,7 @@
 #include ".\APU.h"
 #include ".\Controller.h"
 #include ".\Cartridge.h"
+#include ".\Region.h"
 
 //	the entire register status flags is 8 bits, therefore we can save these values as 8 bit values
 enum CPU_FLAGS : uint8_t {
@@ -49,6 +51,7 @@ with the function pointer, we can effectively pass in the addressing mdoes to th
 reducing significantly the amount of work required to code all opcodes
 */
 class CPUClass;
+class PPUPipelineClass;
 typedef uint16_t(*addrMode)(CPUClass&);
 
 class CPUClass {
@@ -63,7 +66,7 @@ public:
 	void loadAPU(APUClass* _APU) { this->APU = _APU; }
 	void loadController(ControllerClass* _controller) { this->controller = _controller; }
 
-	uint64_t elapsedTime() { return this->getFrameCycles() - this->remainingCycles; }
+	uint64_t elapsedTime() { return this->frameCycles - this->remainingCycles; }
 
 	//	used to "turn on" the console and reset console
 	void reset();
@@ -77,7 +80,11 @@ public:
 	void setNMI(bool _NMI) { this->NMI_INT = _NMI; }
 	void setIRQ(bool _IRQ) { this->IRQ_INT = _IRQ; }
 
-	uint32_t getFrameCycles() { return this->tvFrameCycleCount[this->cartridge->getTV()]; }
+	uint32_t getFrameCycles() { return this->frameCycles; }
+
+	//	runs the PPU on its own thread(see PPUPipeline.h), only takes effect between frames
+	void setPipelined(bool enabled);
+	bool isPipelined() { return (bool)this->pipeline; }
 
 	//int readDMC(void*, cpu_addr_t address) { return this->access(address); }
 
@@ -109,8 +116,19 @@ protected:
 	APUClass* APU = nullptr;
 	ControllerClass* controller = nullptr;
 
-	//	for handling the differences between NTSC and PAL versions of the 6502, which can be seen here: https://wiki.nesdev.com/w/index.php/Cycle_reference_chart#CPU_cycle_counts
-	uint32_t tvFrameCycleCount[2] = { 29781, 33248 };
+	//	the mapper's PRG ROM slots, picked up at reset(see Mapper.h)
+	uint8_t* const* prgSlots = nullptr;
+
+	//	for handling the differences between NTSC, PAL and Dendy versions of the 6502, which can be seen here: https://wiki.nesdev.com/w/index.php/Cycle_reference_chart#CPU_cycle_counts
+	//	all of these are picked once in reset(), once we know which region the ROM is for(see Region.h)
+	uint32_t frameCycles = RegionTiming<tvEnum::NTSC>::FRAME_CYCLES;
+	uint32_t masterClock = 0;
+	void (CPUClass::* cycleRegion)() = &CPUClass::cycleTimed<tvEnum::NTSC>;
+	void (CPUClass::* cyclePipelinedRegion)() = &CPUClass::cyclePipelined<tvEnum::NTSC>;
+
+	//	only set for the length of runFrame, so reset and the debug views still see the PPU directly
+	std::unique_ptr<PPUPipelineClass> pipeline;
+	bool pipelining = false;
 
 	//	used in debug mode for logging
 #ifdef CPU_LOGGING
@@ -118,7 +136,9 @@ protected:
 #endif
 
 	//	to handle the timing of instructions and PPU(PPU clock is 3x CPU clock(at least with NTSC, PAL is 3.2x))
-	void cycle();
+	void cycle() { (this->*cycleRegion)(); }
+	template<tvEnum tv> void cycleTimed();
+	template<tvEnum tv> void cyclePipelined();
 
 	//	declare addressing modes as friends to this class
 	friend uint16_t addrMode_IMM(CPUClass& CPU);		//	immediate mode:           1 byte, data to use is next byte
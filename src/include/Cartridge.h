@@ -2,29 +2,61 @@
 #define CARTRIDGE_H
 
 #include <string>		//	std::string
+#include <memory>		//	std::unique_ptr
 
 #include ".\RomStruct.h"
+#include ".\SaveWriter.h"
 
 //	forward declare romStruct
 enum tvEnum : uint8_t;
 struct romStruct;
+struct TileRow;
+class TileCacheClass;
 class MapperClass;
+class MapperDeferralClass;
+struct MapperPpuChange;
+class CPUClass;
 
 class CartridgeClass {
 
 public:
-	~CartridgeClass() {  }
-	[[nodiscard]] romStruct* load(std::string filename);
+	CartridgeClass();
+	~CartridgeClass();															//	out of line, as MapperClass is only forward declared here
+	//	copy opens the ROM as a copy instead of mapping it, for a ROM that may be rebuilt while it runs, see RomImageClass::open
+	[[nodiscard]] std::unique_ptr<romStruct> load(std::string filename, bool copy = false);
+	[[nodiscard]] static std::unique_ptr<romStruct> read(std::string filename, bool copy = false);	//	maps(or copies) and parses a ROM without loading it or its save, see RomIndex.h
+	[[nodiscard]] static std::unique_ptr<romStruct> readComplete(std::string filename);	//	a copy of the ROM if it reads and holds everything its header says, nullptr without logging why if not
 	void unload();
+
+	//	for homebrew, reloads the ROM from filename after it was rebuilt, rom being the new build as read(as a copy, so it can be rebuilt again, see readComplete):
+	//	when the new build has the same header, its PRG/CHR ROM is swapped in under the running game(see MapperClass::reloadRom),
+	//	otherwise it replaces the running game like load would, returns false in that case as the CPU and PPU have to be reset
+	//	throws the same as selectMapper, before anything is replaced, so the running game carries on
+	bool reload(std::string filename, std::unique_ptr<romStruct> rom);
 	bool loaded();
-	void storeMapper(MapperClass* _mapper);
+	void storeMapper(std::unique_ptr<MapperClass> _mapper);					//	the mapper owns the ROM it was made from, see selectMapper
 	void reset();
 	uint8_t prg_access(uint16_t& address, const uint8_t& data, bool isWrite);	//	for CPU access
 	uint8_t chr_access(uint16_t& address, const uint8_t& data, bool isWrite);	//	for PPU access
+	const TileRow& chr_tile_row(uint16_t address, bool flip);					//	for PPU pattern fetches
+	uint8_t* const* loadNametables(uint8_t* ciram);								//	for the PPU to find its nametables, see Mapper.h
+	uint8_t takeChrDirty();														//	for the debug viewers, see PPUViewer.h
+	uint8_t* const* getPrgSlots();												//	for the CPU to read PRG ROM directly, see Mapper.h
+	TileCacheClass* getTileCache();												//	for the PPU to fetch patterns directly, see Mapper.h
+	void loadCPU(CPUClass* CPU);												//	for mappers that raise IRQs, see Mapper.h
+	bool watchesA12();															//	for the PPU to decide whether to watch A12 at all, see Mapper.h
+	void clockA12();															//	for the PPU, on every A12 rise the mapper would see
+	void deferPpuChanges(MapperDeferralClass* deferral);						//	for the PPU pipeline, see Mapper.h
+	void applyPpuChange(const MapperPpuChange& change);
 
 	mirrorEnum getMirror();
 	tvEnum getTV();
 
+	//	battery saves: every instance runs on its own copy of PRG RAM, which is only written back to the save file by these, through a SaveWriterClass
+	//	flushSave queues a copy of it when the game has written it, at most every SAVE_FLUSH_INTERVAL(see Mapper.h), called once a frame, and never waits on the disk,
+	//	save always writes it and waits until it is on the disk, called before the cartridge is unloaded or reset
+	void flushSave();
+	void save();
 	std::string getSaveFile() { return this->saveFile; }
 
 	void* get_prm_rom();
@@ -41,8 +73,11 @@ public:
 	typedef size_t(CartridgeClass::*getCartDataSize)(void);
 
 private:
-	MapperClass* mapper = nullptr;
+	std::unique_ptr<MapperClass> mapper;
 	std::string saveFile = "";
+	SaveWriterClass saveWriter;
+
+	void logSaveFailures();
 
 };
 
@@ -0,0 +1,45 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <cinttypes>	//	(u)intx_t datatypes
+#include <string>		//	std::string
+
+/*
+CRC32(the zip/PNG one, reflected 0xEDB88320) and SHA-1, the two hashes ROM databases identify dumps by
+both are worked out 16/64 bytes at a time with PCLMULQDQ/the SHA extensions when the CPU has them, falling back to plain C++ when it does not
+*/
+
+//	crc is the CRC32 of everything before data, so a file can be hashed in pieces
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0);
+
+//	the same without PCLMULQDQ, for checking the fast path against
+uint32_t crc32Scalar(const uint8_t* data, size_t size, uint32_t crc = 0);
+bool crc32Accelerated();
+
+class Sha1Class {
+
+public:
+	//	accelerated = false keeps to plain C++ even when the CPU has the SHA extensions, for checking the fast path against
+	explicit Sha1Class(bool accelerated = true);
+
+	void update(const uint8_t* data, size_t size);
+
+	//	the 20 byte digest, after which nothing else can be added
+	void finish(uint8_t digest[20]);
+
+	//	as the 40 lowercase hex digits everything else shows SHA-1s as
+	static std::string toHex(const uint8_t digest[20]);
+
+	bool isAccelerated();
+
+private:
+	uint32_t state[5];
+	uint8_t block[64];
+	uint32_t blockUsed = 0;
+	uint64_t length = 0;
+
+	void (*compress)(uint32_t state[5], const uint8_t* data, size_t blocks);
+
+};
+
+#endif
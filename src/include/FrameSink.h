@@ -0,0 +1,58 @@
+#ifndef FRAME_SINK_H
+#define FRAME_SINK_H
+
+#include <cinttypes>	//	(u)intx_t datatypes
+#include <vector>		//	std::vector
+
+#include ".\simd_util.h"
+
+//	layout of a single pixel in a FrameBuffer, 9 bits do not fit in a byte, so every pixel takes 2
+enum FRAME_PIXEL_BITMASKS : uint16_t {
+
+	F_INDEX = 0b0000000000111111,		//	6 bit index into the NES master palette, as read from palette RAM
+	F_EMPHASIS = 0b0000000111000000		//	the 3 MASK color emphasis bits(red, green, blue) that were set when the pixel was drawn
+
+};
+
+//	the PPU only ever writes palette indexes, turning them into colors is left to whoever needs them
+struct FrameBuffer {
+
+	uint32_t width = 0;
+	uint32_t height = 0;
+	AlignedVector<uint16_t> pixels;				//	aligned for the SIMD conversions, see simd_util.h
+
+	void create(uint32_t _width, uint32_t _height) { this->width = _width; this->height = _height; this->pixels.assign((size_t)_width * _height, 0); }
+	uint16_t* row(uint32_t y) { return &this->pixels[(size_t)y * this->width]; }
+
+};
+
+/*
+anything that wants completed frames from the PPU(the GUI, a headless test, a video writer, etc.) implements this
+submitFrame is called once per frame, at the start of the post render scanline, and the frame must not be held onto past the call
+*/
+class FrameSinkClass {
+
+public:
+	virtual ~FrameSinkClass() {  }
+
+	//	sinks that need actual colors convert the frame themselves(see Palette.h)
+	virtual void submitFrame(const FrameBuffer& frame) = 0;
+
+};
+
+//	hashes every frame instead of displaying it, used to run the core without a display
+class FrameHashSinkClass : public FrameSinkClass {
+
+public:
+	void submitFrame(const FrameBuffer& frame) override;
+
+	uint64_t getHash() { return this->hash; }
+	uint32_t getFrameCount() { return this->frameCount; }
+
+private:
+	uint64_t hash = 0;
+	uint32_t frameCount = 0;
+
+};
+
+#endif
@@ -5,6 +5,9 @@
 #include <cinttypes>
 #include <string>
 #include <iostream>
+#include <memory>		//	std::unique_ptr
+#include <filesystem>	//	std::filesystem::file_time_type
+#include <chrono>		//	std::chrono::steady_clock
 
 #include ".\imgui.h"
 #include ".\SFML\Graphics.hpp"
@@ -15,6 +18,11 @@
 #include ".\PPU.h"
 #include ".\Cartridge.h"
 #include ".\ErrorLog.h"
+#include ".\FrameSink.h"
+#include ".\Palette.h"
+#include ".\NtscFilter.h"
+#include ".\Scaler.h"
+#include ".\PPUViewer.h"
 
 #include ".\imfilebrowser.h"
 
@@ -22,10 +30,21 @@ struct MemoryEditor;
 
 static bool showSelectDebug = false;
 static bool showFileDialog = false;
+static bool showPaletteDialog = false;
 static bool showControllerDialog = false;
 static bool showButtonSet[8] = { false, false, false, false, false, false, false, false }; // NES controller has 8 buttons
 static bool showMapperError = false;
 
+//	what frames go through on their way from the PPU to gameTexture
+enum VIDEO_FILTERS : uint8_t {
+
+	FILTER_NONE = 0,
+	FILTER_NTSC = 1,
+	FILTER_SCALE2X = 2,
+	FILTER_SCALE3X = 3
+
+};
+
 //	structs to contain everything needed to create the windows for the hex viewers
 //	split up based on component, because of the requirement for function pointers
 struct CartridgeMemoryEditorContainer {
@@ -61,14 +80,28 @@ struct PPUMemoryEditorContainer {
 
 };
 
-class GUIClass {
+//	what the game was doing when its ROM had to be loaded from scratch on a hot reload, put back once the new build is running, see GUIClass::hotReload
+struct HotReloadSnapshot {
+
+	std::vector<uint8_t> cpuRam;
+	std::vector<uint8_t> cpuRegs;
+	std::vector<uint8_t> ppuRegs;
+	std::vector<uint8_t> nametables;
+	std::vector<uint8_t> palettes;
+	std::vector<uint8_t> oam;
+	std::vector<uint8_t> prgRam;
+
+};
+
+class GUIClass : public FrameSinkClass {
 
 public:
 	GUIClass(std::string progName);
 	~GUIClass();
 
 	//	we need to have different functions for the different classes to view, because we need to use function pointers to view the data
-	void addCartViewer(std::string windowName, CartridgeClass::GetCartData getData_ptr, CartridgeClass::getCartDataSize getSize_ptr);
+	//	ROM is shared with every other instance running the same file(see RomImage.h), so its viewers are made read only
+	void addCartViewer(std::string windowName, CartridgeClass::GetCartData getData_ptr, CartridgeClass::getCartDataSize getSize_ptr, bool readOnly = false);
 	void addCPUViewer(std::string windowName, CPUClass::getCPUData getData_ptr, CPUClass::getCPUDataSize getSize_ptr);
 	void addPPUViewer(std::string windowName, PPUClass::getPPUData getData_ptr, PPUClass::getPPUDataSize getSize_ptr);
 
@@ -84,15 +117,15 @@ public:
 
 	//	loader functions of components the GUI interacts
 	void loadCPU(CPUClass* _CPU) { this->CPU = _CPU; }
-	void loadPPU(PPUClass* _PPU) { this->PPU = _PPU; }
-	void loadCartridge(CartridgeClass* _cartridge) { this->cartridge = _cartridge; }
+	void loadPPU(PPUClass* _PPU) { this->PPU = _PPU; this->viewer.loadPPU(_PPU); }
+	void loadCartridge(CartridgeClass* _cartridge) { this->cartridge = _cartridge; this->viewer.loadCartridge(_cartridge); }
 	void loadController(ControllerClass* _controller) { this->controller = _controller; }
 
 	//	checks to see if there is a cartridge ROM loaded
 	bool isLoaded();
 
 	//	used to allow the PPU to update the current frame once scanline is complete
-	void updateFrame(sf::Image& pixels);
+	void submitFrame(const FrameBuffer& frame) override;
 
 private:
 	bool isRendering = true;
@@ -104,16 +137,45 @@ private:
 
 	std::string progName = "";
 	std::string loadedFile = "";
+	std::string loadedPath = "";			//	loadedFile before it is cut down to the file name, for watching it
+
+	//	watch mode, for homebrew: the loaded ROM is reloaded whenever it is rebuilt, see watchRom
+	bool watchEnabled = false;
+	bool keepStateOnReload = true;			//	carry RAM and the PPU over when the new build cannot be swapped in under the running game
+	bool reloadPending = false;				//	the file changed at the last check, and is reloaded once it has stopped changing
+	uintmax_t watchedSize = 0;
+	std::filesystem::file_time_type watchedTime;
+	std::chrono::steady_clock::time_point nextWatch;
 
 	ImGui::FileBrowser filebrowser;
+	ImGui::FileBrowser paletteBrowser;
 
 	std::vector<CartridgeMemoryEditorContainer> cart_hex_windows;
 	std::vector<CPUMemoryEditorContainer> cpu_hex_windows;
 	std::vector<PPUMemoryEditorContainer> ppu_hex_windows;
 
+	//	graphical PPU views, shown alongside the hex views
+	PPUViewerClass viewer;
+	bool showPatternTables = false;
+	bool showNametables = false;
+	bool showSprites = false;
+
 	//	parts that we need for SFML
 	sf::RenderWindow window;
 	sf::Texture gameTexture;
+	AlignedVector<uint32_t> frameColors;
+	PaletteClass palette;
+	//	shared by the filters, only one of which runs at a time, and only started once one is first turned on so no threads sit idle without a filter
+	//	declared before the filters so it outlives them
+	std::unique_ptr<WorkerPoolClass> filterPool;
+	NtscFilterClass ntscFilter;
+	ScalerClass scaler;
+	VIDEO_FILTERS videoFilter = VIDEO_FILTERS::FILTER_NONE;
+	//	the part of gameTexture holding the last frame, which gets stretched back to the NES resolution
+	//	set on every upload to the size of what was uploaded, which is the active filter's output size
+	sf::Vector2u frameSize = sf::Vector2u(VISIBLE_WIDTH, VISIBLE_SCANLINES);
+	//	what the PPU puts out, which the window is sized for
+	sf::Vector2u resolution = sf::Vector2u(VISIBLE_WIDTH, VISIBLE_SCANLINES);
 	sf::Clock clock;
 
 	//	pointers to components the GUI accesses
@@ -128,9 +190,30 @@ private:
 	void drawSelectDebug();
 	void drawDebug();
 	void drawFileDialog();
+	void drawPaletteDialog();
 	void drawControllerDialog();
 	void drawSetButtons(int b);
 	void drawErrorWindow();
+	void drawVideoFilterMenu();
+
+	//	checks the loaded ROM for changes every so often, and hot reloads it once the assembler is done writing it
+	void watchRom();
+	void hotReload(std::unique_ptr<romStruct> rom);
+	void startWatching();
+	void recordWatched();
+
+	//	the window follows the PPU's resolution and frame rate, which change with the region of the ROM
+	void fitWindow();
+
+	//	every filter uploads its output to the top left of gameTexture, which grows to fit the largest the active filter puts out
+	sf::Vector2u filterOutputSize();
+	void fitTexture();
+
+	//	switches filters, throwing away anything the old one had in flight
+	void setVideoFilter(VIDEO_FILTERS filter);
+
+	//	converts a frame of palette indexes to colors and puts it in gameTexture
+	void uploadFrame(const FrameBuffer& frame);
 
 	// Creates a file to store saved game data
 	void saveGame();
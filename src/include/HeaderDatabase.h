@@ -0,0 +1,149 @@
+#ifndef HEADER_DATABASE_H
+#define HEADER_DATABASE_H
+
+#include <cinttypes>	//	(u)intx_t datatypes
+#include <cstddef>		//	size_t
+
+#include ".\RomStruct.h"
+
+//	what a dump's header should have said, see HeaderDatabase.inc
+struct HeaderFix {
+
+	uint32_t crc32 = 0;						//	of PRG ROM and CHR ROM, see romDataSize
+	uint16_t mapperID = 0;
+	uint8_t submapperID = 0;
+	mirrorEnum mirroring = mirrorEnum::HORIZONTAL;	//	HORIZONTAL, VERTICAL or FOURSCREEN, anything else is up to the mapper
+	tvEnum tvType = tvEnum::NTSC;
+	uint8_t prgRamShift = 0;				//	NES 2.0 shift counts, the size is 64 << shift, 0 is none
+	uint8_t prgNvramShift = 0;
+	uint8_t chrRamShift = 0;
+
+};
+
+//	see: https://github.com/aappleby/smhasher/wiki/MurmurHash3 (the 32 bit finalizer)
+constexpr uint32_t mixCRC(uint32_t crc, uint32_t seed) {
+
+	uint32_t hash = crc ^ (seed * 0x9E3779B9);
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6B;
+	hash ^= hash >> 13;
+	hash *= 0xC2B2AE35;
+	hash ^= hash >> 16;
+	return hash;
+
+}
+
+/*
+hash and displace: every CRC goes into a bucket by mixCRC(crc, 0), and each bucket gets the first seed that puts all of its CRCs into empty slots by mixCRC(crc, seed)
+the biggest buckets are placed first, while the table is emptiest, with twice as many slots as entries there is always room
+*/
+template<size_t N>
+struct HeaderTable {
+
+	static constexpr size_t BUCKETS = (N / 4) + 1;
+	static constexpr size_t SLOTS = [] { size_t slots = 2; while (slots < N * 2) slots *= 2; return slots; }();
+
+	uint32_t seeds[BUCKETS] = {};
+	uint32_t slots[SLOTS] = {};			//	entry + 1, 0 is empty
+
+	//	fixes has to stay where it is for as long as the table is looked up in, as the table only has indexes into it
+	constexpr HeaderTable(const HeaderFix* fixes) {
+
+		//	the entries sorted by bucket, so each bucket's entries are together
+		size_t bucketStart[BUCKETS + 1] = {};
+		size_t order[N + 1] = {};
+		for (size_t i = 0; i < N; i++)
+			bucketStart[(mixCRC(fixes[i].crc32, 0) % BUCKETS) + 1]++;
+		size_t largest = 0;
+		for (size_t i = 0; i < BUCKETS; i++) {
+
+			largest = (bucketStart[i + 1] > largest) ? bucketStart[i + 1] : largest;
+			bucketStart[i + 1] += bucketStart[i];
+
+		}
+		size_t filled[BUCKETS] = {};
+		for (size_t i = 0; i < N; i++) {
+
+			size_t bucket = mixCRC(fixes[i].crc32, 0) % BUCKETS;
+			order[bucketStart[bucket] + filled[bucket]++] = i;
+
+		}
+
+		//	a CRC in there twice would never find a seed, so say so instead
+		for (size_t bucket = 0; bucket < BUCKETS; bucket++) {
+
+			for (size_t i = bucketStart[bucket]; i < bucketStart[bucket + 1]; i++) {
+
+				for (size_t j = i + 1; j < bucketStart[bucket + 1]; j++) {
+
+					if (fixes[order[i]].crc32 == fixes[order[j]].crc32)
+						throw "HeaderDatabase.inc has the same CRC32 more than once";
+
+				}
+
+			}
+
+		}
+
+		for (size_t size = largest; size > 0; size--) {
+
+			for (size_t bucket = 0; bucket < BUCKETS; bucket++) {
+
+				size_t first = bucketStart[bucket], last = bucketStart[bucket + 1];
+				if (last - first != size)
+					continue;
+
+				for (uint32_t seed = 1;; seed++) {
+
+					size_t placed = first;
+					for (; placed < last; placed++) {
+
+						uint32_t& slot = this->slots[mixCRC(fixes[order[placed]].crc32, seed) & (SLOTS - 1)];
+						if (slot != 0)
+							break;
+						slot = (uint32_t)order[placed] + 1;
+
+					}
+
+					if (placed == last) {
+
+						this->seeds[bucket] = seed;
+						break;
+
+					}
+
+					//	take back what this seed placed before trying the next
+					while (placed-- > first)
+						this->slots[mixCRC(fixes[order[placed]].crc32, seed) & (SLOTS - 1)] = 0;
+
+				}
+
+			}
+
+		}
+
+	}
+
+	//	the fix for crc, out of the same fixes the table was built from, nullptr if there is none
+	constexpr const HeaderFix* find(const HeaderFix* fixes, uint32_t crc) const {
+
+		uint32_t seed = this->seeds[mixCRC(crc, 0) % BUCKETS];
+		uint32_t slot = this->slots[mixCRC(crc, seed) & (SLOTS - 1)];
+		if (slot == 0 || fixes[slot - 1].crc32 != crc)
+			return nullptr;
+		return &fixes[slot - 1];
+
+	}
+
+};
+
+/*
+the built in header database, dumps with headers known to be wrong are looked up by CRC32 and given the NES 2.0 header they should have had
+the table is a perfect hash built while compiling, so a lookup is one bucket and one slot, with nothing to parse or build at startup
+*/
+const HeaderFix* findHeaderFix(uint32_t crc);
+
+//	rewrites header as the NES 2.0 header fix describes, keeping its ROM sizes, trainer and console type
+void applyHeaderFix(romHeaderStruct& header, const HeaderFix& fix);
+
+#endif
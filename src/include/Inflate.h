@@ -0,0 +1,75 @@
+#ifndef INFLATE_H
+#define INFLATE_H
+
+#include <cinttypes>	//	(u)intx_t datatypes
+#include <cstddef>		//	size_t
+#include <vector>		//	std::vector
+
+/*
+DEFLATE(RFC 1951) decoding, for ROMs kept in .gz and .zip files, see RomArchive.h
+it is pulled from with read(), so the caller decides where everything goes and nothing is inflated before it is asked for
+only the last 32KB of output(as far back as DEFLATE can refer) is kept here, everything else is handed straight out
+damaged or truncated streams throw CartridgeException
+*/
+class InflateClass {
+
+public:
+	//	data is the raw DEFLATE stream, which has to outlive this
+	InflateClass(const uint8_t* _data, size_t _size);
+
+	//	inflates up to size bytes into out, returns how many there were, less than size only once the stream has ended
+	size_t read(uint8_t* out, size_t size);
+
+private:
+	//	canonical Huffman code, as in RFC 1951 3.2.2
+	//	codes up to FAST_BITS long are decoded with one lookup, fast holds (symbol << 4) | length, 0 for codes that are longer
+	static const uint8_t FAST_BITS = 10;
+	struct Huffman {
+
+		uint16_t fast[1 << FAST_BITS];
+		uint16_t counts[16];
+		uint16_t symbols[288];
+
+	};
+
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+	size_t position = 0;
+
+	//	bits are taken from the bottom, padBits is how many zeros were put on the top past the end of the stream
+	uint64_t bitBuffer = 0;
+	uint32_t bitCount = 0;
+	uint32_t padBits = 0;
+
+	//	the last 32KB of output, and room for the next 32KB, pending is how many of the newest have not been read yet
+	static const uint32_t WINDOW_SIZE = 0x10000;
+	std::vector<uint8_t> window;
+	uint32_t windowPosition = 0;
+	uint32_t pending = 0;
+	uint64_t total = 0;
+
+	//	where inflateSome left off, which may be in the middle of a block or a copy
+	bool inBlock = false;
+	bool lastBlock = false;
+	bool ended = false;
+	uint8_t blockType = 0;
+	uint32_t storedRemaining = 0;
+	uint32_t copyLength = 0;
+	uint32_t copyDistance = 0;
+	Huffman literals;
+	Huffman distances;
+
+	void refill();
+	uint32_t bits(uint8_t count);
+	uint16_t decode(const Huffman& huffman);
+	void build(Huffman& huffman, const uint8_t* lengths, uint16_t count);
+
+	void readBlockHeader();
+	void readDynamicTables();
+
+	//	inflates up to 32KB more into the window
+	void inflateSome();
+
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cinttypes>	//	(u)intx_t datatypes
+#include <cstddef>		//	size_t
+#include <string>		//	std::string
+
+/*
+a whole file mapped into memory, so ROMs are read straight out of the OS's page cache instead of being copied, and every instance loading the same file shares it
+nothing is meant to write to it(see RomSection), open() maps copy on write so that a stray write only changes this process' copy of that page, and never reaches the file
+*/
+class MappedFileClass {
+
+public:
+	MappedFileClass() {}
+	~MappedFileClass() { this->close(); }
+
+	//	the mapping belongs to exactly one owner
+	MappedFileClass(const MappedFileClass&) = delete;
+	MappedFileClass& operator=(const MappedFileClass&) = delete;
+
+	//	false if the file could not be opened or mapped, empty files cannot be mapped either
+	bool open(const std::string& filename);
+
+	void close();
+
+	uint8_t* data() { return this->view; }
+	size_t size() { return this->length; }
+	bool isOpen() { return this->view != nullptr; }
+
+private:
+	uint8_t* view = nullptr;
+	size_t length = 0;
+
+#ifdef _WIN32
+	//	the file mapping HANDLE, kept as void* so windows.h stays out of the header
+	void* mapping = nullptr;
+#endif
+
+};
+
+#endif
@@ -6,12 +6,14 @@
 #include ".\mappers\Mapper001.h"
 #include ".\mappers\Mapper002.h"
 #include ".\mappers\Mapper003.h"
+#include ".\mappers\Mapper004.h"
 
 
 #include ".\mappers\Mapper007.h"
 
 #include ".\custom_exceptions.h"
 
-MapperClass* selectMapper(romStruct* _rom);
+//	takes the ROM over, which is freed if there is no mapper for it
+std::unique_ptr<MapperClass> selectMapper(std::unique_ptr<romStruct> _rom);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,75 @@
+#ifndef NTSC_FILTER_H
+#define NTSC_FILTER_H
+
+#include <cinttypes>	//	(u)intx_t datatypes
+#include <vector>		//	std::vector
+
+#include ".\FrameSink.h"
+#include ".\WorkerPool.h"
+
+//	the composite signal has 8 samples per pixel, we decode one output pixel every 4 samples
+const uint32_t NTSC_OUTPUT_SCALE = 2;
+
+//	a single input pixel's samples fall into this many neighbouring output pixels
+const uint32_t NTSC_TAPS = 4;
+
+//	the color subcarrier is 12 samples long, and every pixel starts 8 samples after the previous one, so a pixel can only start on 3 phases
+const uint32_t NTSC_PHASES = 3;
+
+/*
+simulates the NES composite video signal and decodes it back into RGB, giving the color fringing and dot crawl of a real TV
+see: https://wiki.nesdev.com/w/index.php/NTSC_video
+the decode is linear in the signal, so what a single pixel(of each color, emphasis and phase) adds to its neighbouring output pixels is worked out once up front
+filtering a frame is then adding up NTSC_TAPS of those kernels per input pixel, with rows split up across a worker pool
+
+submitFrame hands the previous frame's result back through getOutput, which is at most 1 frame of latency
+*/
+class NtscFilterClass : public FrameSinkClass {
+
+public:
+	NtscFilterClass();
+	~NtscFilterClass() { this->wait(); }
+
+	//	rows are split up across this pool, which may be shared with other filters, without one they are filtered on the calling thread
+	void loadPool(WorkerPoolClass* _pool) { this->wait(); this->pool = _pool; }
+
+	void submitFrame(const FrameBuffer& frame) override;
+
+	//	the most recently finished frame, 4 bytes per pixel in R, G, B, A order
+	bool hasOutput() { return this->outputReady; }
+	const AlignedVector<uint32_t>& getOutput() { return this->output; }
+	uint32_t getWidth() { return this->outputWidth; }
+	uint32_t getHeight() { return this->outputHeight; }
+
+	//	throws away anything in flight, used when the filter is turned back on so a stale frame is not shown
+	void flush();
+
+private:
+	//	R, G, B and an unused lane per tap, so each tap is a single SIMD add
+	AlignedVector<float> kernels;
+	bool useSSE2 = false;
+
+	//	the frame being filtered, and where it is being filtered into
+	FrameBuffer input;
+	AlignedVector<uint32_t> working;
+	uint32_t workingWidth = 0, workingHeight = 0, workingPhase = 0;
+	bool workingStarted = false;
+
+	AlignedVector<uint32_t> output;
+	uint32_t outputWidth = 0, outputHeight = 0;
+	bool outputReady = false;
+
+	//	advances every frame, which is what makes the dots crawl
+	uint32_t framePhase = 0;
+
+	WorkerPoolClass* pool = nullptr;
+	void wait() { if (this->pool != nullptr) this->pool->wait(); }
+
+	void buildKernels();
+	void filterRows(uint32_t first, uint32_t last);
+
+	const float* kernel(uint16_t pixel, uint32_t phase) { return &this->kernels[(((size_t)pixel * NTSC_PHASES) + phase) * NTSC_TAPS * 4]; }
+
+};
+
+#endif
@@ -5,13 +5,13 @@
 #include <tuple>
 #include <vector>
 
-#include ".\SFML\Graphics.hpp"
-
-enum mirrorEnum : uint8_t;
+#include ".\FrameSink.h"
+#include ".\PixelCompose.h"
+#include ".\Region.h"
 
 class CartridgeClass;
 class CPUClass;
-class GUIClass;
+class TileCacheClass;
 
 struct Sprite {
 
@@ -28,8 +28,7 @@ struct SpriteContainer {
 
 	uint8_t id = 0;
 	Sprite data;
-	uint8_t dataH = 0;
-	uint8_t dataL = 0;
+	uint8_t pixels[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };	//	decoded row of the sprite for the current scanline, already flipped if needed
 
 };
 
@@ -85,15 +84,56 @@ enum STAT_BITMASKS : uint8_t {
 
 };
 
+//	what has been written since the debug viewers last looked(see PPUViewer.h), pattern tables are tracked by the mapper instead
+enum DIRTY_BITMASKS : uint8_t {
+
+	D_NAMETABLE = 0b00001111,	//	one bit per 1KB nametable slot(0x2000 to 0x2FFF), a write sets the bit of every slot showing the same memory
+	D_PALETTE = 0b00010000,
+	D_OAM = 0b00100000
+
+};
+
+//	PPUClass::dotsToA12Rise's answer when A12 will not rise without a write to the PPU first
+const uint64_t A12_NEVER = UINT64_MAX;
+
 enum SCANLINE_TYPES : uint8_t {
 
 	//	in order to properly handle what happens when in the scanlines, please follow this: https://wiki.nesdev.com/w/images/d/d1/Ntsc_timing.png
 
-	//	scanline timings are given in terms of NTSC, NOT PAL
-	PRE = 0b00000001,			//	(-1/261)	this is what happens before the visible frame is started, it is only 1 scanline: https://wiki.nesdev.com/w/index.php/PPU_rendering#Pre-render_scanline_.28-1_or_261.29
-	FRAME = 0b00000010,			//	(0-239)		this is the frame that is draw to the window: https://wiki.nesdev.com/w/index.php/PPU_rendering#Visible_scanlines_.280-239.29
-	POST = 0b00000100,			//	(240)		this is the scanline after the visible frame is handled: https://wiki.nesdev.com/w/index.php/PPU_rendering#Post-render_scanline_.28240.29
-	BLANK = 0b00001000			//	(240-260)	this is the vertical blanking that happens after the post scanline: https://wiki.nesdev.com/w/index.php/PPU_rendering#Post-render_scanline_.28240.29
+	//	scanline timings are given in terms of NTSC, see Region.h for where PAL and Dendy differ
+	//	these index the PPU's action table, so they must stay consecutive
+	PRE = 0,			//	(-1/261)	this is what happens before the visible frame is started, it is only 1 scanline: https://wiki.nesdev.com/w/index.php/PPU_rendering#Pre-render_scanline_.28-1_or_261.29
+	FRAME = 1,			//	(0-239)		this is the frame that is draw to the window: https://wiki.nesdev.com/w/index.php/PPU_rendering#Visible_scanlines_.280-239.29
+	POST = 2,			//	(240)		this is the scanline after the visible frame is handled: https://wiki.nesdev.com/w/index.php/PPU_rendering#Post-render_scanline_.28240.29
+	BLANK = 3,			//	(241)		the first scanline of vertical blanking, which sets the VBLANK flag: https://wiki.nesdev.com/w/index.php/PPU_rendering#Vertical_blanking_lines_.28241-260.29
+	IDLE = 4,			//	(242-260)	the rest of vertical blanking, where the PPU does nothing
+	SCANLINE_TYPE_COUNT = 5
+
+};
+
+//	everything the PPU can do on a single dot, a dot may do several of these, and they are always run in this order
+enum PPU_ACTIONS : uint32_t {
+
+	A_CLEAR_STATUS = 1 << 0,	//	clear VBLANK, sprite 0 hit and sprite overflow
+	A_CLEAR_OAM = 1 << 1,
+	A_EVAL_SPRITES = 1 << 2,
+	A_COMPOSE = 1 << 3,			//	compose the group of pixels that just ended, see PixelCompose.h
+	A_NT_ADDR = 1 << 4,
+	A_RELOAD = 1 << 5,			//	write the fetched tile into the background line
+	A_NT_FETCH = 1 << 6,
+	A_AT_ADDR = 1 << 7,
+	A_AT_FETCH = 1 << 8,
+	A_BG_ADDR = 1 << 9,
+	A_BG_FETCH = 1 << 10,
+	A_SCROLL_X = 1 << 11,
+	A_SCROLL_Y = 1 << 12,
+	A_UPDATE_X = 1 << 13,
+	A_UPDATE_Y = 1 << 14,
+	A_LOAD_SPRITES = 1 << 15,	//	also starts the next background line
+	A_SET_VBLANK = 1 << 16,
+	A_SUBMIT_FRAME = 1 << 17,
+	A_SKIP_DOT = 1 << 18,		//	NTSC skips the last dot of the pre-render scanline on odd frames
+	A_WATCH_A12 = 1 << 19		//	a sprite or first background pattern fetch, only in the table for mappers that watch A12, see Mapper.h
 
 };
 
@@ -135,13 +175,15 @@ public:
 	//	used to store components needed to communicate with
 	void loadCartridge(CartridgeClass* _cartridge) { this->cartridge = _cartridge; }
 	void loadCPU(CPUClass* _CPU) { this->CPU = _CPU; }
-	void loadGUI(GUIClass* _GUI) { this->GUI = _GUI; }		//	we only need the GUIClass to give SDL2 the new frame to draw
+	void loadFrameSink(FrameSinkClass* _sink) { this->sink = _sink; }		//	whoever receives the completed frames, may be nullptr to run without a display
 
 	std::tuple<uint32_t, uint32_t> getResolution();
 	uint32_t getTVFrameRate();
 
 	void reset();
-	void cycle();
+
+	//	runs a single dot, the region is picked by the CPU when the ROM is loaded(see Region.h)
+	template<tvEnum tv> void cycle();
 
 	void* get_ppu_regs() { return (void*)&this->registers; }
 	size_t get_ppu_regs_size() { return sizeof(this->registers); }
@@ -159,6 +201,17 @@ public:
 	void* get_ppu_secondary_oam() { return (void*)(&this->secondaryOAM); }
 	size_t get_ppu_oam_reg_size() { return (sizeof(SpriteContainer) * 8); }
 
+	//	for anything that writes PPU memory from outside through the accessors above(see GUIClass::hotReload), so sprites and the debug views are rebuilt from it
+	void invalidate() { this->spritesDirty = true; this->dirty = 0xFF; }
+
+	//	used by the debug viewers, none of these have side effects
+	uint8_t takeDirty() { uint8_t changed = this->dirty; this->dirty = 0; return changed; }
+	const uint8_t* getNametableSlot(uint8_t slot) { return (this->nametableSlots != nullptr) ? this->nametableSlots[slot & 0x03] : nullptr; }
+	uint8_t getPalette(uint8_t index) { return this->palettes.at(index & 0x1F); }
+	uint8_t getOAM(uint8_t index) { return this->OAM.at(index); }
+	uint8_t getCTRL() { return this->registers.CTRL; }
+	std::tuple<uint32_t, uint32_t> getScroll();
+
 	//	function pointers for GUI access to CPU data
 	typedef void* (PPUClass::* getPPUData)(void);
 	typedef size_t(PPUClass::* getPPUDataSize)(void);
@@ -167,47 +220,66 @@ public:
 	typedef size_t(PPUClass::* getPPUDataSize)(void);
 
 protected:
+	//	runs the PPU on its own thread, reading and redirecting what it needs(see PPUPipeline.h)
+	friend class PPUPipelineClass;
+
 	//	registers within the PPU
 	PPU_Registers registers;
 
 	//	this is used for drawing to the screen, every time a ROM is loaded, we must change the size of this
-	sf::Image pixels;
+	FrameBuffer frame;
 
 	//	used to determine what scanline we are currently on
 	int16_t scanline = -1;
 	int16_t scanlinePixel = 0; // The pixel within the scanline
 
-	// Nametable storage
+	// Nametable storage(CIRAM), the cartridge decides which parts of it are seen where, see Mapper.h
 	std::vector<uint8_t> nametables;
 
+	//	the 4 1KB slots for 0x2000 to 0x2FFF, owned by the mapper and repointed whenever it changes mirroring
+	uint8_t* const* nametableSlots = nullptr;
+
+	//	the mapper's decoded pattern tables, every background and sprite fetch goes through here
+	TileCacheClass* tiles = nullptr;
+
 	//	the actual palette storage for the PPU
 	std::vector<uint8_t> palettes;
 
-	//	this follows directly with RGBA32(NOT ARGB32) which SFML uses
-	uint32_t paletteColors[64] = { 0x666666FF, 0x002A88FF, 0x1412A7FF, 0x3B00A4FF, 0x5C007EFF, 0x6E0040FF, 0x6C0600FF, 0x561D00FF,
-									0x333500FF, 0x0B4800FF, 0x005200FF, 0x004F08FF, 0x00404DFF, 0x000000FF, 0x000000FF, 0x000000FF,
-									0xADADADFF, 0x155FD9FF, 0x4240FFFF, 0x7527FEFF, 0xA01ACCFF, 0xB71E7BFF, 0xB53120FF, 0x994E00FF,
-									0x6b6d00FF, 0x388700FF, 0x0c9300FF, 0x008F32FF, 0x007C8DFF, 0x000000FF, 0x000000FF, 0x000000FF,
-									0xFFFEFFFF, 0x64B0FFFF, 0x9290FFFF, 0xC676FFFF, 0xF36AFFFF, 0xFE6ECCFF, 0xFE8170FF, 0xEA9E22FF,
-									0xBCBE00FF, 0x88D800FF, 0x5CE430FF, 0x45E082FF, 0x48CDDEFF, 0x4F4F4FFF, 0x000000FF, 0x000000FF,
-									0xFFFEFFFF, 0xC0DFFFFF, 0xd3D2FFFF, 0xE8C8FFFF, 0xFBC2FFFF, 0xFEC4EAFF, 0xFECCC5FF, 0xF7D8A5FF,
-									0xE4E594FF, 0xCFEF96FF, 0xBDf4ABFF, 0xB3F3CCFF, 0xB5EBF2FF, 0xB8B8B8FF, 0x000000FF, 0x000000FF };
-	
 	//	for OAM data, please see: https://wiki.nesdev.com/w/index.php/PPU_OAM#Internal_operation
 	//	in short, the secondary is filled by the OAM, which in turn initializes 8 internal sprite outputs
 	std::vector<uint8_t> OAM;
 	SpriteContainer primaryOAM[8];
 	SpriteContainer secondaryOAM[8];
 
+	//	OAM usually only changes once a frame(by DMA), so instead of checking all 64 sprites every scanline they are sorted by the scanlines they cover
+	//	each bucket holds the first 8 sprites on that scanline in OAM order, the count keeps going so crowded scanlines can be told apart
+	//	rebuilt by evaluate_sprites whenever OAM has been written or the sprite height has changed since
+	uint8_t spriteBuckets[VISIBLE_SCANLINES][8];
+	uint8_t spriteBucketCounts[VISIBLE_SCANLINES] = { 0 };
+	uint32_t spriteBucketHeight = 0;
+	bool spritesDirty = true;
+
 	//	Loopy's V and T addresses
 	Address vAddr, tAddr;
 
-	//	latches
-	uint8_t NT = 0, AT = 0, BGL = 0, BGH = 0;
-	bool ATLatchL = false, ATLatchH = false;
+	//	latches, BG holds both pattern planes already decoded into 2 bit pixels(see TileCache.h)
+	uint8_t NT = 0, AT = 0;
+	uint16_t BG = 0;
+
+	//	instead of shifting the background out one pixel at a time, every tile is written out here when it would have been loaded into the shift registers
+	//	the 2 prefetched tiles land at 0 to 15, so screen pixel x is found at bgLine[x + fineX], and the tile loaded at dot 257 ends the line
+	uint8_t bgLine[272] = { 0 };
+	uint32_t bgFill = 0;
 
-	//	shift registers
-	uint16_t atShiftL = 0, atShiftH = 0, bgShiftL = 0, bgShiftH = 0;
+	//	how many pixels of the current scanline have been composed, see composeGroup
+	int32_t composed = 0;
+
+	//	the sprites of the next scanline, rendered once by load_sprites as SPRITE_PIXEL_BITMASKS(see PixelCompose.h), so screen pixel x is spriteLine[x]
+	//	sprites can start as far right as x == 255, the extra 8 bytes let them be written out without clipping
+	uint8_t spriteLine[264] = { 0 };
+
+	//	composes a group of background and sprite pixels, picked at runtime for the CPU we are running on(see PixelCompose.h)
+	composeKernel compose = composeScalar;
 
 	//	latch for determining if has been an register access already
 	bool latch = false;
@@ -218,26 +290,57 @@ protected:
 	//	Loopy's fineX
 	uint8_t fineX = 0;
 
+	//	applied to every palette value, only changes on MASK writes: 0x30 when greyscale is set, 0xFF otherwise
+	uint8_t greyMask = 0xFF;
+
 	bool isOddFrame = false;
 
+	//	DIRTY_BITMASKS, everything starts out dirty so the viewers draw it all once
+	uint8_t dirty = 0xFF;
+
 	//	we need to store the cartridge for CHR reading
 	CartridgeClass* cartridge = nullptr;
 	CPUClass* CPU = nullptr;
-	GUIClass* GUI = nullptr;
-
-	//	store the resolution of the image displayed(NTSC, PAL)
-	uint32_t tvResolutionX[2] = { 256, 256 };
-	uint32_t tvResolutionY[2] = { 240, 288 };
-	uint32_t tvFrameRate[2] = { 60, 50 };		//	it does 1/2 frames at Xfps, but full frame is X/2fps
+	FrameSinkClass* sink = nullptr;
 
 	//	used to access Cartridge or RAM
 	uint8_t access(uint16_t addr, uint8_t data = 0, bool isWrite = false);
 
-	// Scanlines
-	void pre_scanline();	// scanline -1
-	void frame_scanline();	// scanline 0 through 239
-	void post_scanline();	// scanline 240 
-	void blank_scanline();	// scanline 241 through 260
+	/*
+	instead of working out what to do from the scanline and dot every time, it is looked up in this table
+	scanlineTypes gives the SCANLINE_TYPES of each scanline(offset by 1 for the pre-render scanline), and dotActions the PPU_ACTIONS for each of its dots
+	both are built by reset(), since the scanlines differ between regions
+	*/
+	uint8_t scanlineTypes[313];
+	uint32_t dotActions[SCANLINE_TYPES::SCANLINE_TYPE_COUNT][341];
+
+	//	address latched by the _ADDR actions, used by the following _FETCH action
+	uint16_t fetchAddress = 0;
+
+	void buildActionTable(tvEnum tv);
+
+	//	MASK's 3 emphasis bits to the F_EMPHASIS bits of a frame pixel, which are always red, green, blue, so PAL's swapped bits are sorted out here once
+	//	built by reset() along with the action table
+	uint16_t emphasisBits[8] = { 0 };
+	void buildEmphasisTable(tvEnum tv);
+	void runActions(uint32_t actions);
+
+	/*
+	A12 is the pattern table half of the current fetch, which MMC3 style mappers count rises of
+	rather than follow the address bus every dot, A12 is only worked out at the fetches that can change it for long enough to count:
+	the 8 sprite fetches from dot 261, and the first background fetch of the next line at dot 325
+	the nametable fetches in between are too short for the mapper to see, so A12 is taken to stay where the last pattern fetch left it
+	*/
+	bool watchA12 = false;
+	bool a12 = false;
+	void watch_a12();
+
+	//	outside of rendering the address bus holds v instead, so PPUADDR writes and PPUDATA accesses move A12 too, which some games clock the counter with by hand
+	void follow_a12();
+
+	//	for the pipelined PPU(see PPUPipeline.h): how many dots can run from here before watch_a12 might next clock the mapper, if nothing is written to the PPU in between,
+	//	A12_NEVER if it will not, never late, but early where the PPU cannot know yet(8x16 sprites on scanlines that have not been evaluated)
+	uint64_t dotsToA12Rise(int16_t lastScanline);
 
 	bool rendering() { return ((this->registers.MASK & MASK_BITMASKS::BG_ENABLE) || (this->registers.MASK & MASK_BITMASKS::S_ENABLE)); }
 	uint32_t sprite_height() { return (this->registers.CTRL & CTRL_BITMASKS::S_HEIGHT) ? 16 : 8; }
@@ -266,11 +369,17 @@ protected:
 
 	void clear_oam();
 	void evaluate_sprites();
+	void scan_sprites();
+	void bucket_sprites();
 	void load_sprites();
 
-	void pixelDraw();
+	//	pixels are composed a group at a time once the group's last pixel is drawn, but STAT reads and MASK, fine X and palette writes in the middle of a group
+	//	compose the pixels already drawn first(composeDrawn), so sprite 0 hit is seen from the dot it happens on, and the writes change the picture from the pixel they land on
+	void composeGroup(int32_t x, uint32_t count);
+	void composeUpTo(int32_t end);
+	void composeDrawn();
 
-	uint16_t addressMirrorAdjust(uint16_t addr);
+	uint8_t& nametable(uint16_t addr) { return this->nametableSlots[(addr >> 10) & 0x03][addr & 0x03FF]; }
 
 	// Change Register Values
 	void SetRegisterBits(uint8_t &ppuRegister, uint8_t ppuBitmask);
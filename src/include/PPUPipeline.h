@@ -0,0 +1,151 @@
+#ifndef PPU_PIPELINE_H
+#define PPU_PIPELINE_H
+
+#include <cinttypes>	//	(u)intx_t datatypes
+#include <vector>		//	std::vector
+#include <atomic>		//	std::atomic
+#include <thread>		//	std::thread
+
+#include ".\PPU.h"
+#include ".\FrameSink.h"
+#include ".\Region.h"
+#include ".\mappers\Mapper.h"
+
+class CPUClass;
+
+//	how many register writes the CPU can get ahead of the PPU by, an OAM DMA alone is 256
+const uint32_t PIPELINE_LOG_SIZE = 4096;
+
+//	the CPU only tells the PPU thread how far it may run every this many dots(a few instructions), rather than every cycle
+//	anything that waits on the PPU publishes first, so this only decides how far behind the PPU may trail
+const uint32_t PIPELINE_PUBLISH_DOTS = 64;
+
+//	the two threads' variables are kept on cache lines of their own, so neither one's writes keep taking the line away from the other
+const size_t PIPELINE_CACHE_LINE = 64;
+
+//	a single PPU register access, or a change a mapper register write made to what the PPU sees, stamped with the number of PPU dots that had run when the CPU made it
+struct PipelineEntry {
+
+	uint64_t time = 0;
+	uint16_t address = 0;
+	uint8_t data = 0;
+	bool isRead = false;
+	bool isMapper = false;							//	change holds the mapper's change, and the rest is unused
+	MapperPpuChange change;
+
+};
+
+/*
+runs the PPU on its own thread, behind the CPU, instead of in lockstep with it inside CPUClass::cycle
+the CPU only moves the time the PPU is allowed to run up to, and stamps every PPU register write with that time into a single producer/single consumer log
+the PPU thread applies each write right after the dot it was stamped with, which is exactly when lockstep would have, so the picture is identical
+
+the CPU only has to wait for the PPU to catch up(sync) when it needs something only rendering can tell it:
+	NMI: the dot vblank starts on is fixed once the PPU is past the pre-render scanline, the PPU publishes it and the CPU raises NMI itself from its own copy of CTRL
+	IRQ: mappers that count A12 rises(MMC3) raise their IRQ from the PPU's fetches, so the PPU works out the earliest dot A12 could next rise on(PPUClass::dotsToA12Rise),
+		and the CPU waits for the PPU there, which is before the CPU could see the IRQ in lockstep, then asks again
+		PPUCTRL/PPUMASK change which table is fetched from and PPUADDR/PPUDATA move A12 themselves(PPUClass::follow_a12), so those writes wait for the PPU too, but only for those mappers
+	STAT: the vblank flag is known from the timing, and sprite 0 hit/overflow can no longer change once vblank has started, so STAT reads during vblank only wait for the PPU to reach vblank
+		while rendering, sprite 0 hit/overflow only ever get set, so flags the PPU has already reported for this frame are answered straight away,
+		anything else only waits for the PPU to reach the CPU(a loop polling for sprite 0 hit still follows the PPU until it is set, which no amount of threading can avoid)
+	write only registers: just return the open bus value, which the CPU tracks itself
+	mapper writes: the CHR banks and mirroring they switch are logged like register writes(see MapperClass::deferPpuChanges), so they only wait when the mapper counts A12 rises,
+		as its IRQ counter is then clocked from the PPU thread
+	everything else(OAMDATA/PPUDATA reads): wait for the PPU to reach the CPU and apply everything logged
+frames the PPU finishes are held onto and handed to the real frame sink at the end of CPUClass::runFrame, on the CPU's thread
+*/
+class PPUPipelineClass : public FrameSinkClass, public MapperDeferralClass {
+
+public:
+	PPUPipelineClass(CPUClass* _CPU, PPUClass* _PPU);
+	~PPUPipelineClass();
+
+	//	called at the start and end of CPUClass::runFrame, nothing else may touch the PPU in between
+	void begin(tvEnum tv);
+	void finish();
+
+	//	called every CPU cycle with however many dots it is worth
+	void advance(uint32_t dots) {
+
+		this->now += dots;
+		if (this->now - this->publishedTarget >= PIPELINE_PUBLISH_DOTS)
+			this->publish();
+		if (this->now >= this->nextVBlank)
+			this->checkVBlank();
+		if (this->now >= this->nextA12)
+			this->syncA12();
+
+	}
+
+	uint8_t access(uint16_t address, uint8_t data, bool isWrite);
+
+	//	waits until the PPU has caught up to the CPU, after which it is safe to touch anything the PPU uses
+	void sync();
+
+	//	called before the CPU writes a mapper register, only mappers sharing their IRQ counter with the PPU thread need it to catch up
+	void mapperWrite() { if (this->watchA12) this->sync(); }
+
+	//	called on the CPU's thread, by the mapper a register write was made to
+	void deferPpuChange(const MapperPpuChange& change) override;
+
+	//	called on the PPU thread
+	void submitFrame(const FrameBuffer& frame) override;
+
+private:
+	CPUClass* CPU = nullptr;
+	PPUClass* PPU = nullptr;
+
+	//	where the PPU used to send its NMIs and frames, put back when the pipeline is removed
+	CPUClass* savedCPU = nullptr;
+	FrameSinkClass* savedSink = nullptr;
+
+	std::thread thread;
+	std::atomic<bool> stopping = { false };
+	void (PPUClass::* dot)() = &PPUClass::cycle<tvEnum::NTSC>;
+	int16_t vblankScanline = RegionTiming<tvEnum::NTSC>::VBLANK_SCANLINE;
+	int16_t lastScanline = RegionTiming<tvEnum::NTSC>::LAST_SCANLINE;
+
+	std::vector<PipelineEntry> log;
+
+	//	the CPU's own, changed every cycle and never looked at by the PPU thread
+	alignas(PIPELINE_CACHE_LINE) uint64_t now = 0;		//	dots the CPU has allowed
+	uint64_t publishedTarget = 0;						//	what target was last set to
+	uint32_t head = 0;									//	how far the log has been filled
+	uint64_t nextVBlank = 0;							//	the exact time of the next vblank once it is known, otherwise the earliest it could be
+	uint64_t lastVBlank = 0;
+	uint64_t vblankEnds = 0;							//	vblank is [lastVBlank, vblankEnds), STAT can be answered without rendering in there
+	bool vblankFlag = false;
+	bool watchA12 = false;
+	uint64_t nextA12 = A12_NEVER;						//	the earliest time A12 could rise, the PPU has to be there for the CPU to see the mapper's IRQ
+	uint8_t CTRL = 0;
+	uint8_t openBus = 0;
+
+	//	written by the CPU for the PPU thread, every PIPELINE_PUBLISH_DOTS and whenever it logs an access
+	alignas(PIPELINE_CACHE_LINE) std::atomic<uint64_t> target = { 0 };
+	std::atomic<uint32_t> published = { 0 };
+
+	//	written by the PPU thread: dots it has run, how far it has read the log, the time the next vblank starts at, sprite 0 hit/overflow as they were when it did,
+	//	and as they were when it last stopped(the time it stopped above the low 8 bits, so the two are always read together)
+	alignas(PIPELINE_CACHE_LINE) std::atomic<uint64_t> ran = { 0 };
+	std::atomic<uint32_t> consumed = { 0 };
+	std::atomic<uint64_t> vblankAt = { 0 };
+	std::atomic<uint8_t> frameFlags = { 0 };
+	std::atomic<uint64_t> flagsAt = { 0 };
+	std::atomic<uint64_t> status = { 0 };
+
+	//	the most recent frame the PPU finished
+	alignas(PIPELINE_CACHE_LINE) FrameBuffer frame;
+	std::atomic<bool> frameReady = { false };
+
+	void run();
+	void publish() { this->publishedTarget = this->now; this->target.store(this->now, std::memory_order_release); }
+	PipelineEntry& claim();
+	void push(uint16_t address, uint8_t data, bool isRead);
+	void checkVBlank();
+	void predictA12();
+	void syncA12() { this->sync(); this->predictA12(); }
+	uint8_t readStatus(uint16_t address);
+
+};
+
+#endif
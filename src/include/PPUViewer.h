@@ -0,0 +1,71 @@
+#ifndef PPU_VIEWER_H
+#define PPU_VIEWER_H
+
+#include <cinttypes>	//	(u)intx_t datatypes
+#include <vector>		//	std::vector
+
+#include ".\SFML\Graphics.hpp"
+
+#include ".\PPU.h"
+#include ".\Cartridge.h"
+#include ".\Palette.h"
+
+/*
+graphical views of the pattern tables, nametables and sprites, decoded from the same memory the PPU renders from
+decoding all of them every GUI frame would cost about as much as rendering another frame, so update() collects what has been written since the last GUI frame
+(see DIRTY_BITMASKS in PPU.h and TileCacheClass::takeDirty), and each view only re-decodes and uploads the parts of it that changed
+views that are closed keep collecting, so they catch up in one go once they are opened again
+*/
+class PPUViewerClass {
+
+public:
+	void loadPPU(PPUClass* _PPU) { this->PPU = _PPU; }
+	void loadCartridge(CartridgeClass* _cartridge) { this->cartridge = _cartridge; }
+	void loadPalette(PaletteClass* _palette) { this->palette = _palette; }
+
+	//	called once per GUI frame, before any of the views are drawn
+	void update();
+
+	//	redraws everything, used when the colors themselves change(a palette file was loaded)
+	void invalidate();
+
+	void drawPatternTables(bool* open);
+	void drawNametables(bool* open);
+	void drawSprites(bool* open);
+
+private:
+	PPUClass* PPU = nullptr;
+	CartridgeClass* cartridge = nullptr;
+	PaletteClass* palette = nullptr;
+
+	//	palette RAM turned into colors, refreshed before anything is decoded
+	uint32_t colors[32] = { 0 };
+
+	//	both pattern tables stacked, 0x0000 on top, so every 1KB(4 rows of 16 tiles) is one contiguous band of pixels
+	sf::Texture patternTexture;
+	std::vector<uint32_t> patternPixels;
+	uint8_t patternPending = 0xFF;
+	int patternPalette = 0;
+
+	//	the 4 nametables, each stored contiguously so they can be uploaded on their own
+	sf::Texture nametableTexture;
+	std::vector<uint32_t> nametablePixels;
+	uint8_t nametablePending = DIRTY_BITMASKS::D_NAMETABLE;
+	const uint8_t* nametableSlots[4] = { nullptr, nullptr, nullptr, nullptr };
+	uint8_t nametablePatterns = 0;
+	bool showScroll = true;
+
+	//	all 64 sprites, 8 to a row, each in an 8x16 cell
+	sf::Texture spriteTexture;
+	std::vector<uint32_t> spritePixels;
+	bool spritesPending = true;
+	uint8_t spriteCTRL = 0;
+
+	void loadColors();
+
+	//	decodes the tile at address into pixels, attributes are the sprite attributes(only the flip bits are used), pixel 0 gets backdrop
+	void drawTile(uint16_t address, uint8_t attributes, uint8_t palette, uint32_t backdrop, uint32_t* pixels, uint32_t stride);
+
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef PALETTE_H
+#define PALETTE_H
+
+#include <cinttypes>	//	(u)intx_t datatypes
+#include <string>		//	std::string
+#include <vector>		//	std::vector
+
+#include ".\FrameSink.h"
+
+//	64 master palette colors for each of the 8 combinations of the MASK emphasis bits, which is exactly what a FrameBuffer pixel can index
+const uint32_t PALETTE_LUT_SIZE = 512;
+
+/*
+turns FrameBuffer pixels into colors, see: https://wiki.nesdev.com/w/index.php/PPU_palettes
+every entry is already in R, G, B, A byte order, so a converted frame can be handed straight to SFML
+the table can be replaced with a .pal file, either 64 colors(192 bytes, emphasis is generated) or all 512(1536 bytes)
+*/
+class PaletteClass {
+
+public:
+	PaletteClass();
+
+	//	returns false and keeps the current colors if the file could not be used
+	bool load(std::string fileName);
+	void loadDefault();
+
+	//	converts the whole frame in one pass, output receives 4 bytes per pixel
+	void convert(const FrameBuffer& frame, AlignedVector<uint32_t>& output);
+
+	const uint32_t* getTable() { return this->table; }
+
+private:
+	alignas(SIMD_ALIGNMENT) uint32_t table[PALETTE_LUT_SIZE];
+
+	//	checked once, whether convert can use AVX2 gathers
+	bool useAVX2 = false;
+
+	//	colors holds 64 * 3 bytes, generates the 7 emphasized copies of them
+	void generate(const uint8_t* colors);
+
+	//	colors holds 512 * 3 bytes
+	void fill(const uint8_t* colors);
+
+};
+
+#endif
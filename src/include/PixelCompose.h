@@ -0,0 +1,39 @@
+#ifndef PIXEL_COMPOSE_H
+#define PIXEL_COMPOSE_H
+
+#include <cinttypes>	//	(u)intx_t datatypes
+
+//	the PPU composes this many pixels at a time, one tile's worth
+const uint32_t COMPOSE_GROUP_SIZE = 8;
+
+//	layout of a single sprite pixel handed to the compose kernels
+enum SPRITE_PIXEL_BITMASKS : uint8_t {
+
+	S_PIXEL = 0b00000011,		//	2 bit color index of the sprite's pattern, 0 = transparent
+	S_PALETTE = 0b00001100,		//	which of the 4 sprite palettes to use
+	S_BEHIND = 0b00100000,		//	sprite is drawn behind opaque background pixels(attribute bit 5)
+	S_ZERO = 0b01000000			//	pixel belongs to sprite 0, used for sprite 0 hit detection
+
+};
+
+/*
+composes COMPOSE_GROUP_SIZE pixels at once: background vs. sprite priority, sprite 0 hit and the palette RAM lookup
+	background:	palette RAM index(0 to 15) for each pixel, 0 when the background pixel is transparent
+	sprites:	one SPRITE_PIXEL_BITMASKS byte per pixel, 0 when no sprite is present
+	bgMask, spriteMask:	0xFF per pixel that is allowed to show(used for MASK enable and left column bits), 0x00 otherwise
+	hitMask:	0xFF per pixel where sprite 0 hit may be detected(hardware never detects it at x == 255)
+	palettes:	the 32 bytes of palette RAM
+	greyMask:	0x30 when MASK greyscale is set, 0xFF otherwise
+	output:	receives the palette RAM value for each pixel
+returns the index of the first pixel sprite 0 hit occurred on, COMPOSE_GROUP_SIZE when it did not occur within the group, so the PPU can set it on the dot it happens
+*/
+typedef uint32_t (*composeKernel)(const uint8_t* background, const uint8_t* sprites, uint64_t bgMask, uint64_t spriteMask, uint64_t hitMask,
+	const uint8_t* palettes, uint8_t greyMask, uint8_t* output);
+
+uint32_t composeScalar(const uint8_t* background, const uint8_t* sprites, uint64_t bgMask, uint64_t spriteMask, uint64_t hitMask,
+	const uint8_t* palettes, uint8_t greyMask, uint8_t* output);
+
+//	checks the CPU features at runtime and returns the fastest kernel available
+composeKernel selectComposeKernel();
+
+#endif
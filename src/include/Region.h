@@ -0,0 +1,95 @@
+#ifndef REGION_H
+#define REGION_H
+
+#include <cinttypes>	//	(u)intx_t datatypes
+
+#include ".\RomStruct.h"
+
+//	every region draws the same visible picture, only the length of vblank and the clock ratios differ
+const uint32_t VISIBLE_WIDTH = 256;
+const uint32_t VISIBLE_SCANLINES = 240;
+
+/*
+timing differences between the consoles, see: https://wiki.nesdev.com/w/index.php/Cycle_reference_chart and https://wiki.nesdev.com/w/index.php/Clock_rate
+the CPU and PPU are both divided down from the same master clock, so instead of counting PPU dots per CPU cycle(PAL's is 3.2)
+the CPU adds its divider to a running count every cycle, and the PPU runs a dot for every PPU divider that fits in it
+these are template parameters of the CPU and PPU cycle functions, which are picked once when the ROM is loaded
+*/
+template<tvEnum tv> struct RegionTiming;
+
+template<> struct RegionTiming<tvEnum::NTSC> {
+
+	static const uint32_t CPU_DIVIDER = 12;
+	static const uint32_t PPU_DIVIDER = 4;
+	static const int16_t LAST_SCANLINE = 260;		//	scanlines run from -1(pre-render) to this
+	static const int16_t VBLANK_SCANLINE = 241;
+	static const uint32_t FRAME_CYCLES = 29781;
+	static const uint32_t FRAME_RATE = 60;
+	static const bool SWAPPED_EMPHASIS = false;		//	MASK bit 5 emphasizes red and bit 6 green
+
+};
+
+template<> struct RegionTiming<tvEnum::PAL> {
+
+	static const uint32_t CPU_DIVIDER = 16;
+	static const uint32_t PPU_DIVIDER = 5;
+	static const int16_t LAST_SCANLINE = 310;
+	static const int16_t VBLANK_SCANLINE = 241;
+	static const uint32_t FRAME_CYCLES = 33248;
+	static const uint32_t FRAME_RATE = 50;
+	static const bool SWAPPED_EMPHASIS = true;		//	the 2C07 has red and green the other way around
+
+};
+
+//	Dendy uses PAL's frame length, but with NTSC's CPU to PPU ratio, and holds off vblank by 50 scanlines
+template<> struct RegionTiming<tvEnum::DENDY> {
+
+	static const uint32_t CPU_DIVIDER = 15;
+	static const uint32_t PPU_DIVIDER = 5;
+	static const int16_t LAST_SCANLINE = 310;
+	static const int16_t VBLANK_SCANLINE = 291;
+	static const uint32_t FRAME_CYCLES = 35464;
+	static const uint32_t FRAME_RATE = 50;
+	static const bool SWAPPED_EMPHASIS = true;		//	Dendy clones use a PAL style PPU here too
+
+};
+
+//	for the few places that only need to know once, and not every cycle
+inline uint32_t regionFrameCycles(tvEnum tv) {
+
+	switch (tv) {
+
+	case tvEnum::PAL: return RegionTiming<tvEnum::PAL>::FRAME_CYCLES;
+	case tvEnum::DENDY: return RegionTiming<tvEnum::DENDY>::FRAME_CYCLES;
+	default: return RegionTiming<tvEnum::NTSC>::FRAME_CYCLES;
+
+	}
+
+}
+
+inline uint32_t regionFrameRate(tvEnum tv) {
+
+	switch (tv) {
+
+	case tvEnum::PAL: return RegionTiming<tvEnum::PAL>::FRAME_RATE;
+	case tvEnum::DENDY: return RegionTiming<tvEnum::DENDY>::FRAME_RATE;
+	default: return RegionTiming<tvEnum::NTSC>::FRAME_RATE;
+
+	}
+
+}
+
+//	whether MASK bits 5 and 6 are green and red instead of red and green, see: https://wiki.nesdev.com/w/index.php/PPU_registers#Color_effects
+inline bool regionSwapsEmphasis(tvEnum tv) {
+
+	switch (tv) {
+
+	case tvEnum::PAL: return RegionTiming<tvEnum::PAL>::SWAPPED_EMPHASIS;
+	case tvEnum::DENDY: return RegionTiming<tvEnum::DENDY>::SWAPPED_EMPHASIS;
+	default: return RegionTiming<tvEnum::NTSC>::SWAPPED_EMPHASIS;
+
+	}
+
+}
+
+#endif
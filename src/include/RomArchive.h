@@ -0,0 +1,28 @@
+#ifndef ROM_ARCHIVE_H
+#define ROM_ARCHIVE_H
+
+#include <cinttypes>	//	(u)intx_t datatypes
+#include <cstddef>		//	size_t
+#include <string>		//	std::string
+
+//	where a ROM is inside a .gz or .zip file, found without inflating any of it
+struct RomArchiveEntry {
+
+	size_t offset = 0;						//	where its data starts in the archive
+	size_t packedSize = 0;
+	size_t size = 0;						//	once inflated, as the archive says
+	uint32_t crc32 = 0;						//	of the inflated ROM, as the archive says
+	bool deflated = false;					//	otherwise it is stored as it is, and can be used straight out of the archive
+
+};
+
+/*
+gzip files(RFC 1952) hold one file, zip files hold any number of them and the first one named *.nes is used
+false if data is neither, throws CartridgeException if it is one but has no ROM in it that can be read
+*/
+bool findArchivedRom(const uint8_t* data, size_t size, RomArchiveEntry& entry);
+
+//	whether filename is named like something findArchivedRom would look in, for anything that lists ROMs by name
+bool isRomArchiveName(const std::string& filename);
+
+#endif
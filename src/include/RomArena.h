@@ -0,0 +1,42 @@
+#ifndef ROM_ARENA_H
+#define ROM_ARENA_H
+
+#include <cinttypes>	//	(u)intx_t datatypes
+#include <cstddef>		//	size_t
+
+/*
+everything a ROM needs memory of its own for, as one allocation: PRG RAM, CHR RAM, an inflated or copied ROM image, and the rest of a file too short for what its header says
+regions are laid out with reserve() first, each starting on a cache line, then allocated together, zero filled, so their offsets never change
+PRG and CHR ROM are not in here, they are shared by every instance of the ROM(see RomImage.h), so this is only ever a few KB besides an image, and normal pages do
+*/
+class RomArenaClass {
+
+public:
+	RomArenaClass() {}
+	~RomArenaClass() { this->release(); }
+
+	//	the memory belongs to exactly one owner
+	RomArenaClass(const RomArenaClass&) = delete;
+	RomArenaClass& operator=(const RomArenaClass&) = delete;
+
+	//	lays out size bytes after everything reserved so far, and returns where they will start, only before allocate()
+	size_t reserve(size_t size);
+
+	//	false if the OS would not give us the memory
+	bool allocate();
+
+	//	frees the memory and forgets the layout, so it can be laid out again
+	void release();
+
+	uint8_t* at(size_t offset) { return this->memory + offset; }
+	size_t size() { return this->length; }
+
+private:
+	static const size_t REGION_ALIGNMENT = 64;
+
+	uint8_t* memory = nullptr;
+	size_t length = 0;						//	everything reserved
+
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef ROM_IMAGE_H
+#define ROM_IMAGE_H
+
+#include <cinttypes>	//	(u)intx_t datatypes
+#include <string>		//	std::string
+#include <memory>		//	std::shared_ptr
+#include <filesystem>	//	std::filesystem::file_time_type
+
+#include ".\MappedFile.h"
+#include ".\RomArena.h"
+
+/*
+the contents of a ROM file, as read-only data shared by every romStruct loaded from that file in this process
+uncompressed ROMs(and ROMs stored uncompressed in a zip) are the mapped file itself, compressed ROMs are inflated once into an arena of their own
+a mapped file cannot be rebuilt while it is mapped(Windows refuses to, and Linux faults on pages cut off the end of it), so a ROM being watched for rebuilds is opened as a copy instead
+anything an instance can change(PRG RAM, CHR RAM, bank registers) lives in its romStruct and mapper instead, so loading the same ROM again costs a few KB
+an image is only handed out again while the file is unchanged on disk, a rebuilt ROM gets a new image, and instances still running the old one keep it alive
+*/
+class RomImageClass {
+
+public:
+	RomImageClass() {}
+
+	RomImageClass(const RomImageClass&) = delete;
+	RomImageClass& operator=(const RomImageClass&) = delete;
+
+	//	the image of filename, shared with whoever else has it open, loaded if nobody does
+	//	a copy is read into memory of its own and the file closed, it is never shared, and is what a ROM that may be rebuilt while it runs is opened as
+	//	throws CartridgeException if the file cannot be read, is an archive without a readable ROM in it, or is not an NES ROM
+	static std::shared_ptr<RomImageClass> open(const std::string& filename, bool copy = false);
+
+	//	never written to, every instance with this file open reads the same memory
+	uint8_t* data() { return this->start; }
+	size_t size() { return this->length; }
+
+private:
+	MappedFileClass file;					//	closed once a compressed ROM has been inflated out of it, never opened for a copy
+	RomArenaClass arena;					//	what a compressed ROM was inflated into, or a copy was copied into
+	uint8_t* start = nullptr;
+	size_t length = 0;
+
+	//	what the file looked like when it was read, so a changed file is read again
+	uintmax_t fileSize = 0;
+	std::filesystem::file_time_type modified;
+
+	void load(const std::string& filename, bool copy);
+
+};
+
+#endif
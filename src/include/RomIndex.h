@@ -0,0 +1,75 @@
+#ifndef ROM_INDEX_H
+#define ROM_INDEX_H
+
+#include <cinttypes>		//	(u)intx_t datatypes
+#include <string>			//	std::string
+#include <vector>			//	std::vector
+#include <unordered_map>	//	std::unordered_multimap
+
+#include ".\RomStruct.h"
+
+//	everything the index knows about one file
+struct RomIndexEntry {
+
+	std::string path;
+	uint64_t fileSize = 0;
+	int64_t modified = 0;					//	std::filesystem::last_write_time, only ever compared against itself
+	bool valid = false;						//	false if CartridgeClass::read refused the file, kept so it is not looked at again until it changes
+
+	//	CRC32 and SHA-1 of PRG ROM followed by CHR ROM, without anything tacked on after them, what ROM databases identify a dump by
+	uint32_t crc32 = 0;
+	uint8_t sha1[20] = { 0 };
+
+	uint8_t mapperID = 0;					//	see romMapperID, after any header database fix
+	uint8_t submapperID = 0;				//	NES 2.0 only
+	bool nes2 = false;
+	tvEnum tvType = tvEnum::NTSC;
+	uint32_t prgSize = 0;
+	uint32_t chrSize = 0;
+	bool chrRam = false;
+	uint32_t prgRamSize = 0;
+	bool battery = false;
+	mirrorEnum mirroring = mirrorEnum::HORIZONTAL;
+	bool headerFixed = false;				//	the header database replaced the file's header
+
+};
+
+/*
+an index of every ROM in a library, so it can be searched without opening any of them
+scan() parses headers through CartridgeClass::read, exactly as loading them would, and hashes the files on a WorkerPoolClass
+files whose size and modification time match what the index already has are not opened at all, so keeping a loaded index up to date costs about one directory listing
+*/
+class RomIndexClass {
+
+public:
+	//	0 threads leaves it to WorkerPoolClass
+	RomIndexClass(uint32_t _threadCount = 0);
+
+	//	false if the file does not exist or is not an index this version can read, in which case the index is left empty
+	bool load(const std::string& indexFile);
+	bool save(const std::string& indexFile);
+
+	//	brings every .nes, .gz and .zip file under directory up to date, and drops entries under it that no longer exist
+	//	returns how many files had to be (re)hashed
+	uint32_t scan(const std::string& directory, bool recursive = true);
+
+	const std::vector<RomIndexEntry>& getEntries() { return this->entries; }
+	const RomIndexEntry* findCRC32(uint32_t crc);
+	const RomIndexEntry* findSHA1(const uint8_t sha1[20]);
+	const RomIndexEntry* findPath(const std::string& path);
+
+private:
+	uint32_t threadCount = 0;
+	std::vector<RomIndexEntry> entries;		//	sorted by path
+	std::unordered_multimap<uint32_t, size_t> byCRC32;
+	std::unordered_multimap<uint64_t, size_t> bySHA1;		//	by the first 8 bytes
+	std::unordered_map<std::string, size_t> byPath;
+
+	void rebuildLookups();
+
+	//	fills in everything but path, fileSize and modified, runs on the pool, so instead of logging why a file was refused it returns that, empty if it was not
+	static std::string hashFile(RomIndexEntry& entry);
+
+};
+
+#endif
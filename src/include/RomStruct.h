@@ -3,14 +3,20 @@
 
 #include <cinttypes>	//	(u)intx_t datatypes
 #include <string>		//	std::string
-#include <vector>
+#include <stdexcept>	//	std::out_of_range
+
+#include <memory>		//	std::shared_ptr
+
+#include ".\RomArena.h"
+#include ".\RomImage.h"
 
 static const std::string nesMagic = { 'N', 'E', 'S', (char)0x1A };
 
 enum tvEnum : uint8_t {
 
 	NTSC = 0,
-	PAL = 1
+	PAL = 1,
+	DENDY = 2
 
 };
 
@@ -32,15 +38,87 @@ struct romHeaderStruct {
 
 };
 
+/*
+a section of the ROM, which points either into the shared image of the ROM file(see RomImage.h), or the ROM's arena(CHR RAM, PRG RAM, or a file too short for what its header says), see RomArena.h
+it never owns what it points at, the romStruct it is in does
+PRG ROM and CHR ROM are shared with every other instance running the same file, so only sections in the arena may be written to
+*/
+struct RomSection {
+
+	RomSection() {}
+	RomSection(const RomSection&) = delete;
+	RomSection& operator=(const RomSection&) = delete;
+
+	uint8_t* data() { return this->start; }
+	size_t size() { return this->length; }
+	bool empty() { return this->length == 0; }
+
+	uint8_t& operator[](size_t index) { return this->start[index]; }
+	uint8_t& at(size_t index) {
+
+		if (index >= this->length)
+			throw std::out_of_range("RomSection index out of range");
+		return this->start[index];
+
+	}
+
+	void place(uint8_t* _start, size_t size) {
+
+		this->start = _start;
+		this->length = size;
+
+	}
+
+private:
+	uint8_t* start = nullptr;
+	size_t length = 0;
+
+};
+
+//	the iNES mapper number, which is all selectMapper goes by
+inline uint8_t romMapperID(const romHeaderStruct& header) {
+
+	return (header.flags7 & 0b11110000) | ((header.flags6 & 0b11110000) >> 4);
+
+}
+
+//	where PRG ROM starts, after the header(16 bytes) and the possible "trainer" section(512 bytes)
+inline size_t romDataOffset(const romHeaderStruct& header) {
+
+	return 16 + (512 * ((header.flags6 & 0b00000100) >> 2));
+
+}
+
+//	how many bytes of PRG ROM and CHR ROM follow romDataOffset, by the header, anything after them(Miscellaneous ROMs, or junk) is not counted
+//	iNES headers have no size MSBs, byte 9 of those is often left over junk("DiskDude!")
+inline size_t romDataSize(const romHeaderStruct& header) {
+
+	size_t prgChunks = header.prgRomSizeLSB, chrChunks = header.chrRomSizeLSB;
+	if ((header.flags7 & 0b00001100) == 0b00001000) {
+
+		prgChunks |= (size_t)(header.prgChrSizeMSB & 0b00001111) << 8;
+		chrChunks |= (size_t)(header.prgChrSizeMSB & 0b11110000) << 4;
+
+	}
+	return (prgChunks * 0x4000) + (chrChunks * 0x2000);
+
+}
+
 struct romStruct {
 
 	romHeaderStruct header;
-	std::vector<uint8_t> prg_rom;
-	std::vector<uint8_t> prg_ram;
-	std::vector<uint8_t> chr_rom;
+	std::shared_ptr<RomImageClass> source;	//	the ROM file's contents, shared with every other romStruct loaded from the same file
+	RomArenaClass arena;					//	what this instance has of its own(PRG RAM, battery backed or not, included), and the sections below point into when not into source
+	RomSection image;						//	the whole ROM, out of source
+	RomSection prg_rom;
+	RomSection prg_ram;
+	RomSection chr_rom;
 	uint32_t prg_rom_chunks = 0;
 	uint32_t prg_ram_chunks = 0;
 	uint32_t chr_rom_chunks = 0;
+	bool chr_ram = false;					//	the cartridge has no CHR ROM, chr_rom is CHR RAM instead and can be written to
+	uint32_t crc32 = 0;						//	of PRG ROM and CHR ROM(see romDataSize), what the header database looks dumps up by
+	bool headerFixed = false;				//	the header came from the header database instead of the file
 	tvEnum tvType;
 
 };
@@ -0,0 +1,46 @@
+#ifndef SAVE_WRITER_H
+#define SAVE_WRITER_H
+
+#include <cinttypes>			//	(u)intx_t datatypes
+#include <string>				//	std::string
+#include <vector>				//	std::vector
+#include <map>					//	std::map
+#include <thread>				//	std::thread
+#include <mutex>				//	std::mutex, std::unique_lock
+#include <condition_variable>	//	std::condition_variable
+
+/*
+writes battery saves off the emulation thread, see CartridgeClass::flushSave
+write() takes a copy of the save and returns immediately, a single thread writes it next to the save file, flushes it to the disk and then moves it over the save,
+so neither a slow disk nor the flush ever holds up a frame, and a crash or power cut at any point leaves either the old save or the new one behind
+only the latest save queued for a file is written, as it already holds everything the earlier ones did
+the thread is only started by the first write, and the destructor writes out anything still queued before it stops it
+*/
+class SaveWriterClass {
+
+public:
+	SaveWriterClass() {}
+	~SaveWriterClass();
+
+	void write(const std::string& filename, const uint8_t* data, size_t size);
+	void wait();											//	blocks until everything queued so far is on the disk, or has failed to get there
+
+	//	the saves that could not be written since the last call, for the caller to log, as the writer thread never touches the error log itself
+	std::vector<std::string> takeFailures();
+
+private:
+	std::thread thread;
+	std::mutex lock;
+	std::condition_variable wake, done;
+
+	std::map<std::string, std::vector<uint8_t>> queued;
+	bool writing = false;
+	bool stopping = false;
+	std::vector<std::string> failures;
+
+	void work();
+	static bool writeFile(const std::string& filename, const std::vector<uint8_t>& data);
+
+};
+
+#endif
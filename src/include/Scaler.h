@@ -0,0 +1,60 @@
+#ifndef SCALER_H
+#define SCALER_H
+
+#include <cinttypes>	//	(u)intx_t datatypes
+#include <vector>		//	std::vector
+
+#include ".\FrameSink.h"
+#include ".\WorkerPool.h"
+
+/*
+pixel art upscalers, done on the CPU so they work without a GPU
+see: https://www.scale2x.it/algorithm
+both only ever pick one of a pixel's neighbours, never blend, so they run on the palette indexes the PPU puts out and the result is converted to colors like any other frame
+the neighbour compares are done 8 pixels at a time with SSE2, rows are split up across a worker pool
+
+submitFrame hands the previous frame's result back through getOutput, which is at most 1 frame of latency
+*/
+class ScalerClass : public FrameSinkClass {
+
+public:
+	ScalerClass();
+	~ScalerClass() { this->wait(); }
+
+	//	rows are split up across this pool, which may be shared with other filters, without one they are scaled on the calling thread
+	void loadPool(WorkerPoolClass* _pool) { this->wait(); this->pool = _pool; }
+
+	void submitFrame(const FrameBuffer& frame) override;
+
+	//	2(scale2x) or 3(scale3x), changing it throws away anything in flight
+	void setFactor(uint32_t factor);
+	uint32_t getFactor() { return this->factor; }
+
+	//	the most recently finished frame, factor times the size of the frames being submitted
+	bool hasOutput() { return this->outputReady; }
+	const FrameBuffer& getOutput() { return this->output; }
+
+	//	throws away anything in flight, used when the scaler is turned back on so a stale frame is not shown
+	void flush();
+
+private:
+	uint32_t factor = 2;
+	bool useSSE2 = false;
+
+	//	the frame being scaled, with a 1 pixel border copied from its edges, so every pixel has all 8 neighbours
+	FrameBuffer padded;
+	FrameBuffer working;
+	bool workingStarted = false;
+
+	FrameBuffer output;
+	bool outputReady = false;
+
+	WorkerPoolClass* pool = nullptr;
+	void wait() { if (this->pool != nullptr) this->pool->wait(); }
+
+	void scale2xRows(uint32_t first, uint32_t last);
+	void scale3xRows(uint32_t first, uint32_t last);
+
+};
+
+#endif
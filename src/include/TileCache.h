@@ -0,0 +1,63 @@
+#ifndef TILE_CACHE_H
+#define TILE_CACHE_H
+
+#include <cinttypes>	//	(u)intx_t datatypes
+#include <vector>		//	std::vector
+
+class MapperClass;
+
+//	a single row of a tile, already decoded from its two bit planes: https://wiki.nesdev.com/w/index.php/PPU_pattern_tables
+struct TileRow {
+
+	uint8_t pixels[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };	//	one 2 bit color index per pixel, leftmost pixel first
+	uint16_t packed = 0;							//	the same pixels packed 2 bits each, leftmost pixel in the highest bits
+
+};
+
+/*
+the PPU fetches every pattern row twice per scanline(low and high plane), and then has to pull the pixels back out one bit at a time
+instead, we decode each tile once into both its normal and horizontally flipped rows, and keep them until the CHR data behind it changes
+the cache is indexed by the PPU pattern address(0x0000 to 0x1FFF), so it follows whatever CHR bank is currently windowed there
+therefore it is invalidated whenever a CHR window is switched, or CHR RAM is written to(see MapperClass::mapChr and chr_write)
+since that is exactly when the pattern tables change, it also keeps track of which 1KB of them did for the debug viewers(see PPUViewer.h)
+*/
+class TileCacheClass {
+
+public:
+	TileCacheClass(MapperClass* _mapper);
+
+	//	address is the pattern address of the low plane byte for the row, the same address the PPU would fetch: https://wiki.nesdev.com/w/index.php/PPU_pattern_tables#Addressing
+	const TileRow& row(uint16_t address, bool flip) {
+
+		uint16_t tile = (address >> 4) & 0x01FF;
+		if (!this->decoded[tile])
+			this->decode(tile);
+
+		return this->rows[((size_t)tile << 4) | ((size_t)flip << 3) | (address & 0x07)];
+
+	}
+
+	//	used when a single byte of CHR RAM has changed
+	void invalidate(uint16_t address) { this->decoded[(address >> 4) & 0x01FF] = false; this->dirty |= 1 << ((address >> 10) & 0x07); }
+
+	//	used when a CHR window has been switched to a different bank
+	void invalidateWindow(uint16_t address, uint16_t size);
+
+	void invalidateAll() { this->invalidateWindow(0x0000, 0x2000); }
+
+	//	one bit per 1KB of pattern table that has changed since the last call
+	uint8_t takeDirty() { uint8_t changed = this->dirty; this->dirty = 0; return changed; }
+
+private:
+	MapperClass* mapper = nullptr;
+
+	//	512 tiles, each with 8 normal rows followed by 8 flipped rows
+	std::vector<TileRow> rows;
+	std::vector<bool> decoded;
+	uint8_t dirty = 0xFF;
+
+	void decode(uint16_t tile);
+
+};
+
+#endif
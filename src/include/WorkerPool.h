@@ -0,0 +1,45 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <cinttypes>			//	(u)intx_t datatypes
+#include <vector>				//	std::vector
+#include <functional>			//	std::function
+#include <thread>				//	std::thread
+#include <mutex>				//	std::mutex, std::unique_lock
+#include <condition_variable>	//	std::condition_variable
+
+/*
+a fixed set of threads for splitting up per-frame work(video filters, scalers) off the emulation thread
+start() hands out [0, count) in chunks to the workers and returns immediately, wait() blocks until every chunk is done
+only one job runs at a time, start() waits for the previous one first
+*/
+class WorkerPoolClass {
+
+public:
+	//	0 threads picks one less than the number of hardware threads, leaving one for emulation
+	WorkerPoolClass(uint32_t threadCount = 0);
+	~WorkerPoolClass();
+
+	void start(uint32_t count, std::function<void(uint32_t first, uint32_t last)> task);
+	void wait();
+
+	uint32_t getThreadCount() { return (uint32_t)this->threads.size(); }
+
+private:
+	std::vector<std::thread> threads;
+	std::mutex lock;
+	std::condition_variable wake, done;
+
+	std::function<void(uint32_t, uint32_t)> task;
+	uint32_t count = 0;
+	uint32_t chunkSize = 0;
+	uint32_t nextChunk = 0;
+	uint32_t chunkCount = 0;
+	uint32_t remaining = 0;
+	bool stopping = false;
+
+	void work();
+
+};
+
+#endif
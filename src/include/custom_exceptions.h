@@ -23,4 +23,14 @@ private:
 	
 };
 
+//	while one of these is alive on a thread, the exceptions above that are thrown on that thread are not written to the error log,
+//	for worker threads, which catch them and hand the message back to one thread to log, as ErrorLogClass cannot be written from several at once
+class DeferExceptionLog {
+
+public:
+	DeferExceptionLog();
+	~DeferExceptionLog();
+
+};
+
 #endif
\ No newline at end of file
@@ -2,23 +2,56 @@
 #define MAPPER_H
 
 #include <cinttypes>	//	(u)intx_t datatypes
+#include <vector>		//	std::vector
+#include <memory>		//	std::unique_ptr
+#include <chrono>		//	std::chrono
 
 #include "..\RomStruct.h"
+#include "..\TileCache.h"
+
+class CPUClass;
+
+//	how often PRG RAM a game keeps writing to is written to its save file while it runs, saving on exit and on ROM switches does not wait for this
+//	the write happens off the emulation thread(see SaveWriter.h), so this only bounds how much a crash can lose, and how often the disk is flushed
+const std::chrono::seconds SAVE_FLUSH_INTERVAL(1);
+
+//	a change mapChr or setMirroring was asked to make while it was deferred, see MapperClass::deferPpuChanges
+struct MapperPpuChange {
+
+	bool mirror = false;								//	setMirroring(mirroring) if set, mapChr(address, size, bank) if not
+	mirrorEnum mirroring = mirrorEnum::HORIZONTAL;
+	uint16_t address = 0;
+	uint32_t size = 0;
+	uint32_t bank = 0;
+
+};
+
+//	takes the changes to what the PPU sees that a mapper defers, see MapperClass::deferPpuChanges
+class MapperDeferralClass {
+
+public:
+	virtual ~MapperDeferralClass() {  }
+
+	virtual void deferPpuChange(const MapperPpuChange& change) = 0;
+
+};
 
 class MapperClass {
 
 public:
-	MapperClass(romStruct* _rom) { this->rom = _rom; }
-	~MapperClass() { delete this->rom; }
+	//	the mapper owns the ROM from here on, and frees it along with itself
+	MapperClass(std::unique_ptr<romStruct> _rom);
+	virtual ~MapperClass() {  }
 
 	//	we do not want these values thrown away, therefore we must demand the value be used
+	//	the defaults read through the slots below, so most mappers only have to handle their register writes
 	[[nodiscard]] virtual uint8_t prg_read(uint16_t& address);
-	[[nodiscard]] virtual uint8_t chr_read(uint16_t& address);
+	[[nodiscard]] virtual uint8_t chr_read(uint16_t& address) { return this->chrRead(address); }
 
 	virtual uint8_t prg_write(uint16_t& address, const uint8_t& data);
 	virtual uint8_t chr_write(uint16_t& address, const uint8_t& data);
 
-	virtual mirrorEnum getMirror() { return (this->rom->header.flags6 & 0x01) ? mirrorEnum::VERTICAL : mirrorEnum::HORIZONTAL; }
+	mirrorEnum getMirror() { return this->mirroring; }
 	tvEnum getTV() { return this->rom->tvType; }
 
 	//	we do not need to test if the ROM exists, because if the mapper exists, the ROM does too
@@ -31,8 +64,95 @@ public:
 	uint8_t* get_chr_rom() { return (this->rom->chr_rom.size()) ? &this->rom->chr_rom.at(0) : 0; }
 	size_t get_chr_rom_size() { return this->rom->chr_rom.size(); }
 
+	//	reads straight through the slots, address is 0x8000 to 0xFFFF for PRG and 0x0000 to 0x1FFF for CHR
+	uint8_t prgRead(uint16_t address) { return this->prgSlots[(address >> 13) & 0x03][address & 0x1FFF]; }
+	uint8_t chrRead(uint16_t address) { return this->chrSlots[(address >> 10) & 0x07][address & 0x03FF]; }
+
+	//	the PPU reads pattern data through here instead of chr_read, see TileCache.h
+	const TileRow& chr_tile_row(uint16_t address, bool flip) { return this->tileCache.row(address, flip); }
+
+	//	the CPU and PPU hold on to these at reset and read through them directly, so PRG ROM reads and pattern fetches never go through a virtual call
+	//	both live as long as the mapper does
+	uint8_t* const* getPrgSlots() { return this->prgSlots; }
+	TileCacheClass* getTileCache() { return &this->tileCache; }
+
+	//	whether PRG RAM should be written to the save file now(see CartridgeClass::flushSave), which starts the wait for the next time over
+	//	unless everything, only when it was written since the last time, and SAVE_FLUSH_INTERVAL has passed since then
+	bool saveDue(bool everything);
+
+	//	takes over PRG ROM and CHR ROM from a rebuild of the ROM being run(see CartridgeClass::reload), and keeps everything else as it is:
+	//	bank registers, PRG RAM, CHR RAM and mirroring, so the game carries on from where it was with the new code and graphics
+	//	false if fresh has a different header, or either ROM was too short for its header, which leaves everything unchanged
+	bool reloadRom(romStruct& fresh);
+
+	//	which 1KB of the pattern tables have been written or switched since the last call, for the debug viewers
+	uint8_t takeChrDirty() { return this->tileCache.takeDirty(); }
+
+	//	the PPU hands over its 2KB of nametable RAM(CIRAM) at reset, and gets back the 4 1KB slots for 0x2000, 0x2400, 0x2800 and 0x2C00
+	//	the slots are repointed whenever the mirroring changes, so the PPU can keep the returned pointer
+	uint8_t* const* loadNametables(uint8_t* _ciram);
+
+	//	mappers that count PPU A12 rising(MMC3's scanline counter) return true, the PPU only watches A12 for those, see PPUClass::watch_a12
+	//	clockA12 is only called for rises the mapper would see, the short ones between pattern fetches are filtered out by the PPU
+	virtual bool watchesA12() { return false; }
+	virtual void clockA12() {  }
+
+	//	mappers with an IRQ drive the CPU's IRQ line themselves, the CPU hands itself over at reset
+	void loadCPU(CPUClass* _CPU) { this->CPU = _CPU; }
+
+	//	while the PPU runs on its own thread(see PPUPipeline.h), it is still drawing dots from before a register write the CPU makes,
+	//	so mapChr and setMirroring hand their changes to deferral instead of making them, and the PPU thread makes them through applyPpuChange once it reaches the dot of the write
+	//	nullptr has them made straight away again
+	void deferPpuChanges(MapperDeferralClass* _deferral) { this->deferral = _deferral; }
+	void applyPpuChange(const MapperPpuChange& change);
+
 protected:
-	romStruct* rom = nullptr;
+	std::unique_ptr<romStruct> rom;
+	CPUClass* CPU = nullptr;
+
+	/*
+	what the CPU sees at 0x8000 to 0xFFFF as 4 8KB slots, at 0x6000 to 0x7FFF as PRG RAM, and what the PPU sees at 0x0000 to 0x1FFF as 8 1KB slots
+	mappers point these with the map functions whenever a bank register changes, which is the only time the bank numbers are checked against the ROM,
+	banks past the end wrap around, the same as the unconnected upper bank lines would on a smaller cartridge
+	anything that has not been mapped reads as 0
+	*/
+	uint8_t* prgSlots[4] = { nullptr, nullptr, nullptr, nullptr };
+	uint8_t* chrSlots[8] = { nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
+	bool chrWritable[8] = { false, false, false, false, false, false, false, false };
+	uint8_t* prgRam = nullptr;
+	uint16_t prgRamMask = 0x1FFF;
+	bool prgRamWritten = false;
+	std::chrono::steady_clock::time_point lastFlush = std::chrono::steady_clock::now();
+
+	//	address and size are in bytes, bank counts in units of size, CHR windows that end up somewhere else have their decoded tiles thrown away
+	void mapPrg(uint16_t address, uint32_t size, uint32_t bank);
+	void mapChr(uint16_t address, uint32_t size, uint32_t bank);
+
+	//	8KB of PRG RAM at 0x6000, mask is for boards with less than 8KB that mirror it
+	void mapPrgRam(uint32_t bank, uint16_t mask = 0x1FFF);
+
+	//	CHR RAM writes and mapChr invalidate the affected tiles, anything else that changes CHR must do it itself
+	TileCacheClass tileCache;
+
+	//	mappers that can change mirroring must go through setMirroring, so the nametable slots follow
+	mirrorEnum mirroring = mirrorEnum::HORIZONTAL;
+	void setMirroring(mirrorEnum _mirroring);
+
+private:
+	//	stands in for ROM that does not exist(CPU test ROMs with no CHR), never written to
+	std::vector<uint8_t> unmapped;
+
+	MapperDeferralClass* deferral = nullptr;
+
+	//	what mapChr and setMirroring do when they are not deferred
+	void pointChr(uint16_t address, uint32_t size, uint32_t bank);
+	void pointNametables(mirrorEnum _mirroring);
+
+	uint8_t* ciram = nullptr;
+	uint8_t* nametableSlots[4] = { nullptr, nullptr, nullptr, nullptr };
+
+	//	four-screen carts bring their own 4KB of VRAM, and do not use CIRAM at all
+	std::vector<uint8_t> vram;
 
 };
 
@@ -3,17 +3,10 @@
 
 #include ".\Mapper.h"
 
-class Mapper000 : public MapperClass {
+class Mapper000 final : public MapperClass {
 
 public:
-	Mapper000(romStruct* _rom) : MapperClass(_rom) {   }
-	~Mapper000() { delete rom; }
-
-	uint8_t prg_read(uint16_t& address) override;
-	uint8_t chr_read(uint16_t& address) override;
-
-	uint8_t prg_write(uint16_t& address, const uint8_t& data) override;
-	uint8_t chr_write(uint16_t& address, const uint8_t& data) override;
+	Mapper000(std::unique_ptr<romStruct> _rom);
 
 protected:
 
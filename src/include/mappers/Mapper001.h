@@ -3,23 +3,16 @@
 
 #include ".\Mapper.h"
 
-class Mapper001 : public MapperClass {
+class Mapper001 final : public MapperClass {
 
 public:
-	Mapper001(romStruct* _rom);
-	~Mapper001() { delete rom; }
-
-	[[nodiscard]] uint8_t prg_read(uint16_t& address) override;
-	[[nodiscard]] uint8_t chr_read(uint16_t& address) override;
+	Mapper001(std::unique_ptr<romStruct> _rom);
 
 	uint8_t prg_write(uint16_t& address, const uint8_t& data) override;
-	uint8_t chr_write(uint16_t& address, const uint8_t& data) override;
-
-	mirrorEnum getMirror() { return mirroring; }
 
 protected:
 	uint8_t reg_Load = 0b00010000;
-	uint8_t reg_Control = 0x00;
+	uint8_t reg_Control = 0x0C;
 
 	//	PRG ROM can be 256KB or 512KB, but we can only look at 2 16KB sections or 1 32KB section
 	//	since 32KB can make 2 16KB, we can treat it as 2 16KB windows always
@@ -33,8 +26,8 @@ protected:
 	uint8_t chr_rom_window_1 = 0x00;
 	uint8_t chr_rom_window_2 = 0x00;
 
-	//	used to determine the windowing version
-	uint8_t prg_window_mode = 0x00;
+	//	used to determine the windowing version, both are decoded from reg_Control by loadModes
+	uint8_t prg_window_mode = 0x03;
 	uint8_t chr_window_mode = 0x00;
 
 	//	used to communicate between things, mainly for selecting window
@@ -42,12 +35,14 @@ protected:
 	uint8_t chr_value_2 = 0x00;
 	uint8_t prg_value_1 = 0x00;
 
-	mirrorEnum mirroring;
-
 	void clearLoad() { this->reg_Load = 0b00010000; }
 	void loadControl();
+	void loadModes();
 	void updateWindows();
 
+	//	points the slots at the current windows
+	void mapSlots();
+
 };
 
 #endif
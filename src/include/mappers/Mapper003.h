@@ -3,17 +3,12 @@
 
 #include ".\Mapper.h"
 
-class Mapper003 : public MapperClass {
+class Mapper003 final : public MapperClass {
 
 public:
-	Mapper003(romStruct* _rom);
-	~Mapper003() { delete rom; }
-
-	[[nodiscard]] uint8_t prg_read(uint16_t& address) override;
-	[[nodiscard]] uint8_t chr_read(uint16_t& address) override;
+	Mapper003(std::unique_ptr<romStruct> _rom);
 
 	uint8_t prg_write(uint16_t& address, const uint8_t& data) override;
-	uint8_t chr_write(uint16_t& address, const uint8_t& data) override;
 
 protected:
 	//	CHR ROM is always 1 8KB window
@@ -0,0 +1,35 @@
+#ifndef MAPPER_004_H
+#define MAPPER_004_H
+
+#include ".\Mapper.h"
+
+class Mapper004 final : public MapperClass {
+
+public:
+	Mapper004(std::unique_ptr<romStruct> _rom);
+
+	uint8_t prg_write(uint16_t& address, const uint8_t& data) override;
+
+	//	the scanline counter is clocked by PPU A12 rising, see PPUClass::watch_a12
+	bool watchesA12() override { return true; }
+	void clockA12() override;
+
+protected:
+	//	bank select, the low 3 bits pick which of the 8 bank registers the next bank data write goes to
+	uint8_t bankSelect = 0x00;
+
+	//	R0 and R1 are 2KB CHR banks(in 1KB units, so the low bit is ignored), R2 to R5 are 1KB CHR banks, R6 and R7 are 8KB PRG banks
+	uint8_t banks[8] = { 0, 2, 4, 5, 6, 7, 0, 1 };
+
+	//	the IRQ counter reloads from the latch when it reaches 0, or on the next clock after 0xC001 is written
+	uint8_t irqLatch = 0x00;
+	uint8_t irqCounter = 0x00;
+	bool irqReload = false;
+	bool irqEnabled = false;
+
+	//	points the slots at the current banks
+	void mapSlots();
+
+};
+
+#endif
@@ -3,17 +3,12 @@
 
 #include ".\Mapper.h"
 
-class Mapper002 : public MapperClass {
+class Mapper002 final : public MapperClass {
 
 public:
-	Mapper002(romStruct* _rom);
-	~Mapper002() { delete rom; }
-
-	[[nodiscard]] uint8_t prg_read(uint16_t& address) override;
-	[[nodiscard]] uint8_t chr_read(uint16_t& address) override;
+	Mapper002(std::unique_ptr<romStruct> _rom);
 
 	uint8_t prg_write(uint16_t& address, const uint8_t& data) override;
-	uint8_t chr_write(uint16_t& address, const uint8_t& data) override;
 
 protected:
 	//	PRG ROM is always 2 16KB windows with the second always fixed to the last section
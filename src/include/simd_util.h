@@ -0,0 +1,154 @@
+#ifndef SIMD_UTIL_H
+#define SIMD_UTIL_H
+
+#include <cinttypes>	//	(u)intx_t datatypes
+#include <cstddef>		//	size_t
+#include <new>			//	std::align_val_t
+#include <vector>		//	std::vector
+
+//	runtime checks for which SIMD instruction sets the CPU we are running on has
+//	code for the newer sets is compiled with TARGET_X so the rest of the program does not require them
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86
+#include <emmintrin.h>	//	SSE2
+#include <tmmintrin.h>	//	SSSE3
+#include <smmintrin.h>	//	SSE4.1
+#include <wmmintrin.h>	//	PCLMULQDQ
+#include <immintrin.h>	//	AVX2, SHA
+#ifdef _MSC_VER
+#include <intrin.h>		//	__cpuid, _xgetbv
+#define TARGET_SSSE3
+#define TARGET_AVX2
+#define TARGET_PCLMUL
+#define TARGET_SHA
+#else
+#include <cpuid.h>		//	__get_cpuid
+#define TARGET_SSSE3 __attribute__((target("ssse3")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_PCLMUL __attribute__((target("pclmul,sse4.1")))
+#define TARGET_SHA __attribute__((target("sha,sse4.1")))
+#endif
+#endif
+
+//	the kernels only use unaligned loads and stores, which cost nothing extra when the address happens to be aligned,
+//	so buffers they stream through(frames, converted colors) are allocated on this, and no 16 or 32 byte access straddles a cache line
+const size_t SIMD_ALIGNMENT = 32;
+
+template<typename T>
+struct AlignedAllocator {
+
+	typedef T value_type;
+
+	AlignedAllocator() noexcept {  }
+	template<typename U> AlignedAllocator(const AlignedAllocator<U>&) noexcept {  }
+
+	T* allocate(size_t count) { return (T*)::operator new(count * sizeof(T), std::align_val_t(SIMD_ALIGNMENT)); }
+	void deallocate(T* memory, size_t) noexcept { ::operator delete(memory, std::align_val_t(SIMD_ALIGNMENT)); }
+
+	template<typename U> bool operator==(const AlignedAllocator<U>&) const noexcept { return true; }
+	template<typename U> bool operator!=(const AlignedAllocator<U>&) const noexcept { return false; }
+
+};
+
+template<typename T> using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+#ifdef SIMD_X86
+//	see: https://en.wikipedia.org/wiki/CPUID#EAX=1:_Processor_Info_and_Feature_Bits
+inline void cpuidRegisters(uint32_t leaf, uint32_t registers[4]) {
+
+#ifdef _MSC_VER
+	int info[4] = { 0, 0, 0, 0 };
+	__cpuidex(info, (int)leaf, 0);
+	for (uint8_t i = 0; i < 4; i++)
+		registers[i] = (uint32_t)info[i];
+#else
+	registers[0] = registers[1] = registers[2] = registers[3] = 0;
+	__get_cpuid_count(leaf, 0, &registers[0], &registers[1], &registers[2], &registers[3]);
+#endif
+
+}
+#endif
+
+inline bool cpuHasSSE2() {
+
+#ifdef SIMD_X86
+	uint32_t registers[4];
+	cpuidRegisters(1, registers);
+	return (registers[3] & (1 << 26)) != 0;
+#else
+	return false;
+#endif
+
+}
+
+inline bool cpuHasSSSE3() {
+
+#ifdef SIMD_X86
+	uint32_t registers[4];
+	cpuidRegisters(1, registers);
+	return (registers[2] & (1 << 9)) != 0;
+#else
+	return false;
+#endif
+
+}
+
+//	carry-less multiply, along with SSE4.1 which everything using it also needs
+inline bool cpuHasPCLMUL() {
+
+#ifdef SIMD_X86
+	uint32_t registers[4];
+	cpuidRegisters(1, registers);
+	return (registers[2] & (1 << 1)) && (registers[2] & (1 << 19));
+#else
+	return false;
+#endif
+
+}
+
+//	the SHA extensions, along with SSE4.1 which everything using them also needs
+inline bool cpuHasSHA() {
+
+#ifdef SIMD_X86
+	uint32_t registers[4];
+	cpuidRegisters(1, registers);
+	if (!(registers[2] & (1 << 19)))
+		return false;
+
+	cpuidRegisters(7, registers);
+	return (registers[1] & (1 << 29)) != 0;
+#else
+	return false;
+#endif
+
+}
+
+inline bool cpuHasAVX2() {
+
+#ifdef SIMD_X86
+	uint32_t registers[4];
+	cpuidRegisters(1, registers);
+
+	//	the OS also has to save the AVX registers on context switches(OSXSAVE and XCR0 bits 1 and 2)
+	if (!(registers[2] & (1 << 27)) || !(registers[2] & (1 << 28)))
+		return false;
+#ifdef _MSC_VER
+	uint64_t xcr0 = _xgetbv(0);
+#else
+	uint32_t eax = 0, edx = 0;
+	__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	uint64_t xcr0 = ((uint64_t)edx << 32) | eax;
+#endif
+	if ((xcr0 & 0x06) != 0x06)
+		return false;
+
+	cpuidRegisters(7, registers);
+	return (registers[1] & (1 << 5)) != 0;
+#else
+	return false;
+#endif
+
+}
+
+#endif
@@ -26,7 +26,7 @@ int main(int argc, char* argv[]) {
 	cpu.loadController(&controller);
 
 	ppu.loadCartridge(&cartridge);
-	ppu.loadGUI(&gui);
+	ppu.loadFrameSink(&gui);
 	ppu.loadCPU(&cpu);
   
 	//  give controller gui access
@@ -42,9 +42,9 @@ int main(int argc, char* argv[]) {
 	gui.addCPUViewer("CPU RAM", &CPUClass::get_cpu_ram, &CPUClass::get_cpu_ram_size);
 	gui.addCPUViewer("CPU Regs", &CPUClass::get_cpu_regs, &CPUClass::get_cpu_regs_size);
 
-	gui.addCartViewer("Cartridge PRG ROM", &CartridgeClass::get_prm_rom, &CartridgeClass::get_prm_rom_size);
+	gui.addCartViewer("Cartridge PRG ROM", &CartridgeClass::get_prm_rom, &CartridgeClass::get_prm_rom_size, true);
 	gui.addCartViewer("Cartridge PRG RAM", &CartridgeClass::get_prg_ram, &CartridgeClass::get_prg_ram_size);
-	gui.addCartViewer("Cartridge CHR ROM", &CartridgeClass::get_chr_rom, &CartridgeClass::get_chr_rom_size);
+	gui.addCartViewer("Cartridge CHR ROM", &CartridgeClass::get_chr_rom, &CartridgeClass::get_chr_rom_size, true);
 
 	gui.addPPUViewer("PPU Nametables",&PPUClass::get_ppu_nametables,&PPUClass::get_ppu_nametables_size);
 	gui.addPPUViewer("PPU Regs", &PPUClass::get_ppu_regs, &PPUClass::get_ppu_regs_size);
@@ -55,9 +55,15 @@ int main(int argc, char* argv[]) {
 
 	while (gui.shouldRender()) {
 
-		if (!gui.paused() && gui.isLoaded())
+		if (!gui.paused() && gui.isLoaded()) {
+
 			cpu.runFrame();
 
+			//	battery saves are written out between frames, never while one is running
+			cartridge.flushSave();
+
+		}
+
 		gui.draw();
 
 	}
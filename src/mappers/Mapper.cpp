@@ -1,29 +1,240 @@
+#include <algorithm>
+#include <cstring>	//	std::memcmp
+
 #include "..\include\mappers\Mapper.h"
 
+MapperClass::MapperClass(std::unique_ptr<romStruct> _rom) : rom(std::move(_rom)), tileCache(this) {
+
+	//	see: https://wiki.nesdev.com/w/index.php/INES#Flags_6
+	if (this->rom->header.flags6 & 0x08)
+		this->mirroring = mirrorEnum::FOURSCREEN;
+	else
+		this->mirroring = (this->rom->header.flags6 & 0x01) ? mirrorEnum::VERTICAL : mirrorEnum::HORIZONTAL;
+
+	this->unmapped.resize(0x2000, 0x00);
+	std::fill(std::begin(this->prgSlots), std::end(this->prgSlots), &this->unmapped.at(0));
+	std::fill(std::begin(this->chrSlots), std::end(this->chrSlots), &this->unmapped.at(0));
+
+}
+
 [[nodiscard]] uint8_t MapperClass::prg_read(uint16_t& address) {
 
-	return this->rom->prg_rom.at(address);
+	if (address >= 0x8000)
+		return this->prgRead(address);
+	if (address >= 0x6000 && this->prgRam != nullptr)
+		return this->prgRam[(address - 0x6000) & this->prgRamMask];
+	return 0;
 
 }
 
-[[nodiscard]] uint8_t MapperClass::chr_read(uint16_t& address) {
+uint8_t MapperClass::prg_write(uint16_t& address, const uint8_t& data) {
 
-	//	safety check for CPU testing ROMs
-	if (this->rom->chr_rom.size() == 0)
-		return 0;
+	//	PRG ROM is read only, anything else up there is a mapper register, which the mapper handles itself
+	if (address >= 0x6000 && address < 0x8000 && this->prgRam != nullptr) {
 
-	return this->rom->chr_rom.at(address);
+		this->prgRamWritten = true;
+		return this->prgRam[(address - 0x6000) & this->prgRamMask] = data;
+
+	}
+	return 0;
 
 }
 
-uint8_t MapperClass::prg_write(uint16_t& address, const uint8_t& data) {
+bool MapperClass::saveDue(bool everything) {
+
+	//	a game writing PRG RAM every frame would otherwise have the save file written every frame
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (!everything && (!this->prgRamWritten || now - this->lastFlush < SAVE_FLUSH_INTERVAL))
+		return false;
+
+	this->prgRamWritten = false;
+	this->lastFlush = now;
+	return true;
+
+}
+
+//	whether section points straight into the ROM file, instead of the arena copy a short file gets
+static bool inImage(romStruct& rom, RomSection& section) {
+
+	return section.data() >= rom.image.data() && section.data() + section.size() <= rom.image.data() + rom.image.size();
+
+}
+
+//	a slot pointing into from is moved to the same offset in to, anything else(RAM, unmapped) is left alone
+static void rebase(uint8_t*& slot, RomSection& from, RomSection& to) {
 
-	return this->rom->prg_rom.at(address) = data;
+	if (slot >= from.data() && slot < from.data() + from.size())
+		slot = to.data() + (slot - from.data());
+
+}
+
+bool MapperClass::reloadRom(romStruct& fresh) {
+
+	//	the same header means the same mapper, sizes and RAM, so every bank register still means the same thing
+	if (std::memcmp(&fresh.header, &this->rom->header, sizeof(romHeaderStruct)) != 0)
+		return false;
+	if (!inImage(*this->rom, this->rom->prg_rom) || !inImage(fresh, fresh.prg_rom))
+		return false;
+	if (!this->rom->chr_ram && (!inImage(*this->rom, this->rom->chr_rom) || !inImage(fresh, fresh.chr_rom)))
+		return false;
+
+	for (uint8_t*& slot : this->prgSlots)
+		rebase(slot, this->rom->prg_rom, fresh.prg_rom);
+	this->rom->prg_rom.place(fresh.prg_rom.data(), fresh.prg_rom.size());
+
+	//	CHR RAM is ours, and stays
+	if (!this->rom->chr_ram) {
+
+		for (uint8_t*& slot : this->chrSlots)
+			rebase(slot, this->rom->chr_rom, fresh.chr_rom);
+		this->rom->chr_rom.place(fresh.chr_rom.data(), fresh.chr_rom.size());
+
+	}
+
+	//	the old image is let go of here, unless another instance is still running it
+	this->rom->source = fresh.source;
+	this->rom->image.place(fresh.image.data(), fresh.image.size());
+	this->rom->crc32 = fresh.crc32;
+	this->rom->headerFixed = fresh.headerFixed;
+
+	this->tileCache.invalidateAll();
+	return true;
 
 }
 
 uint8_t MapperClass::chr_write(uint16_t& address, const uint8_t& data) {
 
-	return 0;
+	//	only CHR RAM can be written to, writes to CHR ROM go nowhere
+	uint8_t slot = (address >> 10) & 0x07;
+	if (!this->chrWritable[slot])
+		return 0;
+
+	this->tileCache.invalidate(address);
+	return this->chrSlots[slot][address & 0x03FF] = data;
+
+}
+
+void MapperClass::mapPrg(uint16_t address, uint32_t size, uint32_t bank) {
+
+	size_t banks = this->rom->prg_rom.size() / size;
+	for (uint32_t offset = 0; offset < size; offset += 0x2000) {
+
+		uint8_t slot = ((address - 0x8000 + offset) >> 13) & 0x03;
+		this->prgSlots[slot] = banks ? &this->rom->prg_rom.at(((bank % banks) * size) + offset) : &this->unmapped.at(0);
+
+	}
+
+}
+
+void MapperClass::mapChr(uint16_t address, uint32_t size, uint32_t bank) {
+
+	if (this->deferral != nullptr) {
+
+		MapperPpuChange change;
+		change.address = address;
+		change.size = size;
+		change.bank = bank;
+		this->deferral->deferPpuChange(change);
+		return;
+
+	}
+
+	this->pointChr(address, size, bank);
+
+}
+
+void MapperClass::pointChr(uint16_t address, uint32_t size, uint32_t bank) {
+
+	size_t banks = this->rom->chr_rom.size() / size;
+	for (uint32_t offset = 0; offset < size; offset += 0x0400) {
+
+		uint8_t slot = ((address + offset) >> 10) & 0x07;
+		uint8_t* window = banks ? &this->rom->chr_rom.at(((bank % banks) * size) + offset) : &this->unmapped.at(0);
+		this->chrWritable[slot] = banks && this->rom->chr_ram;
+
+		if (window != this->chrSlots[slot]) {
+
+			this->chrSlots[slot] = window;
+			this->tileCache.invalidateWindow(slot * 0x0400, 0x0400);
+
+		}
+
+	}
+
+}
+
+void MapperClass::mapPrgRam(uint32_t bank, uint16_t mask) {
+
+	size_t banks = this->rom->prg_ram.size() / 0x2000;
+	this->prgRam = banks ? &this->rom->prg_ram.at((bank % banks) * 0x2000) : nullptr;
+	this->prgRamMask = mask;
+
+}
+
+uint8_t* const* MapperClass::loadNametables(uint8_t* _ciram) {
+
+	this->ciram = _ciram;
+	this->pointNametables(this->mirroring);
+	return this->nametableSlots;
+
+}
+
+void MapperClass::setMirroring(mirrorEnum _mirroring) {
+
+	if (this->deferral != nullptr) {
+
+		MapperPpuChange change;
+		change.mirror = true;
+		change.mirroring = _mirroring;
+		this->deferral->deferPpuChange(change);
+		return;
+
+	}
+
+	this->pointNametables(_mirroring);
+
+}
+
+void MapperClass::applyPpuChange(const MapperPpuChange& change) {
+
+	if (change.mirror)
+		this->pointNametables(change.mirroring);
+	else
+		this->pointChr(change.address, change.size, change.bank);
+
+}
+
+void MapperClass::pointNametables(mirrorEnum _mirroring) {
+
+	this->mirroring = _mirroring;
+
+	//	the PPU has not given us CIRAM yet, loadNametables will point the slots once it does
+	if (this->ciram == nullptr)
+		return;
+
+	//	see the following for how each mode lays out the nametables: https://wiki.nesdev.com/w/index.php/Mirroring#Nametable_Mirroring
+	switch (this->mirroring) {
+
+	case mirrorEnum::HORIZONTAL:
+		this->nametableSlots[0] = this->nametableSlots[1] = this->ciram;
+		this->nametableSlots[2] = this->nametableSlots[3] = this->ciram + 0x0400;
+		break;
+	case mirrorEnum::VERTICAL:
+		this->nametableSlots[0] = this->nametableSlots[2] = this->ciram;
+		this->nametableSlots[1] = this->nametableSlots[3] = this->ciram + 0x0400;
+		break;
+	case mirrorEnum::SINGLEA:
+		this->nametableSlots[0] = this->nametableSlots[1] = this->nametableSlots[2] = this->nametableSlots[3] = this->ciram;
+		break;
+	case mirrorEnum::SINGLEB:
+		this->nametableSlots[0] = this->nametableSlots[1] = this->nametableSlots[2] = this->nametableSlots[3] = this->ciram + 0x0400;
+		break;
+	case mirrorEnum::FOURSCREEN:
+		this->vram.resize(0x1000);
+		for (uint8_t i = 0; i < 4; i++)
+			this->nametableSlots[i] = &this->vram.at((size_t)i * 0x0400);
+		break;
+
+	}
 
 }
\ No newline at end of file
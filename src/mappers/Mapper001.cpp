@@ -2,49 +2,12 @@
 
 //	please see the following for the technical workings: https://wiki.nesdev.com/w/index.php/MMC1
 
-Mapper001::Mapper001(romStruct* _rom) : MapperClass(_rom) {
+Mapper001::Mapper001(std::unique_ptr<romStruct> _rom) : MapperClass(std::move(_rom)) {
 
-	//	first window is either fixed to the first bank, or switchable
-	this->prg_rom_window_1 = 0x00;
-	//	second window is either fixed to the last bank, or switchable
-	this->prg_rom_window_2 = this->rom->prg_rom_chunks - 1;
-
-	//	the specification does not state where these windows are
-	this->chr_rom_window_1 = 0x00;
-	this->chr_rom_window_2 = 0x00;
-
-	this->mirroring = (this->rom->header.flags6 & 0x01) ? mirrorEnum::VERTICAL : mirrorEnum::HORIZONTAL;
-
-}
-
-[[nodiscard]] uint8_t Mapper001::prg_read(uint16_t& address) {
-
-	//	following CPU address space, 0x6000 to 0x7FFF is PRG RAM space
-	if (address < 0x8000)
-		//	PRG RAM window size is only 8192(0x2000) in size
-		return this->rom->prg_ram.at(((size_t)address - 0x6000) + ((size_t)this->prg_ram_window * 0x2000));
-	else if (address < 0xC000)
-		//	above 0x6000 and below 0xC000 is the first PRG ROM window section
-		return this->rom->prg_rom.at(((size_t)address - 0x8000) + ((size_t)this->prg_rom_window_1 * 0x4000));
-	else
-		//	last, the second PRG ROM window section
-		return this->rom->prg_rom.at(((size_t)address - 0xC000) + ((size_t)this->prg_rom_window_2 * 0x4000));
-
-}
-
-[[nodiscard]] uint8_t Mapper001::chr_read(uint16_t& address) {
-
-	//	safety check for CPU testing ROMs
-	if (this->rom->chr_rom.size() == 0)
-		return 0;
-
-	//	check if the address is in the first window section
-	if (address < 0x1000)
-		//	we want to window into a specific section at 4KB windows, so take the window offset, and multiply by 4096(0x1000)
-		return this->rom->chr_rom.at((size_t)address + ((size_t)this->chr_rom_window_1 * 0x1000));
-	else
-		//	we need to reduce the address by 4096(0x1000) so that it is within the 4KB window space
-		return this->rom->chr_rom.at(((size_t)address - 0x1000) + ((size_t)this->chr_rom_window_2 * 0x1000));
+	//	the MMC1 powers on with the control register at 0x0C, PRG mode 3, so the last bank is fixed at 0xC000 where the reset vector is, and CHR switches 8KB at a time
+	//	the mirroring stays as the header says until the game writes the control register
+	this->loadModes();
+	this->updateWindows();
 
 }
 
@@ -52,7 +15,7 @@ uint8_t Mapper001::prg_write(uint16_t& address, const uint8_t& data) {
 
 	if (address < 0x8000)
 		//	PRG RAM section, we can write there
-		return this->rom->prg_ram.at(((size_t)address - 0x6000) + ((size_t)this->prg_ram_window * 0x2000)) = data;
+		return MapperClass::prg_write(address, data);
 
 	if (data & 0x80) {	//	check if the highest bit of the data was set, if so, reset the reg_Load
 
@@ -94,22 +57,6 @@ uint8_t Mapper001::prg_write(uint16_t& address, const uint8_t& data) {
 
 }
 
-uint8_t Mapper001::chr_write(uint16_t& address, const uint8_t& data) {
-
-	//	safety check for CPU testing ROMs
-	if (this->rom->chr_rom.size() == 0)
-		return 0;
-
-	//	check if the address is in the first window section
-	if (address < 0x1000)
-		//	we want to window into a specific section at 4KB windows, so take the window offset, and multiply by 4096(0x1000)
-		return this->rom->chr_rom.at((size_t)address + ((size_t)this->chr_rom_window_1 * 0x1000)) = data;
-	else
-		//	we need to reduce the address by 4096(0x1000) so that it is within the 4KB window space
-		return this->rom->chr_rom.at(((size_t)address - 0x1000) + ((size_t)this->chr_rom_window_2 * 0x1000)) = data;
-
-}
-
 void Mapper001::loadControl() {
 
 /*
@@ -125,13 +72,14 @@ CPPMM
 +----- CHR ROM bank mode (0: switch 8 KB at a time; 1: switch two separate 4 KB banks)
 */
 
-	this->prg_window_mode = (this->reg_Control & 0b00001100) >> 2;
-	this->chr_window_mode = (this->reg_Control & 0b00010000) >> 4;
+	this->loadModes();
 
 	switch (this->reg_Control & 0x03) {
 
-	case 2: this->mirroring = mirrorEnum::VERTICAL; break;
-	case 3: this->mirroring = mirrorEnum::HORIZONTAL; break;
+	case 0: this->setMirroring(mirrorEnum::SINGLEA); break;
+	case 1: this->setMirroring(mirrorEnum::SINGLEB); break;
+	case 2: this->setMirroring(mirrorEnum::VERTICAL); break;
+	case 3: this->setMirroring(mirrorEnum::HORIZONTAL); break;
 
 	}
 
@@ -140,6 +88,13 @@ CPPMM
 
 }
 
+void Mapper001::loadModes() {
+
+	this->prg_window_mode = (this->reg_Control & 0b00001100) >> 2;
+	this->chr_window_mode = (this->reg_Control & 0b00010000) >> 4;
+
+}
+
 void Mapper001::updateWindows() {
 
 	//	update PRG windows
@@ -148,7 +103,7 @@ void Mapper001::updateWindows() {
 		//	we are using 1 32KB window
 		//	set the first window to the even window, second to odd value
 		this->prg_rom_window_1 = this->prg_value_1 & 0x0E;
-		this->prg_rom_window_2 = this->prg_value_1 | 0x01;
+		this->prg_rom_window_2 = (this->prg_value_1 & 0x0E) | 0x01;
 
 	}
 	else if (this->prg_window_mode == 0x02) {
@@ -170,7 +125,7 @@ void Mapper001::updateWindows() {
 	if (this->chr_window_mode == 0x00) {
 
 		//	we are using 1 8KB windows, update both together
-		this->chr_rom_window_1 = this->chr_value_1 & 0x0E;
+		this->chr_rom_window_1 = this->chr_value_1 & 0x1E;
 		this->chr_rom_window_2 = this->chr_value_1 | 0x01;
 
 	}
@@ -182,4 +137,19 @@ void Mapper001::updateWindows() {
 
 	}
 
+	this->mapSlots();
+
+}
+
+void Mapper001::mapSlots() {
+
+	//	PRG RAM window size is only 8192(0x2000) in size
+	this->mapPrgRam(this->prg_ram_window);
+
+	//	PRG ROM is always treated as 2 16KB windows, and CHR as 2 4KB windows
+	this->mapPrg(0x8000, 0x4000, this->prg_rom_window_1);
+	this->mapPrg(0xC000, 0x4000, this->prg_rom_window_2);
+	this->mapChr(0x0000, 0x1000, this->chr_rom_window_1);
+	this->mapChr(0x1000, 0x1000, this->chr_rom_window_2);
+
 }
\ No newline at end of file
@@ -2,28 +2,12 @@
 
 #include "..\include\custom_exceptions.h"
 
-Mapper003::Mapper003(romStruct* _rom) : MapperClass(_rom) {
+Mapper003::Mapper003(std::unique_ptr<romStruct> _rom) : MapperClass(std::move(_rom)) {
 
-
-
-}
-
-[[nodiscard]] uint8_t Mapper003::prg_read(uint16_t& address) {
-
-	if (address < 0x8000)
-		return 0;
-	else
-		return this->rom->prg_rom.at(((size_t)address - 0x8000) & ((this->rom->prg_rom_chunks > 1) ? 0x7FFF : 0x3FFF));
-
-}
-
-[[nodiscard]] uint8_t Mapper003::chr_read(uint16_t& address) {
-
-	//	safety check for CPU testing ROMs
-	if (this->rom->chr_rom.size() == 0)
-		return 0;
-
-	return this->rom->chr_rom.at((size_t)address + ((size_t)this->chr_rom_window_1 * 0x2000));
+	//	PRG ROM is 16KB or 32KB, with 16KB mirrored at 0xC000 the same as NROM
+	this->mapPrg(0x8000, 0x4000, 0);
+	this->mapPrg(0xC000, 0x4000, 1);
+	this->mapChr(0x0000, 0x2000, this->chr_rom_window_1);
 
 }
 
@@ -33,16 +17,9 @@ uint8_t Mapper003::prg_write(uint16_t& address, const uint8_t& data) {
 		return 0;
 	
 	//	follows CNROM format for selecting correct bank to window to
-	return this->chr_rom_window_1 = data & 0x03;
-
-}
-
-uint8_t Mapper003::chr_write(uint16_t& address, const uint8_t& data) {
-
-	//	safety check for CPU testing ROMs
-	if (this->rom->chr_rom.size() == 0)
-		return 0;
+	this->chr_rom_window_1 = data & 0x03;
+	this->mapChr(0x0000, 0x2000, this->chr_rom_window_1);
 
-	return this->rom->chr_rom.at((size_t)address + ((size_t)this->chr_rom_window_1 * 0x2000)) = data;
+	return this->chr_rom_window_1;
 
 }
\ No newline at end of file
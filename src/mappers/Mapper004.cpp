@@ -0,0 +1,114 @@
+#include "..\include\mappers\Mapper004.h"
+
+#include "..\include\CPU.h"
+#include "..\include\custom_exceptions.h"
+
+//	please see the following for the technical workings: https://wiki.nesdev.com/w/index.php/MMC3
+//	0xA001(PRG RAM protect) is ignored, as most emulators do, since MMC6 games share the mapper number and use that register differently
+
+Mapper004::Mapper004(std::unique_ptr<romStruct> _rom) : MapperClass(std::move(_rom)) {
+
+	this->mapPrgRam(0);
+	this->mapSlots();
+
+}
+
+uint8_t Mapper004::prg_write(uint16_t& address, const uint8_t& data) {
+
+	if (address < 0x8000)
+		return MapperClass::prg_write(address, data);
+
+	//	each 8KB range holds 2 registers, picked by whether the address is even or odd
+	switch (address & 0xE001) {
+
+	case 0x8000:
+/*
+7  bit  0
+---- ----
+CPMx xRRR
+|||   |||
+|||   +++- Specify which bank register to update on next write to Bank Data register
+||+------- Nothing on the MMC3, see MMC6
+|+-------- PRG ROM bank mode (0: $8000-$9FFF swappable, $C000-$DFFF fixed to second-last bank;
+|                             1: $C000-$DFFF swappable, $8000-$9FFF fixed to second-last bank)
++--------- CHR A12 inversion (0: two 2 KB banks at $0000-$0FFF, four 1 KB banks at $1000-$1FFF;
+                              1: two 2 KB banks at $1000-$1FFF, four 1 KB banks at $0000-$0FFF)
+*/
+		this->bankSelect = data;
+		this->mapSlots();
+		break;
+
+	case 0x8001:
+		this->banks[this->bankSelect & 0x07] = data;
+		this->mapSlots();
+		break;
+
+	case 0xA000:
+		//	four-screen carts wire the nametables themselves
+		if (this->mirroring != mirrorEnum::FOURSCREEN)
+			this->setMirroring((data & 0x01) ? mirrorEnum::HORIZONTAL : mirrorEnum::VERTICAL);
+		break;
+
+	case 0xC000:
+		this->irqLatch = data;
+		break;
+
+	case 0xC001:
+		this->irqCounter = 0;
+		this->irqReload = true;
+		break;
+
+	case 0xE000:
+		//	disabling also acknowledges any pending IRQ
+		this->irqEnabled = false;
+		if (this->CPU)
+			this->CPU->setIRQ(false);
+		break;
+
+	case 0xE001:
+		this->irqEnabled = true;
+		break;
+
+	}
+
+	return data;
+
+}
+
+void Mapper004::clockA12() {
+
+	if (this->irqCounter == 0 || this->irqReload) {
+
+		this->irqCounter = this->irqLatch;
+		this->irqReload = false;
+
+	}
+	else
+		this->irqCounter--;
+
+	//	the IRQ line stays asserted until the game acknowledges it through 0xE000
+	if (this->irqCounter == 0 && this->irqEnabled && this->CPU)
+		this->CPU->setIRQ(true);
+
+}
+
+void Mapper004::mapSlots() {
+
+	//	the second-last bank is fixed to whichever of 0x8000 or 0xC000 is not swappable, the last bank is always at 0xE000
+	uint32_t secondLast = (uint32_t)(this->rom->prg_rom.size() / 0x2000) - 2;
+	bool prgMode = (this->bankSelect & 0x40) != 0;
+
+	this->mapPrg(prgMode ? 0xC000 : 0x8000, 0x2000, this->banks[6]);
+	this->mapPrg(0xA000, 0x2000, this->banks[7]);
+	this->mapPrg(prgMode ? 0x8000 : 0xC000, 0x2000, secondLast);
+	this->mapPrg(0xE000, 0x2000, secondLast + 1);
+
+	//	CHR A12 inversion swaps which half of the pattern tables gets the 2KB banks
+	uint16_t inversion = (this->bankSelect & 0x80) ? 0x1000 : 0x0000;
+
+	this->mapChr(0x0000 ^ inversion, 0x0800, this->banks[0] >> 1);
+	this->mapChr(0x0800 ^ inversion, 0x0800, this->banks[1] >> 1);
+	for (uint8_t i = 0; i < 4; i++)
+		this->mapChr((0x1000 + (i * 0x0400)) ^ inversion, 0x0400, this->banks[2 + i]);
+
+}
@@ -2,9 +2,12 @@
 
 #include "..\include\custom_exceptions.h"
 
-Mapper007::Mapper007(romStruct* _rom) : MapperClass(_rom) {
+Mapper007::Mapper007(std::unique_ptr<romStruct> _rom) : MapperClass(std::move(_rom)) {
 
-	this->mirroring = mirrorEnum::SINGLEA;
+	this->setMirroring(mirrorEnum::SINGLEA);
+
+	this->mapPrg(0x8000, 0x8000, this->prg_rom_window_1);
+	this->mapChr(0x0000, 0x2000, 0);
 
 }
 
@@ -13,13 +16,7 @@ Mapper007::Mapper007(romStruct* _rom) : MapperClass(_rom) {
 	if (address < 0x8000)
 		throw new MapperException("Mapper does not support PRG RAM");
 	else
-		return this->rom->prg_rom.at(((size_t)address - 0x8000) + (this->prg_rom_window_1 * 0x8000));
-
-}
-
-[[nodiscard]] uint8_t Mapper007::chr_read(uint16_t& address) {
-
-	return this->rom->chr_rom.at((size_t)address);
+		return this->prgRead(address);
 
 }
 
@@ -38,16 +35,13 @@ xxxM xPPP
 		throw new MapperException("Mapper does not support PRG RAM");
 
 	if (!(data & 0b00010000))
-		this->mirroring = mirrorEnum::SINGLEA;
+		this->setMirroring(mirrorEnum::SINGLEA);
 	else
-		this->mirroring = mirrorEnum::SINGLEB;
-
-	return this->prg_rom_window_1 = data & 0x07;
-
-}
+		this->setMirroring(mirrorEnum::SINGLEB);
 
-uint8_t Mapper007::chr_write(uint16_t& address, const uint8_t& data) {
+	this->prg_rom_window_1 = data & 0x07;
+	this->mapPrg(0x8000, 0x8000, this->prg_rom_window_1);
 
-	return this->rom->chr_rom.at((size_t)address) = data;
+	return this->prg_rom_window_1;
 
 }
\ No newline at end of file
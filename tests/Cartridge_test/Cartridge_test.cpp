@@ -1,14 +1,153 @@
 #include <filesystem>	//	std::filesystem
+#include <fstream>		//	std::ifstream, std::ofstream
 #include <iostream>		//	std::cout, std::cerr, std::clog
 #include <assert.h>		//	assert()
+#include <vector>		//	std::vector
+#include <iterator>		//	std::istreambuf_iterator
 
 #include "..\..\src\include\Cartridge.h"
+#include "..\..\src\include\Mapper_Collection.h"
 #include "..\..\src\include\RomStruct.h"
+#include "..\..\src\include\SaveWriter.h"
 
 #include "..\..\src\include\custom_exceptions.h"
+#include "..\TestHelpers.h"
+
+/*
+checks battery saves and hot reloading a rebuilt ROM, then loads every ROM in .\roms and prints what its header says: Cartridge_test
+the exit code is EXIT_FAILURE if any check failed
+*/
+
+//	a ROM with 16KB of PRG filled with fill and 8KB of CHR, followed by only size bytes of it if size is given, as a build still being written would be
+static void writeRom(const std::filesystem::path& file, uint8_t mapperID, uint8_t flags6, uint8_t fill, size_t size = 0x6000) {
+
+	std::vector<uint8_t> data(0x6000, fill);
+	const uint8_t header[16] = { 'N', 'E', 'S', 0x1A, 1, 1, (uint8_t)(((mapperID & 0x0F) << 4) | flags6), (uint8_t)(mapperID & 0xF0), 0, 0, 0, 0, 0, 0, 0, 0 };
+	std::ofstream output(file, std::ios::binary | std::ios::trunc);
+	output.write((const char*)header, sizeof(header));
+	output.write((const char*)data.data(), size);
+
+}
+
+static void checkReload() {
+
+	std::cout << "CartridgeClass::reload\n";
+
+	std::error_code error;
+	std::filesystem::path root = std::filesystem::temp_directory_path() / "nes_Cartridge_test";
+	std::filesystem::remove_all(root, error);
+	std::filesystem::create_directories(root, error);
+	std::string file = (root / "game.nes").u8string();
+
+	CartridgeClass cartridge;
+	writeRom(file, 0, 0x00, 0x11);
+	cartridge.storeMapper(selectMapper(cartridge.load(file, true)));
+	auto prgByte = [&]() { uint16_t address = 0x8000; return cartridge.prg_access(address, 0, false); };
+
+	//	the same header, so the new build goes in under the running game
+	writeRom(file, 0, 0x00, 0x22);
+	std::unique_ptr<romStruct> rom = CartridgeClass::readComplete(file);
+	check(rom != nullptr, "a whole build is read");
+	check(rom != nullptr && cartridge.reload(file, std::move(rom)), "a build with the same header is swapped in under the running game");
+	check(prgByte() == 0x22, "the swapped in build is what runs");
+
+	//	a build cut short is not read at all, and one the mappers cannot run leaves the running game alone
+	writeRom(file, 0, 0x00, 0x33, 0x100);
+	check(CartridgeClass::readComplete(file) == nullptr, "a build cut short is not read");
+
+	writeRom(file, 5, 0x00, 0x33);
+	bool refused = false;
+	try {
+
+		DeferExceptionLog quiet;
+		cartridge.reload(file, CartridgeClass::readComplete(file));
+
+	}
+	catch (const MapperException&) {
+
+		refused = true;
+
+	}
+	check(refused, "a build with an unsupported mapper is refused");
+	check(cartridge.loaded() && prgByte() == 0x22, "the running game carries on after a build with an unsupported mapper");
+
+	//	a different header, vertical mirroring here, replaces the running game
+	writeRom(file, 0, 0x01, 0x44);
+	rom = CartridgeClass::readComplete(file);
+	check(rom != nullptr && !cartridge.reload(file, std::move(rom)), "a build with a different header replaces the running game");
+	check(cartridge.loaded() && prgByte() == 0x44 && cartridge.getMirror() == mirrorEnum::VERTICAL, "the replacing build is what runs");
+
+	cartridge.unload();
+	std::filesystem::remove_all(root, error);
+
+}
+
+static std::vector<uint8_t> readFile(const std::filesystem::path& file) {
+
+	std::ifstream input(file, std::ios::binary);
+	return std::vector<uint8_t>(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+
+}
+
+static void checkSaves() {
+
+	std::cout << "CartridgeClass::save, SaveWriterClass\n";
+
+	//	saves go to .\saves, so this runs from a directory of its own
+	std::error_code error;
+	std::filesystem::path directory = std::filesystem::current_path();
+	std::filesystem::path root = std::filesystem::temp_directory_path() / "nes_Cartridge_test_saves";
+	std::filesystem::remove_all(root, error);
+	std::filesystem::create_directories(root, error);
+	std::filesystem::current_path(root);
+
+	{
+
+		//	only the latest of the saves queued for a file ends up in it, and a save that cannot be written is handed back
+		SaveWriterClass writer;
+		const uint8_t first[] = { 1, 2, 3 }, second[] = { 4, 5 };
+		writer.write("queued.sav", first, sizeof(first));
+		writer.write("queued.sav", second, sizeof(second));
+		writer.write((root / "missing" / "lost.sav").u8string(), first, sizeof(first));
+		writer.wait();
+		check(readFile("queued.sav") == std::vector<uint8_t>(second, second + sizeof(second)), "the latest save queued is what is written");
+		check(!std::filesystem::exists("queued.sav.tmp"), "nothing is left next to a written save");
+		std::vector<std::string> failures = writer.takeFailures();
+		check(failures.size() == 1 && failures[0].find("lost.sav") != std::string::npos, "a save that cannot be written is handed back");
+		check(writer.takeFailures().empty(), "a failure is only handed back once");
+
+	}
+
+	{
+
+		//	a battery backed game: what it writes to PRG RAM is in its save once save returns, and is there again when it is loaded next
+		CartridgeClass cartridge;
+		writeRom("battery.nes", 0, 0x02, 0x11);
+		cartridge.storeMapper(selectMapper(cartridge.load("battery.nes")));
+		check(!cartridge.getSaveFile().empty(), "a battery backed game has a save file");
+
+		uint16_t address = 0x6000;
+		cartridge.prg_access(address, 0x5A, true);
+		cartridge.save();
+		std::vector<uint8_t> saved = readFile(std::filesystem::u8path(cartridge.getSaveFile()));
+		check(saved.size() == 0x2000 && saved[0] == 0x5A, "save has written PRG RAM by the time it returns");
+
+		cartridge.storeMapper(selectMapper(cartridge.load("battery.nes")));
+		address = 0x6000;
+		check(cartridge.prg_access(address, 0, false) == 0x5A, "the save is loaded along with the game");
+
+	}
+
+	std::filesystem::current_path(directory);
+	std::filesystem::remove_all(root, error);
+
+}
 
 int main() {
 
+	checkSaves();
+	checkReload();
+
 	//	store the current working directory
 	std::string directory = std::filesystem::current_path().u8string();
 
@@ -20,12 +159,12 @@ int main() {
 		std::cout << "Failed to locate " << directory << "\\roms please make sure the directory exists and roms are located there to test.\n" << std::flush;
 		std::cout << "Press enter to continue...\n" << std::flush;
 		std::cin.get();
-		return EXIT_SUCCESS;
+		return failed ? EXIT_FAILURE : EXIT_SUCCESS;
 
 	}
 
 	CartridgeClass cartridge;
-	romStruct* rom = nullptr;
+	std::unique_ptr<romStruct> rom;
 
 	//	for-each loop through all files within directory\\roms
 	for (const auto& p : std::filesystem::directory_iterator(directory + "\\roms")) {
@@ -89,8 +228,7 @@ int main() {
 
 			}
 
-			delete rom;
-			rom = nullptr;
+			rom.reset();
 
 		}
 		catch (const CartridgeException& e) {
@@ -101,9 +239,12 @@ int main() {
 
 	}
 
+	if (failed)
+		std::cout << failed << " check(s) failed\n";
+
 	std::cout << "Press enter to continue...\n" << std::flush;
 	std::cin.get();
 
-	return EXIT_SUCCESS;
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
 
 }
\ No newline at end of file
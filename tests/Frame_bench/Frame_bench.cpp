@@ -0,0 +1,244 @@
+#include <iostream>		//	std::cout
+#include <algorithm>		//	std::max
+#include <cstdlib>		//	std::atoi
+#include <iomanip>		//	std::setw, std::setprecision
+#include <chrono>		//	std::chrono
+#include <memory>		//	std::unique_ptr
+
+#include "..\..\src\include\CPU.h"
+#include "..\..\src\include\PPU.h"
+#include "..\..\src\include\FrameSink.h"
+
+#include "..\..\src\include\Cartridge.h"
+#include "..\..\src\include\Mapper_Collection.h"
+#include "..\..\src\include\RomStruct.h"
+
+#include "..\TestHelpers.h"
+
+/*
+times whole frames with the PPU run on the CPU thread(lockstep) and on its own thread(see PPUPipeline.h): Frame_bench [scale]
+each program is a cartridge built in memory, so no ROM files are needed:
+	nmi	the main loop only does work on the CPU, the NMI handler does an OAM DMA and resets the scroll, as most games do(NROM)
+	sprite 0	as nmi, but the main loop polls $2002 for sprite 0 hit and writes the scroll once it is set, for a status bar split(NROM)
+	chr bank	as nmi, but the main loop keeps switching between 2 CHR banks that draw tile 1 in different colours, all over the frame(CNROM)
+	mirroring	as chr bank, but switching between the 2 single screen nametables, only one of which is filled with tile 1(AxROM)
+both modes have to produce the same frames, the exit code is EXIT_FAILURE if they did not, scale multiplies how many frames are run
+*/
+
+const uint16_t PRG_BASE = 0xC000;
+
+enum class Workload { NMI, SPRITE_0, CHR_BANK, MIRRORING };
+
+//	the background is tile 1 everywhere and sprite 0 is tile 1 at (100, 100), tile 1 being solid, so sprite 0 hits on every frame
+static Program assemble(Workload workload, uint16_t& nmi, uint16_t& reset) {
+
+	Program p(PRG_BASE);
+
+	reset = p.here();
+	p.emit(SEI);
+	p.emit(CLD);
+	p.emit(LDX_IMM, (uint8_t)0xFF);
+	p.emit(TXS);
+
+	//	the PPU needs 2 vblanks after power on before it takes writes
+	for (int i = 0; i < 2; i++) {
+
+		uint16_t wait = p.here();
+		p.emit(BIT_ABS, (uint16_t)0x2002);
+		p.branch(BPL, wait);
+
+	}
+
+	//	OAM at $0200, every sprite but sprite 0 off screen
+	p.emit(LDA_IMM, (uint8_t)0xFF);
+	p.emit(LDX_IMM, (uint8_t)0x00);
+	uint16_t oam = p.here();
+	p.emit(STA_ABX, (uint16_t)0x0200);
+	p.emit(INX);
+	p.branch(BNE, oam);
+	const uint8_t sprite0[] = { 100, 0x01, 0x00, 100 };
+	for (uint8_t i = 0; i < 4; i++) {
+
+		p.emit(LDA_IMM, sprite0[i]);
+		p.emit(STA_ABS, (uint16_t)(0x0200 + i));
+
+	}
+
+	//	nametable and attributes at $2000
+	p.emit(LDA_IMM, (uint8_t)0x20);
+	p.emit(STA_ABS, (uint16_t)0x2006);
+	p.emit(LDA_IMM, (uint8_t)0x00);
+	p.emit(STA_ABS, (uint16_t)0x2006);
+	p.emit(LDA_IMM, (uint8_t)0x01);
+	p.emit(LDX_IMM, (uint8_t)0x00);
+	p.emit(LDY_IMM, (uint8_t)0x04);
+	uint16_t nametable = p.here();
+	p.emit(STA_ABS, (uint16_t)0x2007);
+	p.emit(INX);
+	p.branch(BNE, nametable);
+	p.emit(DEY);
+	p.branch(BNE, nametable);
+
+	//	palettes
+	p.emit(LDA_IMM, (uint8_t)0x3F);
+	p.emit(STA_ABS, (uint16_t)0x2006);
+	p.emit(LDA_IMM, (uint8_t)0x00);
+	p.emit(STA_ABS, (uint16_t)0x2006);
+	p.emit(LDX_IMM, (uint8_t)0x00);
+	uint16_t palette = p.here();
+	p.emit(TXA);
+	p.emit(STA_ABS, (uint16_t)0x2007);
+	p.emit(INX);
+	p.emit(CPX_IMM, (uint8_t)0x20);
+	p.branch(BNE, palette);
+
+	p.emit(LDA_IMM, (uint8_t)0x00);
+	p.emit(STA_ABS, (uint16_t)0x2005);
+	p.emit(STA_ABS, (uint16_t)0x2005);
+	p.emit(LDA_IMM, (uint8_t)0x80);		//	NMI on
+	p.emit(STA_ABS, (uint16_t)0x2000);
+	p.emit(LDA_IMM, (uint8_t)0x1E);		//	background and sprites on, left column included
+	p.emit(STA_ABS, (uint16_t)0x2001);
+
+	uint16_t loop = p.here();
+	if (workload == Workload::SPRITE_0) {
+
+		//	wait for the hit from the last frame to clear, then for this frame's, and split the scroll there
+		uint16_t cleared = p.here();
+		p.emit(BIT_ABS, (uint16_t)0x2002);
+		p.branch(BVS, cleared);
+		uint16_t hit = p.here();
+		p.emit(BIT_ABS, (uint16_t)0x2002);
+		p.branch(BVC, hit);
+		p.emit(LDA_ABS, (uint16_t)0x0012);
+		p.emit(STA_ABS, (uint16_t)0x2005);
+		p.emit(LDA_IMM, (uint8_t)0x00);
+		p.emit(STA_ABS, (uint16_t)0x2005);
+		p.emit(INC_ABS, (uint16_t)0x0012);
+
+	}
+	else if (workload == Workload::CHR_BANK || workload == Workload::MIRRORING) {
+
+		//	CNROM picks the CHR bank with bit 0, AxROM the nametable with bit 4(leaving bits 0 to 2, the PRG bank, at 0)
+		p.emit(INC_ABS, (uint16_t)0x0010);
+		p.emit(LDA_ABS, (uint16_t)0x0010);
+		p.emit(AND_IMM, (uint8_t)((workload == Workload::CHR_BANK) ? 0x01 : 0x10));
+		p.emit(STA_ABS, (uint16_t)0x8000);
+
+	}
+	else {
+
+		p.emit(INC_ABS, (uint16_t)0x0010);
+		p.emit(LDA_ABS, (uint16_t)0x0010);
+		p.emit(CLC);
+		p.emit(ADC_ABS, (uint16_t)0x0011);
+		p.emit(STA_ABS, (uint16_t)0x0011);
+
+	}
+	p.emit(JMP_ABS, loop);
+
+	nmi = p.here();
+	p.emit(PHA);
+	p.emit(LDA_IMM, (uint8_t)0x02);
+	p.emit(STA_ABS, (uint16_t)0x4014);
+	p.emit(LDA_IMM, (uint8_t)0x00);
+	p.emit(STA_ABS, (uint16_t)0x2005);
+	p.emit(STA_ABS, (uint16_t)0x2005);
+	p.emit(PLA);
+	p.emit(RTI);
+
+	return p;
+
+}
+
+static std::unique_ptr<romStruct> buildRom(Workload workload) {
+
+	std::unique_ptr<romStruct> rom;
+	if (workload == Workload::CHR_BANK)
+		rom = buildRom(3, 0x4000, 0x4000);
+	else if (workload == Workload::MIRRORING)
+		rom = buildRom(7, 0x8000, 0x2000);
+	else
+		rom = buildRom(0, 0x4000, 0x2000);
+
+	//	the IRQ vector points at the RTI that ends the NMI handler
+	uint16_t nmi = 0, reset = 0;
+	Program program = assemble(workload, nmi, reset);
+	program.store(*rom, nmi, reset, (uint16_t)(program.here() - 1));
+
+	//	tile 1 is colour 1 in every pixel, and colour 2 in the second CHR bank when there is one
+	for (size_t i = 0x10; i < 0x18; i++)
+		rom->chr_rom[i] = 0xFF;
+	if (rom->chr_rom.size() > 0x2000)
+		for (size_t i = 0x2018; i < 0x2020; i++)
+			rom->chr_rom[i] = 0xFF;
+
+	return rom;
+
+}
+
+struct FrameRun {
+
+	double seconds;
+	uint64_t hash;
+	uint32_t frames;
+
+};
+
+static FrameRun run(Workload workload, bool pipelined, uint32_t frames) {
+
+	CartridgeClass cartridge;
+	CPUClass cpu;
+	PPUClass ppu;
+	FrameHashSinkClass sink;
+
+	cartridge.storeMapper(selectMapper(buildRom(workload)));
+	cpu.loadCartridge(&cartridge);
+	cpu.loadPPU(&ppu);
+	ppu.loadCartridge(&cartridge);
+	ppu.loadCPU(&cpu);
+	ppu.loadFrameSink(&sink);
+	ppu.reset();
+	cpu.reset();
+	cpu.setPipelined(pipelined);
+
+	auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < frames; i++)
+		cpu.runFrame();
+	std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+	return { seconds.count(), sink.getHash(), sink.getFrameCount() };
+
+}
+
+int main(int argc, char* argv[]) {
+
+	uint32_t scale = (argc > 1) ? (uint32_t)std::max(1, std::atoi(argv[1])) : 1;
+	const uint32_t FRAMES = scale * 1200;
+
+	const struct { Workload workload; const char* name; } workloads[] = {
+
+		{ Workload::NMI, "nmi" },
+		{ Workload::SPRITE_0, "sprite 0" },
+		{ Workload::CHR_BANK, "chr bank" },
+		{ Workload::MIRRORING, "mirroring" },
+
+	};
+
+	for (auto& w : workloads) {
+
+		FrameRun lockstep = run(w.workload, false, FRAMES);
+		FrameRun pipelined = run(w.workload, true, FRAMES);
+
+		std::cout << std::left << std::setw(10) << w.name << std::right << std::fixed << std::setprecision(3)
+			<< "lockstep " << std::setw(8) << (lockstep.seconds * 1e3 / FRAMES) << " ms/frame, "
+			<< "pipelined " << std::setw(8) << (pipelined.seconds * 1e3 / FRAMES) << " ms/frame, "
+			<< std::setprecision(2) << (lockstep.seconds / pipelined.seconds) << "x\n" << std::flush;
+
+		check(lockstep.hash == pipelined.hash && lockstep.frames == pipelined.frames, "the pipelined frames match the lockstep ones");
+
+	}
+
+	return checkResult();
+
+}
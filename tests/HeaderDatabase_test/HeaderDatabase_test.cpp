@@ -0,0 +1,123 @@
+#include <iostream>		//	std::cout
+#include <memory>		//	std::unique_ptr
+#include <random>		//	std::mt19937
+#include <vector>		//	std::vector
+#include <string>		//	std::string
+#include <unordered_set>	//	std::unordered_set
+
+#include "..\..\src\include\HeaderDatabase.h"
+#include "..\TestHelpers.h"
+
+/*
+checks the header database: HeaderDatabase_test
+a perfect hash table is built from thousands of made up CRCs, every one of them has to be found and nothing else may be,
+then the shipped database is looked up for the test ROMs it has entries for, and for ones it has not
+the exit code is EXIT_FAILURE if any check failed
+*/
+
+//	big enough that most buckets have several CRCs in them, and some seeds have to be tried many times
+const size_t TABLE_SIZE = 4000;
+
+static void checkTable() {
+
+	std::cout << "HeaderTable, " << TABLE_SIZE << " entries\n";
+
+	std::mt19937 random(0x4E45531A);
+	std::unordered_set<uint32_t> used;
+	std::vector<HeaderFix> fixes(TABLE_SIZE);
+	for (size_t i = 0; i < TABLE_SIZE; i++) {
+
+		do
+			fixes[i].crc32 = random();
+		while (!used.insert(fixes[i].crc32).second);
+		fixes[i].mapperID = (uint16_t)i;
+
+	}
+
+	//	too big for the stack, the table is built at runtime here, by the same constructor the compiler runs for the real one
+	std::unique_ptr<HeaderTable<TABLE_SIZE>> table = std::make_unique<HeaderTable<TABLE_SIZE>>(fixes.data());
+
+	uint32_t missing = 0;
+	for (size_t i = 0; i < TABLE_SIZE; i++) {
+
+		const HeaderFix* fix = table->find(fixes.data(), fixes[i].crc32);
+		if (fix != &fixes[i])
+			missing++;
+
+	}
+	check(missing == 0, std::to_string(missing) + " CRCs were not found, or found the wrong entry");
+
+	uint32_t found = 0, misses = 0;
+	while (misses < 100000) {
+
+		uint32_t crc = random();
+		if (used.count(crc))
+			continue;
+		if (table->find(fixes.data(), crc) != nullptr)
+			found++;
+		misses++;
+
+	}
+	check(found == 0, std::to_string(found) + " CRCs that are not in the table were found");
+
+	//	CRCs that are already in the table more than once cannot be placed
+	fixes[1].crc32 = fixes[0].crc32;
+	bool refused = false;
+	try {
+
+		table = std::make_unique<HeaderTable<TABLE_SIZE>>(fixes.data());
+
+	}
+	catch (const char*) {
+
+		refused = true;
+
+	}
+	check(refused, "a CRC in the table twice is refused");
+
+}
+
+static void checkDatabase() {
+
+	std::cout << "findHeaderFix\n";
+
+	//	apu_phase_reset.nes says NES 2.0 with no CHR at all, the fix has to give it 8KB of CHR RAM
+	const HeaderFix* fix = findHeaderFix(0xA3AEA142);
+	check(fix != nullptr && fix->crc32 == 0xA3AEA142, "apu_phase_reset.nes is found");
+	if (fix != nullptr) {
+
+		romHeaderStruct header = {};
+		header.prgRomSizeLSB = 1;
+		header.flags7 = 0b00001000;
+		header.timing = 2;
+		applyHeaderFix(header, *fix);
+
+		check(header.prgRomSizeLSB == 1 && header.chrRomSizeLSB == 0, "the fix keeps the ROM sizes");
+		check((header.flags7 & 0b00001100) == 0b00001000, "the fixed header is NES 2.0");
+		check(header.chrRamSize == 7 && header.prgRamSize == 0, "the fixed header has 8KB of CHR RAM and no PRG RAM");
+		check(header.timing == 0 && (header.flags6 & 0b00001001) == 0, "the fixed header is NTSC with horizontal mirroring");
+
+	}
+
+	for (uint32_t crc : { 0x02328D92u, 0xDA59B973u }) {
+
+		fix = findHeaderFix(crc);
+		check(fix != nullptr && fix->mapperID == 1 && fix->prgRamShift == 7 && fix->chrRamShift == 7, "blargg's instr_test-v5 ROM is found, with 8KB of PRG RAM and CHR RAM");
+
+	}
+
+	//	nestest.nes and the Mapper_test ROM have nothing wrong with their headers
+	check(findHeaderFix(0xD8B63205) == nullptr, "nestest.nes is not found");
+	check(findHeaderFix(0x654EC82D) == nullptr, "Mapper_test's test.nes is not found");
+	check(findHeaderFix(0) == nullptr, "a CRC of 0 is not found");
+
+}
+
+int main() {
+
+	checkTable();
+	checkDatabase();
+
+	return checkResult();
+
+}
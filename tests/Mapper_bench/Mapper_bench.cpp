@@ -0,0 +1,600 @@
+#include <iostream>		//	std::cout, std::cerr
+#include <algorithm>		//	std::max
+#include <cstdlib>		//	std::atoi
+#include <iomanip>		//	std::setw, std::setprecision
+#include <chrono>		//	std::chrono
+#include <random>		//	std::mt19937
+#include <vector>		//	std::vector
+#include <string>		//	std::string
+#include <sstream>		//	std::ostringstream
+#include <memory>		//	std::unique_ptr
+
+#include "..\..\src\include\Mapper_Collection.h"
+#include "..\..\src\include\RomStruct.h"
+
+#include "..\..\src\include\custom_exceptions.h"
+#include "..\TestHelpers.h"
+
+/*
+benchmarks and stress tests every mapper in Mapper_Collection: Mapper_bench [scale]
+each mapper is given a cartridge built in memory, so no ROM files are needed, and then:
+	a bank switch storm is written to it, and after every single write what the CPU and PPU see is checked against a reference model of the board
+	PRG reads, CHR reads and decoded tile rows are timed with sequential and random addresses
+	the storm is timed on its own, as bank switches per second
+the reference models are written from the nesdev.com documentation for each board, and share nothing with the mappers they check
+scale multiplies how long each benchmark runs for, the exit code is EXIT_FAILURE if any mapping did not match
+*/
+
+//	every 1KB of PRG and CHR starts with its own index, so a read of the first 2 bytes says which 1KB is mapped there, the rest is filler that differs between them
+static uint8_t pattern(size_t offset) {
+
+	if ((offset & 0x03FF) < 2)
+		return (uint8_t)((offset >> 10) >> ((offset & 0x01) * 8));
+	return (uint8_t)(((uint32_t)offset * 0x9E3779B1u) >> 24);
+
+}
+
+//	a cartridge to build in memory, sizes are in bytes, and must be powers of 2 so the reference models can wrap banks by masking
+struct BenchCart {
+
+	uint8_t mapperID;
+	const char* board;
+	size_t prgSize;
+	size_t chrSize;							//	0 means 8KB of CHR RAM
+	mirrorEnum mirroring;
+
+};
+
+static std::unique_ptr<romStruct> buildRom(const BenchCart& cart) {
+
+	std::unique_ptr<romStruct> rom = buildRom(cart.mapperID, cart.prgSize, cart.chrSize, cart.mirroring);
+	for (size_t i = 0; i < rom->prg_rom.size(); i++)
+		rom->prg_rom[i] = pattern(i);
+	for (size_t i = 0; i < rom->chr_rom.size(); i++)
+		rom->chr_rom[i] = pattern(i);
+
+	return rom;
+
+}
+
+//	a register write, in the order the game would make them
+struct BenchWrite {
+
+	uint16_t address;
+	uint8_t data;
+
+};
+
+/*
+what the board maps where, as the documentation describes it
+units are 1KB into PRG or CHR ROM, before being wrapped to the size of the ROM
+*/
+class ReferenceModel {
+
+public:
+	ReferenceModel(const BenchCart& cart) : prgUnits((uint32_t)(cart.prgSize / 0x0400)), mirroring(cart.mirroring) {}
+	virtual ~ReferenceModel() {}
+
+	virtual void write(uint16_t, uint8_t) {}
+	virtual uint32_t prgUnit(uint16_t address) = 0;
+	virtual uint32_t chrUnit(uint16_t address) { return address >> 10; }
+	mirrorEnum mirror() { return this->mirroring; }
+
+	//	a storm of register writes the board would see from a game, starting from power on
+	virtual std::vector<BenchWrite> storm(std::mt19937& random, size_t count);
+
+protected:
+	uint32_t prgUnits;
+	mirrorEnum mirroring;
+
+};
+
+std::vector<BenchWrite> ReferenceModel::storm(std::mt19937& random, size_t count) {
+
+	std::vector<BenchWrite> writes(count);
+	for (BenchWrite& write : writes)
+		write = { (uint16_t)(0x8000 | (random() & 0x7FFF)), (uint8_t)random() };
+	return writes;
+
+}
+
+//	https://wiki.nesdev.com/w/index.php/NROM
+class NromModel : public ReferenceModel {
+
+public:
+	using ReferenceModel::ReferenceModel;
+
+	uint32_t prgUnit(uint16_t address) override { return (address & 0x7FFF) >> 10; }
+
+};
+
+//	https://wiki.nesdev.com/w/index.php/MMC1
+class Mmc1Model : public ReferenceModel {
+
+public:
+	using ReferenceModel::ReferenceModel;
+
+	void write(uint16_t address, uint8_t data) override {
+
+		//	bit 7 empties the shift register and sets PRG mode 3
+		if (data & 0x80) {
+
+			this->shift = this->count = 0;
+			this->setControl(this->control | 0x0C);
+			return;
+
+		}
+
+		//	5 writes fill the shift register LSB first, the 5th picks the register by its address
+		this->shift = (uint8_t)(this->shift | ((data & 0x01) << this->count));
+		if (++this->count < 5)
+			return;
+
+		switch ((address >> 13) & 0x03) {
+
+		case 0: this->setControl(this->shift); break;
+		case 1: this->chr0 = this->shift; break;
+		case 2: this->chr1 = this->shift; break;
+		case 3: this->prg = this->shift; break;
+
+		}
+		this->shift = this->count = 0;
+
+	}
+
+	uint32_t prgUnit(uint16_t address) override {
+
+		uint32_t bank = 0, last = this->prgUnits / 16 - 1;
+		bool high = address >= 0xC000;
+		switch ((this->control >> 2) & 0x03) {
+
+		case 0:
+		case 1: bank = (this->prg & 0x0E) | (high ? 1 : 0); break;
+		case 2: bank = high ? (this->prg & 0x0F) : 0; break;
+		case 3: bank = high ? last : (this->prg & 0x0F); break;
+
+		}
+		return bank * 16 + ((address & 0x3FFF) >> 10);
+
+	}
+
+	uint32_t chrUnit(uint16_t address) override {
+
+		bool high = address >= 0x1000;
+		uint32_t bank = (this->control & 0x10) ? (high ? this->chr1 : this->chr0) : ((this->chr0 & 0x1E) | (high ? 1 : 0));
+		return bank * 4 + ((address & 0x0FFF) >> 10);
+
+	}
+
+	//	registers are written 1 bit at a time, with the occasional reset in between, the same as games do when they bank switch from an interrupt
+	std::vector<BenchWrite> storm(std::mt19937& random, size_t count) override {
+
+		std::vector<BenchWrite> writes;
+		writes.push_back({ 0x8000, 0x80 });
+		while (writes.size() < count) {
+
+			uint16_t address = (uint16_t)(0x8000 | (random() & 0x7FFF));
+			if ((random() & 0x0F) == 0) {
+
+				writes.push_back({ address, (uint8_t)(0x80 | random()) });
+				continue;
+
+			}
+
+			//	the other data bits are ignored, so they are filled with noise to make sure of that
+			uint8_t value = (uint8_t)random();
+			for (uint8_t i = 0; i < 5 && writes.size() < count; i++)
+				writes.push_back({ address, (uint8_t)((((value >> i) & 0x01) | (random() & 0x7E))) });
+
+		}
+		return writes;
+
+	}
+
+private:
+	uint8_t shift = 0;
+	uint8_t count = 0;
+	uint8_t control = 0x0C;					//	PRG mode 3 at power on, the mirroring stays as the header says until the first control write
+	uint8_t chr0 = 0;
+	uint8_t chr1 = 0;
+	uint8_t prg = 0;
+
+	void setControl(uint8_t value) {
+
+		static const mirrorEnum modes[4] = { mirrorEnum::SINGLEA, mirrorEnum::SINGLEB, mirrorEnum::VERTICAL, mirrorEnum::HORIZONTAL };
+		this->control = value;
+		this->mirroring = modes[value & 0x03];
+
+	}
+
+};
+
+//	https://wiki.nesdev.com/w/index.php/UxROM
+class UxromModel : public ReferenceModel {
+
+public:
+	using ReferenceModel::ReferenceModel;
+
+	void write(uint16_t, uint8_t data) override { this->bank = data & 0x0F; }
+	uint32_t prgUnit(uint16_t address) override { return ((address >= 0xC000) ? (this->prgUnits / 16 - 1) : this->bank) * 16 + ((address & 0x3FFF) >> 10); }
+
+private:
+	uint32_t bank = 0;
+
+};
+
+//	https://wiki.nesdev.com/w/index.php/CNROM
+class CnromModel : public ReferenceModel {
+
+public:
+	using ReferenceModel::ReferenceModel;
+
+	void write(uint16_t, uint8_t data) override { this->bank = data & 0x03; }
+	uint32_t prgUnit(uint16_t address) override { return (address & 0x7FFF) >> 10; }
+	uint32_t chrUnit(uint16_t address) override { return this->bank * 8 + (address >> 10); }
+
+private:
+	uint32_t bank = 0;
+
+};
+
+//	https://wiki.nesdev.com/w/index.php/MMC3
+class Mmc3Model : public ReferenceModel {
+
+public:
+	using ReferenceModel::ReferenceModel;
+
+	void write(uint16_t address, uint8_t data) override {
+
+		switch (address & 0xE001) {
+
+		case 0x8000: this->select = data; break;
+		case 0x8001: this->r[this->select & 0x07] = data; break;
+		case 0xA000: this->mirroring = (data & 0x01) ? mirrorEnum::HORIZONTAL : mirrorEnum::VERTICAL; break;
+
+		}
+
+	}
+
+	uint32_t prgUnit(uint16_t address) override {
+
+		uint32_t secondLast = this->prgUnits / 8 - 2, bank = 0;
+		bool swapped = (this->select & 0x40) != 0;
+		switch ((address >> 13) & 0x03) {
+
+		case 0: bank = swapped ? secondLast : (this->r[6] & 0x3F); break;
+		case 1: bank = this->r[7] & 0x3F; break;
+		case 2: bank = swapped ? (this->r[6] & 0x3F) : secondLast; break;
+		case 3: bank = secondLast + 1; break;
+
+		}
+		return bank * 8 + ((address & 0x1FFF) >> 10);
+
+	}
+
+	uint32_t chrUnit(uint16_t address) override {
+
+		//	with A12 inverted, the 2KB banks are at 0x1000 and the 1KB banks at 0x0000
+		uint16_t a = (uint16_t)(address ^ ((this->select & 0x80) ? 0x1000 : 0x0000));
+		if (a < 0x1000)
+			return (this->r[a >> 11] & 0xFE) | ((a >> 10) & 0x01);
+		return this->r[2 + ((a - 0x1000) >> 10)];
+
+	}
+
+	//	mostly bank select and bank data pairs, the way games switch banks, with mirroring and IRQ writes in between
+	std::vector<BenchWrite> storm(std::mt19937& random, size_t count) override {
+
+		static const uint16_t others[6] = { 0xA000, 0xA001, 0xC000, 0xC001, 0xE000, 0xE001 };
+		std::vector<BenchWrite> writes;
+		while (writes.size() < count) {
+
+			uint16_t mirror = (uint16_t)(random() & 0x1FFE);
+			if (random() & 0x03) {
+
+				writes.push_back({ (uint16_t)(0x8000 | mirror), (uint8_t)random() });
+				writes.push_back({ (uint16_t)(0x8001 | mirror), (uint8_t)random() });
+
+			}
+			else
+				writes.push_back({ (uint16_t)(others[random() % 6] | mirror), (uint8_t)random() });
+
+		}
+		writes.resize(count);
+		return writes;
+
+	}
+
+private:
+	uint8_t select = 0;
+	uint8_t r[8] = { 0, 2, 4, 5, 6, 7, 0, 1 };	//	registers are undefined at power on, these are what Mapper004 starts with
+
+};
+
+//	https://wiki.nesdev.com/w/index.php/AxROM
+class AxromModel : public ReferenceModel {
+
+public:
+	AxromModel(const BenchCart& cart) : ReferenceModel(cart) { this->mirroring = mirrorEnum::SINGLEA; }
+
+	void write(uint16_t, uint8_t data) override {
+
+		this->bank = data & 0x07;
+		this->mirroring = (data & 0x10) ? mirrorEnum::SINGLEB : mirrorEnum::SINGLEA;
+
+	}
+	uint32_t prgUnit(uint16_t address) override { return this->bank * 32 + ((address & 0x7FFF) >> 10); }
+
+private:
+	uint32_t bank = 0;
+
+};
+
+static std::unique_ptr<ReferenceModel> buildModel(const BenchCart& cart) {
+
+	switch (cart.mapperID) {
+
+	case 0: return std::make_unique<NromModel>(cart);
+	case 1: return std::make_unique<Mmc1Model>(cart);
+	case 2: return std::make_unique<UxromModel>(cart);
+	case 3: return std::make_unique<CnromModel>(cart);
+	case 4: return std::make_unique<Mmc3Model>(cart);
+	case 7: return std::make_unique<AxromModel>(cart);
+
+	}
+	return nullptr;
+
+}
+
+static std::string hex(uint32_t value) {
+
+	std::ostringstream stream;
+	stream << "0x" << std::hex << std::uppercase << value;
+	return stream.str();
+
+}
+
+//	a tile row decoded straight from CHR data, the same way TileCacheClass does it
+static TileRow decodeRow(const uint8_t* chr, size_t offset, bool flip) {
+
+	TileRow row;
+	for (uint8_t x = 0; x < 8; x++) {
+
+		uint8_t bit = flip ? x : 7 - x;
+		row.pixels[x] = (uint8_t)(((chr[offset] >> bit) & 0x01) | (((chr[offset + 8] >> bit) & 0x01) << 1));
+		row.packed = (uint16_t)((row.packed << 2) | row.pixels[x]);
+
+	}
+	return row;
+
+}
+
+/*
+checks every 1KB the CPU and PPU can see against the model, through prg_read, chr_read and chr_tile_row, and the mirroring
+probe is a byte within each 1KB that changes between calls, so over a storm every byte of a window gets looked at
+returns what did not match, or an empty string
+*/
+static std::string verify(MapperClass& mapper, ReferenceModel& model, uint16_t probe) {
+
+	const uint8_t* prg = mapper.get_prm_rom();
+	const uint8_t* chr = mapper.get_chr_rom();
+	uint32_t prgUnits = (uint32_t)(mapper.get_prm_rom_size() / 0x0400), chrUnits = (uint32_t)(mapper.get_chr_rom_size() / 0x0400);
+
+	for (uint32_t unit = 0; unit < 32; unit++) {
+
+		uint16_t base = (uint16_t)(0x8000 + unit * 0x0400);
+		size_t expected = (size_t)(model.prgUnit(base) & (prgUnits - 1)) * 0x0400;
+		for (uint16_t offset : { (uint16_t)0, (uint16_t)1, (uint16_t)(probe & 0x03FF) }) {
+
+			uint16_t address = (uint16_t)(base + offset);
+			if (mapper.prg_read(address) != prg[expected + offset])
+				return "PRG at " + hex(address) + " reads 1KB bank " + std::to_string(mapper.prgRead(base) | (mapper.prgRead((uint16_t)(base + 1)) << 8)) + ", expected " + std::to_string(expected / 0x0400);
+
+		}
+
+	}
+
+	for (uint32_t unit = 0; unit < 8; unit++) {
+
+		uint16_t base = (uint16_t)(unit * 0x0400);
+		size_t expected = (size_t)(model.chrUnit(base) & (chrUnits - 1)) * 0x0400;
+		for (uint16_t offset : { (uint16_t)0, (uint16_t)1, (uint16_t)(probe & 0x03FF) }) {
+
+			uint16_t address = (uint16_t)(base + offset);
+			if (mapper.chr_read(address) != chr[expected + offset])
+				return "CHR at " + hex(address) + " reads 1KB bank " + std::to_string(mapper.chrRead(base) | (mapper.chrRead((uint16_t)(base + 1)) << 8)) + ", expected " + std::to_string(expected / 0x0400);
+
+		}
+
+		//	the decoded tiles have to follow the bank switch too
+		uint16_t row = (uint16_t)((probe & 0x03F7) & ~0x0008);
+		bool flip = (probe & 0x0400) != 0;
+		if (mapper.chr_tile_row((uint16_t)(base + row), flip).packed != decodeRow(chr, expected + row, flip).packed)
+			return "tile row at " + hex(base + row) + " was not decoded from 1KB bank " + std::to_string(expected / 0x0400);
+
+	}
+
+	if (mapper.getMirror() != model.mirror())
+		return "mirroring is " + std::to_string(mapper.getMirror()) + ", expected " + std::to_string(model.mirror());
+
+	return "";
+
+}
+
+//	keeps the compiler from throwing away reads whose result is never used
+static volatile uint32_t sink = 0;
+
+//	runs fn and prints how many of whatever it did per second
+template <typename F> static void bench(const char* name, double count, const char* unit, F fn) {
+
+	auto start = std::chrono::steady_clock::now();
+	sink = sink + fn();
+	std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+	std::cout << "    " << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1) << std::setw(10) << (count / seconds.count() / 1e6) << " M" << unit << "/s\n" << std::flush;
+
+}
+
+int main(int argc, char* argv[]) {
+
+	uint32_t scale = (argc > 1) ? (uint32_t)std::max(1, std::atoi(argv[1])) : 1;
+
+	//	one of each board Mapper_Collection has a mapper for, at the largest size the mapper supports, along with the CHR RAM variants
+	const BenchCart carts[] = {
+
+		{ 0, "NROM-128", 0x04000, 0x02000, mirrorEnum::HORIZONTAL },
+		{ 0, "NROM-256", 0x08000, 0x02000, mirrorEnum::VERTICAL },
+		{ 1, "SKROM", 0x40000, 0x20000, mirrorEnum::HORIZONTAL },
+		{ 1, "SNROM", 0x40000, 0, mirrorEnum::HORIZONTAL },
+		{ 2, "UOROM", 0x40000, 0, mirrorEnum::VERTICAL },
+		{ 3, "CNROM", 0x08000, 0x08000, mirrorEnum::HORIZONTAL },
+		{ 4, "TLROM", 0x80000, 0x40000, mirrorEnum::VERTICAL },
+		{ 4, "TGROM", 0x80000, 0, mirrorEnum::VERTICAL },
+		{ 7, "AOROM", 0x40000, 0, mirrorEnum::HORIZONTAL },
+
+	};
+
+	const size_t STORM_SIZE = 0x10000;
+	const size_t READS = (size_t)scale << 24;
+
+	std::mt19937 random(0x4E45531A);
+	std::vector<uint16_t> prgAddresses(0x10000), chrAddresses(0x10000);
+	for (uint16_t& address : prgAddresses)
+		address = (uint16_t)(0x8000 | (random() & 0x7FFF));
+	for (uint16_t& address : chrAddresses)
+		address = (uint16_t)(random() & 0x1FFF);
+
+	uint32_t mismatched = 0;
+	for (const BenchCart& cart : carts) {
+
+		std::cout << "Mapper " << std::setw(3) << (uint32_t)cart.mapperID << " " << cart.board << ", " << (cart.prgSize / 1024) << "KB PRG, ";
+		if (cart.chrSize)
+			std::cout << (cart.chrSize / 1024) << "KB CHR\n";
+		else
+			std::cout << "8KB CHR RAM\n";
+
+		std::unique_ptr<MapperClass> mapper;
+		std::unique_ptr<ReferenceModel> model = buildModel(cart);
+		try {
+
+			mapper = selectMapper(buildRom(cart));
+
+		}
+		catch (const std::exception& e) {
+
+			std::cout << "    " << e.what() << '\n';
+			mismatched++;
+			continue;
+
+		}
+
+		//	correctness first, after every single write of the storm
+		std::vector<BenchWrite> storm = model->storm(random, STORM_SIZE);
+		std::string mismatch = verify(*mapper, *model, 0);
+		size_t checked = 0;
+		for (; checked < storm.size() && mismatch.empty(); checked++) {
+
+			mapper->prg_write(storm[checked].address, storm[checked].data);
+			model->write(storm[checked].address, storm[checked].data);
+			mismatch = verify(*mapper, *model, (uint16_t)(checked * 0x0123));
+
+		}
+
+		if (mismatch.empty())
+			std::cout << "    " << std::left << std::setw(24) << "bank mappings" << std::right << std::setw(10) << checked << " writes checked\n";
+		else {
+
+			if (checked == 0)
+				std::cout << "    FAILED at power on: " << mismatch << '\n';
+			else
+				std::cout << "    FAILED after write " << checked << " (" << hex(storm[checked - 1].address) << " = " << hex(storm[checked - 1].data) << "): " << mismatch << '\n';
+			mismatched++;
+
+		}
+
+		bench("PRG sequential", (double)READS, "B", [&]() {
+
+			uint32_t sum = 0;
+			for (size_t i = 0; i < READS; i += 0x8000)
+				for (uint32_t a = 0x8000; a < 0x10000; a++) {
+
+					uint16_t address = (uint16_t)a;
+					sum += mapper->prg_read(address);
+
+				}
+			return sum;
+
+		});
+		bench("PRG random", (double)READS, "B", [&]() {
+
+			uint32_t sum = 0;
+			for (size_t i = 0; i < READS; i++)
+				sum += mapper->prg_read(prgAddresses[i & 0xFFFF]);
+			return sum;
+
+		});
+		bench("CHR sequential", (double)READS, "B", [&]() {
+
+			uint32_t sum = 0;
+			for (size_t i = 0; i < READS; i += 0x2000)
+				for (uint16_t address = 0; address < 0x2000; address++)
+					sum += mapper->chr_read(address);
+			return sum;
+
+		});
+		bench("CHR random", (double)READS, "B", [&]() {
+
+			uint32_t sum = 0;
+			for (size_t i = 0; i < READS; i++)
+				sum += mapper->chr_read(chrAddresses[i & 0xFFFF]);
+			return sum;
+
+		});
+		bench("tile rows random", (double)(READS / 4), "rows", [&]() {
+
+			uint32_t sum = 0;
+			for (size_t i = 0; i < READS / 4; i++)
+				sum += mapper->chr_tile_row(chrAddresses[i & 0xFFFF], i & 0x01).packed;
+			return sum;
+
+		});
+
+		//	every storm write is a register write, so a bank switch or a step of one, and each one throws the decoded tiles of any CHR it moves away
+		size_t passes = (size_t)scale * 64;
+		bench("bank switch storm", (double)(passes * storm.size()), "writes", [&]() {
+
+			for (size_t pass = 0; pass < passes; pass++)
+				for (BenchWrite& write : storm)
+					mapper->prg_write(write.address, write.data);
+			return (uint32_t)mapper->getMirror();
+
+		});
+		bench("storm + tile rows", (double)(passes / 8 * storm.size()), "writes", [&]() {
+
+			//	the switch, followed by the PPU fetching a row out of every 1KB, as a mid-frame switch would
+			uint32_t sum = 0;
+			for (size_t pass = 0; pass < passes / 8; pass++)
+				for (BenchWrite& write : storm) {
+
+					mapper->prg_write(write.address, write.data);
+					for (uint16_t address = 0; address < 0x2000; address += 0x0400)
+						sum += mapper->chr_tile_row(address, false).packed;
+
+				}
+			return sum;
+
+		});
+
+	}
+
+	if (mismatched) {
+
+		std::cout << mismatched << " mapper(s) did not match their reference model\n";
+		return EXIT_FAILURE;
+
+	}
+
+	std::cout << "Every mapper matched its reference model\n";
+	return EXIT_SUCCESS;
+
+}
@@ -2,14 +2,78 @@
 #include <iostream>		//	std::cout, std::cerr, std::clog
 #include <iomanip>
 #include <assert.h>		//	assert()
+#include <string>		//	std::string
 
 #include "..\..\src\include\Mapper_Collection.h"
 #include "..\..\src\include\Cartridge.h"
 #include "..\..\src\include\RomStruct.h"
 
 #include "..\..\src\include\custom_exceptions.h"
+#include "..\TestHelpers.h"
 
-int main(int argc, char* argv[]) {
+/*
+checks the mappers against their documentation with cartridges built in memory, then loads every ROM in .\roms and checks a mapper is found for it: Mapper_test
+the exit code is EXIT_FAILURE if any check failed
+*/
+
+//	every byte of a 16KB PRG bank holds its bank number, and every byte of a 4KB CHR bank its own, so a single read says what is mapped where
+static std::unique_ptr<MapperClass> buildMapper(uint8_t mapperID, size_t prgSize, size_t chrSize) {
+
+	std::unique_ptr<romStruct> rom = buildRom(mapperID, prgSize, chrSize);
+	for (size_t i = 0; i < prgSize; i++)
+		rom->prg_rom[i] = (uint8_t)(i >> 14);
+	for (size_t i = 0; i < chrSize; i++)
+		rom->chr_rom[i] = (uint8_t)(i >> 12);
+
+	return selectMapper(std::move(rom));
+
+}
+
+//	the MMC1 takes its registers 1 bit at a time, 5 writes to the same register, low bit first
+static void serialWrite(MapperClass& mapper, uint16_t address, uint8_t value) {
+
+	for (uint8_t i = 0; i < 5; i++)
+		mapper.prg_write(address, (uint8_t)((value >> i) & 0x01));
+
+}
+
+//	see: https://wiki.nesdev.com/w/index.php/MMC1
+static void checkMapper001() {
+
+	std::cout << "Mapper001\n";
+
+	//	256KB PRG(16 banks) and 128KB CHR(32 4KB banks)
+	std::unique_ptr<MapperClass> mapper = buildMapper(1, 0x40000, 0x20000);
+	check(mapper->prgRead(0x8000) == 0 && mapper->prgRead(0xC000) == 15, "at power on, PRG bank 0 is at 0x8000 and the last bank at 0xC000");
+	check(mapper->chrRead(0x0000) == 0 && mapper->chrRead(0x1000) == 1, "at power on, CHR is 8KB bank 0, both of its halves(the constructor maps the windows)");
+
+	//	the control register powers on as 0x0C, which a reset write only ORs bits 2 and 3 into, so it changes nothing but the mirroring(0 in the low bits)
+	uint16_t address = 0x8000;
+	mapper->prg_write(address, 0x80);
+	check(mapper->prgRead(0x8000) == 0 && mapper->prgRead(0xC000) == 15, "a reset write at power on keeps PRG as it was");
+	check(mapper->chrRead(0x0000) == 0 && mapper->chrRead(0x1000) == 1, "a reset write at power on keeps CHR as it was");
+	check(mapper->getMirror() == mirrorEnum::SINGLEA, "a reset write at power on takes the mirroring from control register 0x0C");
+
+	//	PRG mode 3 from power on, before the game has written the control register
+	mapper = buildMapper(1, 0x40000, 0x20000);
+	serialWrite(*mapper, 0xE000, 0x05);
+	check(mapper->prgRead(0x8000) == 5 && mapper->prgRead(0xC000) == 15, "the first PRG bank write switches 0x8000 and leaves the last bank at 0xC000(PRG mode 3 at power on)");
+
+	//	8KB CHR mode, bank numbers are in 4KB units with the low bit ignored, bit 4 still counts
+	serialWrite(*mapper, 0xA000, 0x13);
+	check(mapper->chrRead(0x0000) == 0x12 && mapper->chrRead(0x1000) == 0x13, "8KB CHR mode keeps bit 4 of the bank number");
+
+	//	32KB PRG mode, both halves come from the same 32KB bank, 512KB(32 banks) so bit 4 is not wrapped away
+	mapper = buildMapper(1, 0x80000, 0x20000);
+	serialWrite(*mapper, 0x8000, 0x00);
+	serialWrite(*mapper, 0xE000, 0x13);
+	check(mapper->prgRead(0x8000) == 2 && mapper->prgRead(0xC000) == 3, "32KB PRG mode maps banks 2 and 3 for bank number 0x13, not 2 and 0x13");
+
+}
+
+int main() {
+
+	checkMapper001();
 
 	//	store the current working directory
 	std::string directory = std::filesystem::current_path().u8string();
@@ -21,13 +85,12 @@ int main(int argc, char* argv[]) {
 		std::cout << "Failed to locate " << directory << "\\roms please make sure the directory exists and roms are located there to test.\n" << std::flush;
 		std::cout << "Press enter to continue...\n" << std::flush;
 		std::cin.get();
-		return EXIT_SUCCESS;
+		return failed ? EXIT_FAILURE : EXIT_SUCCESS;
 
 	}
 
 	CartridgeClass cartridge;
-	romStruct* rom = nullptr;
-	MapperClass* mapper = nullptr;
+	std::unique_ptr<romStruct> rom;
 
 	//	for-each loop through all files within directory\\roms
 	for (const auto& p : std::filesystem::directory_iterator(directory + "\\roms")) {
@@ -45,13 +108,12 @@ int main(int argc, char* argv[]) {
 		try {
 
 			rom = cartridge.load(filename);
-			cartridge.storeMapper(selectMapper(rom));
+			uint32_t mapperID = romMapperID(rom->header);
 
-			uint32_t mapperID = (rom->header.flags7 & 0b11110000) | ((rom->header.flags6 & 0b11110000) >> 4);
+			//	the cartridge owns the ROM through its mapper from here on
+			cartridge.storeMapper(selectMapper(std::move(rom)));
 			std::cout << std::setw(65) << relativePath << " MapperID " << mapperID << " supported\n" << std::flush;
 
-			delete mapper;
-
 		}
 		catch (const MapperException& e) {
 
@@ -59,14 +121,16 @@ int main(int argc, char* argv[]) {
 
 		}
 
-		rom = nullptr;
-		mapper = nullptr;
+		rom.reset();
 
 	}
 
+	if (failed)
+		std::cout << failed << " check(s) failed\n";
+
 	std::cout << "Press enter to continue...\n" << std::flush;
 	std::cin.get();
 
-	return EXIT_SUCCESS;
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
 
 }
\ No newline at end of file
@@ -0,0 +1,198 @@
+#include <filesystem>	//	std::filesystem
+#include <fstream>		//	std::ofstream
+#include <iostream>		//	std::cout
+#include <cstring>		//	std::memcmp
+#include <algorithm>	//	std::min, std::copy
+#include <random>		//	std::mt19937
+#include <vector>		//	std::vector
+#include <string>		//	std::string
+
+#include "..\..\src\include\RomIndex.h"
+#include "..\..\src\include\Checksum.h"
+#include "..\TestHelpers.h"
+
+/*
+checks the CRC32 and SHA-1 the ROM index identifies dumps by, and the index itself: RomIndex_test
+the hashes are checked against known answers both through the PCLMULQDQ/SHA extension paths, when the CPU has them, and through plain C++
+the index scans a directory of ROMs written to the temp directory, then rescans it after files are changed, added and removed
+the exit code is EXIT_FAILURE if any check failed
+*/
+
+struct KnownAnswer {
+
+	std::string data;
+	uint32_t crc32;
+	const char* sha1;
+
+};
+
+static void checkHashes() {
+
+	std::cout << "CRC32, " << (crc32Accelerated() ? "PCLMULQDQ" : "no PCLMULQDQ, plain C++ only") << '\n';
+	std::cout << "SHA-1, " << (Sha1Class(true).isAccelerated() ? "SHA extensions" : "no SHA extensions, plain C++ only") << '\n';
+
+	std::string counting;
+	for (uint32_t i = 0; i < 1024; i++)
+		counting += (char)(i & 0xFF);
+
+	//	the empty and short ones never reach the fast paths, the rest are long enough to go through them, with a few bytes left over for the plain C++ tail
+	const KnownAnswer answers[] = {
+
+		{ "", 0x00000000, "da39a3ee5e6b4b0d3255bfef95601890afd80709" },
+		{ "abc", 0x352441C2, "a9993e364706816aba3e25717850c26c9cd0d89d" },
+		{ "123456789", 0xCBF43926, "f7c3bc1d808e04732adf679965ccc34ca7ae3441" },
+		{ "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 0x171A3F5F, "84983e441c3bd26ebaae4aa1f95129e5e54670f1" },
+		{ counting, 0xB70B4C26, "5b00669c480d5cffbdfa8bdba99561160f2d1b77" },
+		{ std::string(1000000, 'a'), 0xDC25BFBC, "34aa973cd4c4daa4f61eeb2bdbad27316534016f" },
+
+	};
+
+	for (const KnownAnswer& answer : answers) {
+
+		const uint8_t* data = (const uint8_t*)answer.data.data();
+		size_t size = answer.data.size();
+		std::string name = std::to_string(size) + " byte known answer";
+
+		check(crc32(data, size) == answer.crc32, "CRC32 of the " + name);
+		check(crc32Scalar(data, size) == answer.crc32, "plain C++ CRC32 of the " + name);
+
+		for (bool accelerated : { true, false }) {
+
+			uint8_t digest[20];
+			Sha1Class sha1(accelerated);
+			sha1.update(data, size);
+			sha1.finish(digest);
+			check(Sha1Class::toHex(digest) == answer.sha1, std::string(accelerated ? "" : "plain C++ ") + "SHA-1 of the " + name);
+
+		}
+
+	}
+
+	//	every length and alignment around the fast paths' block sizes, hashed whole and in uneven pieces, both paths have to agree
+	std::mt19937 random(0x4E45531A);
+	std::vector<uint8_t> buffer(600);
+	for (uint8_t& byte : buffer)
+		byte = (uint8_t)random();
+
+	for (size_t offset = 0; offset < 16; offset++)
+		for (size_t size = 0; size + offset <= buffer.size(); size += 7) {
+
+			const uint8_t* data = buffer.data() + offset;
+			std::string name = std::to_string(size) + " bytes at offset " + std::to_string(offset);
+
+			uint32_t expected = crc32Scalar(data, size);
+			check(crc32(data, size) == expected, "CRC32 of " + name);
+
+			size_t split = size / 3;
+			check(crc32(data + split, size - split, crc32(data, split)) == expected, "CRC32 of " + name + " in 2 pieces");
+
+			uint8_t fast[20], plain[20];
+			Sha1Class whole(true), pieces(false);
+			whole.update(data, size);
+			whole.finish(fast);
+			for (size_t done = 0; done < size; done += 13)
+				pieces.update(data + done, std::min<size_t>(13, size - done));
+			pieces.finish(plain);
+			check(std::memcmp(fast, plain, 20) == 0, "SHA-1 of " + name);
+
+		}
+
+}
+
+//	a NROM ROM with 16KB of PRG and chrChunks * 8KB of CHR filled from seed, and junk bytes after them, returns the CRC32 of PRG and CHR
+static uint32_t writeRom(const std::filesystem::path& file, uint32_t seed, uint8_t flags6, uint8_t chrChunks = 1, size_t junk = 0) {
+
+	size_t romSize = 0x4000 + (size_t)chrChunks * 0x2000;
+	std::vector<uint8_t> data(romSize + junk);
+	std::mt19937 random(seed);
+	for (uint8_t& byte : data)
+		byte = (uint8_t)random();
+
+	const uint8_t header[16] = { 'N', 'E', 'S', 0x1A, 1, chrChunks, flags6, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+	std::ofstream output(file, std::ios::binary | std::ios::trunc);
+	output.write((const char*)header, sizeof(header));
+	output.write((const char*)data.data(), data.size());
+
+	return crc32(data.data(), romSize);
+
+}
+
+static void checkIndex() {
+
+	std::cout << "RomIndexClass\n";
+
+	std::error_code error;
+	std::filesystem::path root = std::filesystem::temp_directory_path() / "nes_RomIndex_test";
+	std::filesystem::remove_all(root, error);
+	std::filesystem::create_directories(root / "more", error);
+	std::filesystem::create_directories(root.string() + "_other", error);
+
+	uint32_t first = writeRom(root / "first.nes", 1, 0x00);
+	uint32_t second = writeRom(root / "more" / "second.nes", 2, 0x03);
+	uint32_t other = writeRom(root.string() + "_other/other.nes", 3, 0x00);
+	std::ofstream(root / "broken.nes") << "not a ROM";
+	std::ofstream(root / "notes.txt") << "not looked at";
+
+	//	more threads than files, so some of them have nothing to do
+	RomIndexClass index(4);
+	check(index.scan(root.string() + "_other") == 1, "first scan of the other directory hashes its 1 file");
+	check(index.scan(root.string()) == 3, "first scan hashes all 3 ROM files");
+	check(index.getEntries().size() == 4, "every ROM file has an entry, and notes.txt does not");
+
+	const RomIndexEntry* entry = index.findCRC32(first);
+	check(entry != nullptr && entry->valid && entry->path == (root / "first.nes").u8string(), "first.nes is found by its CRC32");
+	check(entry != nullptr && entry->prgSize == 0x4000 && entry->chrSize == 0x2000 && entry->mapperID == 0, "first.nes' header is read");
+
+	entry = index.findCRC32(second);
+	check(entry != nullptr && entry->battery && entry->mirroring == mirrorEnum::VERTICAL, "more/second.nes is found, with its battery and mirroring");
+	if (entry != nullptr) {
+
+		uint8_t sha1[20];
+		std::copy(entry->sha1, entry->sha1 + 20, sha1);
+		const RomIndexEntry* bySHA1 = index.findSHA1(sha1);
+		check(bySHA1 != nullptr && bySHA1->crc32 == second, "more/second.nes is found by its SHA-1");
+
+	}
+
+	entry = index.findPath((root / "broken.nes").u8string());
+	check(entry != nullptr && !entry->valid, "broken.nes is kept, as refused");
+	check(index.findCRC32(other) != nullptr, "the other directory's entry is still there");
+
+	check(index.scan(root.string()) == 0, "nothing is hashed when nothing changed");
+
+	//	a rebuilt ROM, with a different size so its time stamp does not matter, a new one with junk after its CHR ROM, and a removed one
+	std::filesystem::remove(root / "first.nes", error);
+	uint32_t rebuilt = writeRom(root / "more" / "second.nes", 4, 0x01, 2);
+	uint32_t third = writeRom(root / "third.nes", 5, 0x00, 1, 100);
+
+	check(index.scan(root.string()) == 2, "only the changed and the new file are hashed");
+	check(index.getEntries().size() == 4, "the removed file's entry is dropped");
+	check(index.findPath((root / "first.nes").u8string()) == nullptr, "first.nes is no longer found");
+	check(index.findCRC32(first) == nullptr, "first.nes' CRC32 is no longer found");
+	check(index.findCRC32(second) == nullptr, "the old build of more/second.nes is no longer found");
+	check(index.findCRC32(rebuilt) != nullptr && index.findCRC32(third) != nullptr, "the rebuilt and the new file are found, the junk after the new one's CHR ROM left out of its CRC32");
+	check(index.findCRC32(other) != nullptr, "the other directory's entry survives the rescan");
+
+	//	a saved index comes back the same, and knows the files are unchanged
+	std::string indexFile = (root / "index.txt").u8string();
+	check(index.save(indexFile), "the index is saved");
+	RomIndexClass loaded(1);
+	check(loaded.load(indexFile), "the saved index loads");
+	check(loaded.getEntries().size() == index.getEntries().size(), "the loaded index has every entry");
+	check(loaded.scan(root.string()) == 0, "the loaded index has nothing to hash");
+	entry = loaded.findCRC32(rebuilt);
+	check(entry != nullptr && entry->mirroring == mirrorEnum::VERTICAL, "the loaded index finds the rebuilt file");
+
+	std::filesystem::remove_all(root, error);
+	std::filesystem::remove_all(root.string() + "_other", error);
+
+}
+
+int main() {
+
+	checkHashes();
+	checkIndex();
+
+	return checkResult();
+
+}
@@ -0,0 +1,293 @@
+#include <iostream>		//	std::cout
+#include <algorithm>		//	std::copy
+#include <memory>		//	std::unique_ptr
+#include <string>		//	std::string
+
+#include "..\..\src\include\CPU.h"
+#include "..\..\src\include\PPU.h"
+#include "..\..\src\include\FrameSink.h"
+
+#include "..\..\src\include\Cartridge.h"
+#include "..\..\src\include\Mapper_Collection.h"
+#include "..\..\src\include\RomStruct.h"
+
+#include "..\TestHelpers.h"
+
+/*
+checks the MMC3's scanline IRQ, with the PPU run on the CPU thread(lockstep) and on its own thread(see PPUPipeline.h): ScanlineIRQ_test
+each program is a MMC3 cartridge built in memory, so no ROM files are needed:
+	scanline N	the NMI handler reloads the counter with N and enables the IRQ, the IRQ handler acknowledges it through $E000 and turns on colour emphasis,
+				so emphasis has to start on scanline N, with exactly one IRQ a frame, for 8x8 and 8x16 sprites
+	PPUADDR	rendering stays off and the main loop moves A12 by hand through $2006, the IRQ has to come on the 4th rise with the counter reloaded with 3
+both modes also have to produce the same frames, the exit code is EXIT_FAILURE if any check failed
+*/
+
+//	the last bank, the one MMC3 always has at 0xE000
+const uint16_t PRG_BASE = 0xE000;
+const size_t PRG_SIZE = 0x8000;
+
+//	zero page: IRQs so far this frame, IRQs in the last frame, X when the last IRQ came, NMIs so far
+const uint16_t IRQ_COUNT = 0x0010, IRQ_LAST_FRAME = 0x0011, IRQ_X = 0x0012, NMI_COUNT = 0x0013;
+
+//	MASK while rendering, and with red emphasis on once the IRQ has come
+const uint8_t MASK_SHOWN = 0x1E, MASK_EMPHASIS = 0x3E;
+
+struct Workload {
+
+	const char* name;
+	uint8_t CTRL;		//	as written once the PPU is set up, background tiles always come from 0x0000
+	uint8_t latch;
+	bool rendering;
+
+};
+
+static Program assemble(const Workload& workload, uint16_t& nmi, uint16_t& reset, uint16_t& irq) {
+
+	Program p(PRG_BASE);
+
+	reset = p.here();
+	p.emit(SEI);
+	p.emit(CLD);
+	p.emit(LDX_IMM, (uint8_t)0xFF);
+	p.emit(TXS);
+
+	//	the PPU needs 2 vblanks after power on before it takes writes
+	for (int i = 0; i < 2; i++) {
+
+		uint16_t wait = p.here();
+		p.emit(BIT_ABS, (uint16_t)0x2002);
+		p.branch(BPL, wait);
+
+	}
+
+	//	OAM at $0200, every sprite off screen with tile 0xFF, which 8x16 sprites fetch from 0x1000
+	p.emit(LDA_IMM, (uint8_t)0xFF);
+	p.emit(LDX_IMM, (uint8_t)0x00);
+	uint16_t oam = p.here();
+	p.emit(STA_ABX, (uint16_t)0x0200);
+	p.emit(INX);
+	p.branch(BNE, oam);
+
+	//	nametable and attributes at $2000, all tile 1
+	p.emit(LDA_IMM, (uint8_t)0x20);
+	p.emit(STA_ABS, (uint16_t)0x2006);
+	p.emit(LDA_IMM, (uint8_t)0x00);
+	p.emit(STA_ABS, (uint16_t)0x2006);
+	p.emit(LDA_IMM, (uint8_t)0x01);
+	p.emit(LDX_IMM, (uint8_t)0x00);
+	p.emit(LDY_IMM, (uint8_t)0x04);
+	uint16_t nametable = p.here();
+	p.emit(STA_ABS, (uint16_t)0x2007);
+	p.emit(INX);
+	p.branch(BNE, nametable);
+	p.emit(DEY);
+	p.branch(BNE, nametable);
+
+	//	palettes
+	p.emit(LDA_IMM, (uint8_t)0x3F);
+	p.emit(STA_ABS, (uint16_t)0x2006);
+	p.emit(LDA_IMM, (uint8_t)0x00);
+	p.emit(STA_ABS, (uint16_t)0x2006);
+	p.emit(LDX_IMM, (uint8_t)0x00);
+	uint16_t palette = p.here();
+	p.emit(TXA);
+	p.emit(STA_ABS, (uint16_t)0x2007);
+	p.emit(INX);
+	p.emit(CPX_IMM, (uint8_t)0x20);
+	p.branch(BNE, palette);
+
+	p.emit(LDA_IMM, (uint8_t)0x00);
+	p.emit(STA_ABS, (uint16_t)0x2005);
+	p.emit(STA_ABS, (uint16_t)0x2005);
+	p.emit(LDA_IMM, workload.CTRL);
+	p.emit(STA_ABS, (uint16_t)0x2000);
+	p.emit(CLI);
+
+	uint16_t loop = p.here();
+	if (!workload.rendering) {
+
+		//	6 rises of A12 a frame, from v going 0x0000 to 0x1000, the counter reloads on the first and reaches 0 on the 4th
+		p.emit(LDA_IMM, workload.latch);
+		p.emit(STA_ABS, (uint16_t)0xC000);
+		p.emit(STA_ABS, (uint16_t)0xC001);
+		p.emit(STA_ABS, (uint16_t)0xE001);
+		p.emit(LDX_IMM, (uint8_t)0x00);
+		uint16_t toggle = p.here();
+		p.emit(LDA_IMM, (uint8_t)0x10);
+		p.emit(STA_ABS, (uint16_t)0x2006);
+		p.emit(LDA_IMM, (uint8_t)0x00);
+		p.emit(STA_ABS, (uint16_t)0x2006);
+		p.emit(STA_ABS, (uint16_t)0x2006);
+		p.emit(STA_ABS, (uint16_t)0x2006);
+		p.emit(INX);
+		p.emit(CPX_IMM, (uint8_t)0x06);
+		p.branch(BNE, toggle);
+
+		//	then wait for the next frame
+		p.emit(LDA_ABS, NMI_COUNT);
+		uint16_t wait = p.here();
+		p.emit(CMP_ABS, NMI_COUNT);
+		p.branch(BEQ, wait);
+
+	}
+	p.emit(JMP_ABS, loop);
+
+	nmi = p.here();
+	p.emit(PHA);
+	p.emit(LDA_ABS, IRQ_COUNT);
+	p.emit(STA_ABS, IRQ_LAST_FRAME);
+	p.emit(LDA_IMM, (uint8_t)0x00);
+	p.emit(STA_ABS, IRQ_COUNT);
+	p.emit(INC_ABS, NMI_COUNT);
+	if (workload.rendering) {
+
+		p.emit(LDA_IMM, (uint8_t)0x02);
+		p.emit(STA_ABS, (uint16_t)0x4014);
+		p.emit(LDA_IMM, (uint8_t)0x00);
+		p.emit(STA_ABS, (uint16_t)0x2005);
+		p.emit(STA_ABS, (uint16_t)0x2005);
+		p.emit(LDA_IMM, MASK_SHOWN);
+		p.emit(STA_ABS, (uint16_t)0x2001);
+
+		//	the counter reloads on the pre-render scanline's rise, and counts down on every visible scanline's after it
+		p.emit(LDA_IMM, workload.latch);
+		p.emit(STA_ABS, (uint16_t)0xC000);
+		p.emit(STA_ABS, (uint16_t)0xC001);
+		p.emit(STA_ABS, (uint16_t)0xE001);
+
+	}
+	p.emit(PLA);
+	p.emit(RTI);
+
+	irq = p.here();
+	p.emit(PHA);
+	p.emit(STA_ABS, (uint16_t)0xE000);
+	p.emit(STX_ABS, IRQ_X);
+	p.emit(INC_ABS, IRQ_COUNT);
+	if (workload.rendering) {
+
+		p.emit(LDA_IMM, MASK_EMPHASIS);
+		p.emit(STA_ABS, (uint16_t)0x2001);
+
+	}
+	p.emit(PLA);
+	p.emit(RTI);
+
+	return p;
+
+}
+
+static std::unique_ptr<romStruct> buildRom(const Workload& workload) {
+
+	std::unique_ptr<romStruct> rom = buildRom(4, PRG_SIZE, 0x2000);
+
+	uint16_t nmi = 0, reset = 0, irq = 0;
+	assemble(workload, nmi, reset, irq).store(*rom, nmi, reset, irq);
+
+	//	tile 1 is colour 1 in every pixel
+	for (size_t i = 0x10; i < 0x18; i++)
+		rom->chr_rom[i] = 0xFF;
+
+	return rom;
+
+}
+
+//	keeps the last frame, and hashes all of them
+class LastFrameSinkClass : public FrameSinkClass {
+
+public:
+	void submitFrame(const FrameBuffer& frame) override {
+
+		this->last.create(frame.width, frame.height);
+		std::copy(frame.pixels.begin(), frame.pixels.end(), this->last.pixels.begin());
+		this->hash.submitFrame(frame);
+
+	}
+
+	FrameBuffer last;
+	FrameHashSinkClass hash;
+
+};
+
+const uint32_t FRAMES = 60;
+
+static void run(const Workload& workload, bool pipelined, uint64_t& hash) {
+
+	std::string mode = pipelined ? "pipelined" : "lockstep";
+	std::cout << workload.name << ", " << mode << '\n';
+
+	CartridgeClass cartridge;
+	CPUClass cpu;
+	PPUClass ppu;
+	LastFrameSinkClass sink;
+
+	cartridge.storeMapper(selectMapper(buildRom(workload)));
+	cpu.loadCartridge(&cartridge);
+	cpu.loadPPU(&ppu);
+	ppu.loadCartridge(&cartridge);
+	ppu.loadCPU(&cpu);
+	ppu.loadFrameSink(&sink);
+	ppu.reset();
+	cpu.reset();
+	cpu.setPipelined(pipelined);
+	check(cpu.isPipelined() == pipelined, "MMC3 runs " + mode);
+
+	for (uint32_t i = 0; i < FRAMES; i++)
+		cpu.runFrame();
+
+	const uint8_t* RAM = (const uint8_t*)cpu.get_cpu_ram();
+	check(RAM[IRQ_LAST_FRAME] == 1, "1 IRQ a frame, not " + std::to_string(RAM[IRQ_LAST_FRAME]));
+	hash = sink.hash.getHash();
+
+	if (!workload.rendering) {
+
+		check(RAM[IRQ_X] == 3, "the IRQ comes on the 4th rise of A12, not the " + std::to_string(RAM[IRQ_X] + 1) + "th");
+		return;
+
+	}
+
+	//	emphasis is turned on during scanline N, and stays on until the NMI
+	FrameBuffer& frame = sink.last;
+	int32_t first = -1;
+	bool after = true;
+	for (uint32_t y = 0; y < frame.height; y++) {
+
+		uint32_t emphasised = 0;
+		for (uint32_t x = 0; x < frame.width; x++)
+			if (frame.row(y)[x] & FRAME_PIXEL_BITMASKS::F_EMPHASIS)
+				emphasised++;
+
+		if (first < 0 && emphasised)
+			first = (int32_t)y;
+		else if (first >= 0 && emphasised != frame.width)
+			after = false;
+
+	}
+	check(first == workload.latch, "the IRQ comes on scanline " + std::to_string(workload.latch) + ", not " + std::to_string(first));
+	check(after, "emphasis stays on for the rest of the frame");
+
+}
+
+int main() {
+
+	const Workload workloads[] = {
+
+		{ "scanline 20", 0x88, 20, true },
+		{ "scanline 120", 0x88, 120, true },
+		{ "scanline 200, 8x16 sprites", 0xA0, 200, true },
+		{ "PPUADDR", 0x80, 3, false },
+
+	};
+
+	for (const Workload& workload : workloads) {
+
+		uint64_t lockstep = 0, pipelined = 0;
+		run(workload, false, lockstep);
+		run(workload, true, pipelined);
+		check(lockstep == pipelined, "the pipelined frames match the lockstep ones");
+
+	}
+
+	return checkResult();
+
+}
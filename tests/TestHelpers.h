@@ -0,0 +1,125 @@
+#ifndef TEST_HELPERS_H
+#define TEST_HELPERS_H
+
+#include <iostream>		//	std::cout
+#include <algorithm>	//	std::copy
+#include <cstdlib>		//	EXIT_SUCCESS, EXIT_FAILURE
+#include <vector>		//	std::vector
+#include <memory>		//	std::unique_ptr
+#include <string>		//	std::string
+
+#include "..\src\include\RomStruct.h"
+#include "..\src\include\custom_exceptions.h"
+
+/*
+what the test and benchmark programs under tests share: counting failed checks, cartridges built in memory, and a tiny 6502 assembler to write their programs with
+every program is a single translation unit, so everything in here is inline
+*/
+
+inline uint32_t failed = 0;
+
+inline void check(bool passed, const std::string& what) {
+
+	if (!passed) {
+
+		std::cout << "    FAILED: " << what << '\n';
+		failed++;
+
+	}
+
+}
+
+//	reports how many checks failed, as main's exit code
+inline int checkResult() {
+
+	if (failed) {
+
+		std::cout << failed << " check(s) failed\n";
+		return EXIT_FAILURE;
+
+	}
+
+	std::cout << "Every check passed\n";
+	return EXIT_SUCCESS;
+
+}
+
+/*
+an iNES cartridge with prgSize bytes of PRG ROM and chrSize bytes of CHR ROM(0 for 8KB of CHR RAM) and 8KB of PRG RAM, all in its arena and all zero, for selectMapper
+sizes are in bytes, and have to be whole 16KB and 8KB chunks
+*/
+inline std::unique_ptr<romStruct> buildRom(uint8_t mapperID, size_t prgSize, size_t chrSize, mirrorEnum mirroring = mirrorEnum::VERTICAL) {
+
+	std::unique_ptr<romStruct> rom = std::make_unique<romStruct>();
+
+	std::copy(nesMagic.begin(), nesMagic.end(), rom->header.ID);
+	rom->header.prgRomSizeLSB = (uint8_t)(prgSize / 0x4000);
+	rom->header.chrRomSizeLSB = (uint8_t)(chrSize / 0x2000);
+	rom->header.flags6 = (uint8_t)(((mapperID & 0x0F) << 4) | ((mirroring == mirrorEnum::VERTICAL) ? 0x01 : 0x00));
+	rom->header.flags7 = (uint8_t)(mapperID & 0xF0);
+
+	rom->prg_rom_chunks = (uint32_t)(prgSize / 0x4000);
+	rom->chr_rom_chunks = chrSize ? (uint32_t)(chrSize / 0x2000) : 1;
+	rom->prg_ram_chunks = 1;
+	rom->chr_ram = (chrSize == 0);
+	rom->tvType = tvEnum::NTSC;
+
+	chrSize = chrSize ? chrSize : 0x2000;
+	size_t prg = rom->arena.reserve(prgSize);
+	size_t chr = rom->arena.reserve(chrSize);
+	size_t ram = rom->arena.reserve(0x2000);
+	if (!rom->arena.allocate())
+		throw CartridgeException("Not enough memory to build the cartridge");
+
+	rom->prg_rom.place(rom->arena.at(prg), prgSize);
+	rom->chr_rom.place(rom->arena.at(chr), chrSize);
+	rom->prg_ram.place(rom->arena.at(ram), 0x2000);
+
+	return rom;
+
+}
+
+//	a tiny 6502 assembler, just enough to write test programs with labels instead of hand counted offsets
+class Program {
+
+public:
+	//	base is where the program runs from, in the last PRG bank, which every mapper keeps at the top of the address space on reset
+	Program(uint16_t _base) : base(_base) {}
+
+	uint16_t here() { return (uint16_t)(this->base + this->code.size()); }
+
+	void emit(uint8_t opcode) { this->code.push_back(opcode); }
+	void emit(uint8_t opcode, uint8_t operand) { this->emit(opcode); this->code.push_back(operand); }
+	void emit(uint8_t opcode, uint16_t address) { this->emit(opcode); this->code.push_back((uint8_t)address); this->code.push_back((uint8_t)(address >> 8)); }
+	void branch(uint8_t opcode, uint16_t target) { this->emit(opcode, (uint8_t)(target - (this->here() + 2))); }
+
+	//	copies the program into the end of rom's PRG ROM, with the NMI, reset and IRQ vectors after it
+	void store(romStruct& rom, uint16_t nmi, uint16_t reset, uint16_t irq) {
+
+		size_t end = rom.prg_rom.size();
+		size_t start = end - (0x10000 - this->base);
+		for (size_t i = 0; i < this->code.size(); i++)
+			rom.prg_rom[start + i] = this->code[i];
+
+		const uint16_t vectors[] = { nmi, reset, irq };
+		for (size_t i = 0; i < 3; i++) {
+
+			rom.prg_rom[end - 6 + i * 2] = (uint8_t)vectors[i];
+			rom.prg_rom[end - 5 + i * 2] = (uint8_t)(vectors[i] >> 8);
+
+		}
+
+	}
+
+	std::vector<uint8_t> code;
+
+private:
+	uint16_t base;
+
+};
+
+const uint8_t LDA_IMM = 0xA9, LDA_ABS = 0xAD, LDX_IMM = 0xA2, LDY_IMM = 0xA0, STA_ABS = 0x8D, STA_ABX = 0x9D, STX_ABS = 0x8E, CMP_ABS = 0xCD, ADC_ABS = 0x6D;
+const uint8_t INC_ABS = 0xEE, INX = 0xE8, DEY = 0x88, TXA = 0x8A, TXS = 0x9A, CPX_IMM = 0xE0, CLC = 0x18, SEI = 0x78, CLI = 0x58, CLD = 0xD8;
+const uint8_t AND_IMM = 0x29, BIT_ABS = 0x2C, BPL = 0x10, BNE = 0xD0, BEQ = 0xF0, BVS = 0x70, BVC = 0x50, JMP_ABS = 0x4C, PHA = 0x48, PLA = 0x68, RTI = 0x40;
+
+#endif
@@ -0,0 +1,101 @@
+#include <iostream>		//	std::cout, std::cerr
+#include <iomanip>		//	std::setw, std::hex
+#include <chrono>		//	std::chrono
+
+#include "..\..\src\include\RomIndex.h"
+#include "..\..\src\include\Checksum.h"
+
+/*
+builds or updates a ROM index: RomIndexer <rom directory> [index file] [-l] [-d]
+the index defaults to roms.index in the current directory, -l prints every entry once it is up to date
+-d prints every ROM as a HeaderDatabase.inc line, with what its header says now, to be corrected by hand
+*/
+
+//	the NES 2.0 shift count for a RAM size, the smallest that holds it
+static uint32_t ramShift(uint32_t size) {
+
+	uint32_t shift = 0;
+	while (size && ((uint32_t)64 << shift) < size)
+		shift++;
+	return shift;
+
+}
+int main(int argc, char* argv[]) {
+
+	if (argc < 2) {
+
+		std::cerr << "usage: RomIndexer <rom directory> [index file] [-l] [-d]\n";
+		return EXIT_FAILURE;
+
+	}
+
+	std::string directory = argv[1];
+	std::string indexFile = "roms.index";
+	bool list = false, database = false;
+	for (int i = 2; i < argc; i++) {
+
+		if (std::string(argv[i]) == "-l")
+			list = true;
+		else if (std::string(argv[i]) == "-d")
+			database = true;
+		else
+			indexFile = argv[i];
+
+	}
+
+	RomIndexClass index;
+	auto start = std::chrono::steady_clock::now();
+	bool existing = index.load(indexFile);
+	uint32_t hashed = index.scan(directory);
+	auto end = std::chrono::steady_clock::now();
+
+	if (!index.save(indexFile)) {
+
+		std::cerr << "Failed to write " << indexFile << '\n';
+		return EXIT_FAILURE;
+
+	}
+
+	if (list) {
+
+		for (const RomIndexEntry& entry : index.getEntries()) {
+
+			if (!entry.valid) {
+
+				std::cout << "not an NES ROM: " << entry.path << '\n';
+				continue;
+
+			}
+			std::cout << std::hex << std::setfill('0') << std::setw(8) << entry.crc32 << std::dec << std::setfill(' ') << ' ' << Sha1Class::toHex(entry.sha1)
+				<< " mapper " << std::setw(3) << (uint32_t)entry.mapperID << ' ' << std::setw(5) << (entry.prgSize / 1024) << "K PRG " << std::setw(4) << (entry.chrSize / 1024) << (entry.chrRam ? "K RAM " : "K CHR ")
+				<< entry.path << '\n';
+
+		}
+
+	}
+
+	if (database) {
+
+		const char* mirrorNames[] = { "HORIZONTAL", "VERTICAL", "HORIZONTAL", "HORIZONTAL", "FOURSCREEN" };
+		const char* tvNames[] = { "NTSC", "PAL", "DENDY" };
+		for (const RomIndexEntry& entry : index.getEntries()) {
+
+			if (!entry.valid || entry.headerFixed)
+				continue;
+
+			uint32_t prgRam = ramShift(entry.prgRamSize);
+			std::cout << "HEADER_FIX(0x" << std::hex << std::setfill('0') << std::setw(8) << entry.crc32 << std::dec << std::setfill(' ') << ", "
+				<< (uint32_t)entry.mapperID << ", " << (uint32_t)entry.submapperID << ", " << mirrorNames[entry.mirroring] << ", " << tvNames[entry.tvType] << ", "
+				<< (entry.battery ? 0 : prgRam) << ", " << (entry.battery ? prgRam : 0) << ", " << (entry.chrRam ? ramShift(entry.chrSize) : 0) << ")"
+				<< "\t//\t" << entry.path << '\n';
+
+		}
+
+	}
+
+	std::cout << index.getEntries().size() << " files indexed, " << hashed << " hashed" << (existing ? "" : " (new index)") << " in "
+		<< std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms\n";
+
+	return EXIT_SUCCESS;
+
+}